@@ -1,4 +1,5 @@
 #include <LiquidCrystal.h>
+#include <QURLCDLink.h>
 
 const int rs = 6, en = 7, d4 = 2, d5 = 3, d6 = 4, d7 = 5;   
 LiquidCrystal lcd(rs, en, d4, d5, d6, d7);  
@@ -19,7 +20,9 @@ LiquidCrystal lcd(rs, en, d4, d5, d6, d7);
 
 #define MAX_DATA    3
 
-const char loading_Animation[4] = {'|', '/', '-', '\\'};
+#define LCD_ROWS          2       // Rows of the LCD, the buttons scroll the MAX_DATA lines
+#define LCD_CELLS_PASS    8       // Cells written to the LCD in every loop (every cell takes ~50 us)
+#define PUSH_DEBOUNCE     50      // Milliseconds that a button must stay stable
 
 struct RGB_DRIVER
 {
@@ -62,122 +65,151 @@ struct RGB_DRIVER
 };
 RGB_DRIVER RGB;
 
-struct Timers
-{
-  int TimeInitial = 0;
-  int TimeFinal = 0;
-  bool BackgroundTime();
-  void SetTimer(int);
-};
-
-bool Timers::BackgroundTime(){
-  // If (<Current Time> less <Initial Time> is less than <Final time>) return true, else return false
-  return ((millis() - TimeInitial) < TimeFinal);
-}
-
-void Timers::SetTimer(int __FINAL__){
-  TimeInitial = millis();     // Sets the <Initial Time> to NOW
-  TimeFinal   = __FINAL__;    // Sets the Final Time to the argument __FINAL__
-}
-
+/**
+  @Function setup
+  @purpuse Starts the LCD and the port of the controller without waiting him:
+       there is no handshake, the controller sends the lines when he starts
+       and sends them again until they are acknowledged (QURLCDLink.h), the
+       LED turns green with the first line
+*/
 void setup()
 {
   pinMode(PUSH_UP,    INPUT);
   pinMode(PUSH_DOWN,  INPUT);
   pinMode(PUSH_ENTER, INPUT);
   RGB.Start();
-  for (int i = 0; i < 20; ++i)
-    RGB.ANIMATE(3);
-  RGB.PROCESS();
-  lcd.begin(16, 2);
-  lcd.setCursor(0, 0); lcd.print("  CONECTANDO... "); 
-  RGB.ANIMATE(0);
   RGB.PROCESS();
   MASTER.begin(38400);
-  RGB.ANIMATE(0);
-  RGB.PROCESS();
-  int ptr = 0;
-  while(!MASTER){
-    RGB.PROCESS();
-    lcd.setCursor(0, 0); lcd.print(loading_Animation[ptr]);
-    ptr++;
-    if(ptr > 3)
-        ptr = 0;
-  }
-  ptr = 0;
-  Timers SerialOut;
-  SerialOut.SetTimer(2000);
-  while(!(MASTER.available() > 0) || !SerialOut.BackgroundTime()){
-      RGB.ANIMATE(3);
-  }
-  if(!SerialOut.BackgroundTime()){
-      lcd.clear(); lcd.setCursor(0, 0); lcd.print(" ERROR ");
-      RGB.ERROR();
-  }
-  else
-  {
-    RGB.ANIMATE(0);
-    RGB.PROCESS();
-    while(MASTER.available() > 0){
-      RGB.WAITING();
-      if(MASTER.read() == '0'){
-          MASTER.print('0');
-          lcd.clear(); lcd.setCursor(0, 0); lcd.print("S: OK");
-          break;
-      }
-      RGB.OK();
-      lcd.setCursor(0, 0); lcd.print(loading_Animation[ptr]);
-      ptr++;
-      if(ptr > 3)
-          ptr = 0;
-    }
-  }
-  MASTER.print('0');
-  RGB.OK();
+  lcd.begin(16, 2);
+  lcd.setCursor(0, 0); lcd.print("  CONECTANDO... ");
 }
 
-String Data[MAX_DATA];
-int __POINTER__ = 0;
+// ---------------------------------------------------------------------------
+// SCREEN
+// Lines received from the controller and the cells that the LCD is showing,
+// only the cells that are different are written to the LCD (LCD_CELLS_PASS
+// per loop, the rest in the next loops)
+// ---------------------------------------------------------------------------
+struct SCREEN_DRIVER
+{
+  char Lines[MAX_DATA][QUR_LCD_COLS];     // Lines: Text of every line received
+  char Shown[LCD_ROWS][QUR_LCD_COLS];     // Shown: Text in the cells of the LCD (0 = unknown)
+  uint8_t Pointer = 0;                    // Pointer: First line shown
+  bool Received = false;                  // Received: Some line arrived (before it the LCD keeps the messages of setup)
+  void Render();
+};
+SCREEN_DRIVER Screen;
+
+QURLCDParser Parser;                      // Parser: Reads the frames of the controller
+
+struct PUSH_DRIVER
+{
+  uint8_t Pin;
+  bool State = false;                     // State: State after the debounce
+  bool Reading = false;                   // Reading: Last read of the pin
+  unsigned long Changed = 0;              // Changed: millis() of the last change of Reading
+  PUSH_DRIVER(uint8_t __PIN__) : Pin(__PIN__) {}
+  bool Pressed();
+};
+PUSH_DRIVER PushUp(PUSH_UP), PushDown(PUSH_DOWN);
+
+void UpdateData();
+void UpdateLCD();
+void ReadPush();
 
 void loop()
 {
   UpdateData();
+  ReadPush();
   UpdateLCD();
 }
 
+/**
+  @Function UpdateData
+  @purpuse Reads the bytes that arrived from the controller (never waits the
+       end of a frame), every line received is saved and acknowledged
+*/
 void UpdateData(){
-  int iterator = 0;
   while(MASTER.available() > 0){
-    char buf;
-    Data[iterator] = "";
-    while(buf != '\n'){
-      buf = MASTER.read();
-      Data[iterator] += buf;
+    if(Parser.Feed(MASTER.read()) != QUR_LCD_LINE)
+      continue;
+    const uint8_t *payload = Parser.Payload();
+    uint8_t line = payload[0];
+    if(line < MAX_DATA){
+      memcpy(Screen.Lines[line], payload + 1, QUR_LCD_COLS);
+      if(!Screen.Received)                // The controller is connected
+        RGB.OK();
+      Screen.Received = true;
     }
-    iterator++;
+    uint8_t frame[QUR_LCD_FRAME_MAX];
+    MASTER.write(frame, QURLCDAck(line, frame));
   }
-  MASTER.println('0');
 }
 
+/**
+  @Function UpdateLCD
+  @purpuse Writes the cells of the LCD that changed
+*/
 void UpdateLCD(){
-  ReadPush();
-  lcd.setCursor(0, 0); lcd.print(Data[__POINTER__]);
-  lcd.setCursor(0, 1); lcd.print(Data[(__POINTER__ + 1)]);
+  if(Screen.Received)
+    Screen.Render();
 }
 
-void ReadPush(){
-  Timers PushTimeout;
-  if(digitalRead(PUSH_UP)){
-    __POINTER__ --;
-    if(__POINTER__ < 0)
-      __POINTER__ = 0;
+/**
+  @Struct SCREEN_DRIVER
+  @Function Render
+  @purpuse Compares the lines shown with the cells of the LCD and writes up to
+       LCD_CELLS_PASS cells that are different, the cursor is only moved when
+       the next cell is not the one after the last written
+*/
+void SCREEN_DRIVER::Render(){
+  uint8_t written = 0;
+  for(uint8_t row = 0; row < LCD_ROWS; row++){
+    const char *line = Lines[Pointer + row];
+    int8_t cursor = -1;                   // cursor: Column of the cursor of the LCD in this row (-1 = unknown)
+    for(uint8_t col = 0; col < QUR_LCD_COLS; col++){
+      if(Shown[row][col] == line[col])
+        continue;
+      if(written == LCD_CELLS_PASS)
+        return;
+      if(cursor != col)
+        lcd.setCursor(col, row);
+      lcd.write((uint8_t)line[col]);
+      Shown[row][col] = line[col];
+      cursor = col + 1;
+      written++;
+    }
+  }
+}
+
+/**
+  @Struct PUSH_DRIVER
+  @Function Pressed
+  @purpuse Debounces the button without waiting
+
+  @return Returns true once when the button is pressed
+*/
+bool PUSH_DRIVER::Pressed(){
+  bool reading = digitalRead(Pin);
+  unsigned long now = millis();
+  if(reading != Reading){
+    Reading = reading;
+    Changed = now;
   }
-  if(digitalRead(PUSH_DOWN)){
-      __POINTER__ ++;
-      if(__POINTER__ > (MAX_DATA - 2))
-        __POINTER__ = 1;
+  if(Reading != State && now - Changed >= PUSH_DEBOUNCE){
+    State = Reading;
+    return State;
   }
-  PushTimeout.SetTimer(10);
-  while(!PushTimeout.BackgroundTime())
-      UpdateData();
-}
\ No newline at end of file
+  return false;
+}
+
+/**
+  @Function ReadPush
+  @purpuse Scrolls the lines with the buttons UP and DOWN
+*/
+void ReadPush(){
+  if(PushUp.Pressed() && Screen.Pointer > 0)
+    Screen.Pointer--;
+  if(PushDown.Pressed() && Screen.Pointer < MAX_DATA - LCD_ROWS)
+    Screen.Pointer++;
+}
@@ -1,7 +1,7 @@
 #include "RFController.h"
 #include <Arduino.h>
 
-RF24 RFController(7, 8);
+static RF24 RFController(7, 8);
 
 struct RGB_BUILDER
 {
@@ -33,25 +33,203 @@ struct RGB_BUILDER
 	};
 }FLAG;
 
-void RFControl::JOYSTICK_DRIVER::Controler::ReadValues(int pinX, int pinY){
-	ReadX = analogRead(pinX);
-	ReadY = analogRead(pinY);
-	ReadX -= 512;
-	ReadY -= 512;
-	if (ReadX < 100 && ReadX > -100)
-		ReadX = 0;
-	if (ReadY < 100 && ReadY > -100)
-		ReadY = 0;
+// atan(2^-i) in degrees << 8 for every step of the CORDIC
+static const int16_t CORDIC_ATAN[CORDIC_STEPS] PROGMEM = {
+	11520, 6801, 3593, 1824, 916, 458, 229, 115, 57, 29, 14, 7
+};
+
+/**
+  @Function SampleAxis
+  @purpuse Reads an axis JOYSTICK_OVERSAMPLE times
+
+  @param __PIN__ Analog pin of the axis
+  @return Returns the sum of the reads (0 to 1023 * JOYSTICK_OVERSAMPLE)
+*/
+static int16_t SampleAxis(int __PIN__){
+	int16_t sum = 0;
+	for(uint8_t x = 0; x < JOYSTICK_OVERSAMPLE; x++)
+		sum += analogRead(__PIN__);
+	return sum;
+}
+
+/**
+  @Function ScaleAxis
+  @purpuse Centers a filtered axis, removes the deadzone and scales the rest
+       so the position grows from 0 at the edge of the deadzone
+
+  @param __FILTERED__ Output of the filter of the axis
+  @param __CENTER__   Calibrated center of the axis
+  @return Returns the position of the axis (-512 to 512)
+*/
+static int ScaleAxis(int16_t __FILTERED__, int16_t __CENTER__){
+	int16_t value = __FILTERED__ - __CENTER__;
+	const int16_t deadzone = JOYSTICK_DEADZONE * JOYSTICK_OVERSAMPLE;
+	if(value > deadzone)       value -= deadzone;
+	else if(value < -deadzone) value += deadzone;
+	else                       return 0;
+	long position = ((long)value * JOYSTICK_SCALE) >> 10;
+	return position > 512 ? 512 : (position < -512 ? -512 : (int)position);
+}
+
+/**
+  @Function CordicVector
+  @purpuse Converts a position to polar coordinates with CORDIC (vectoring
+       mode): the vector is rotated by atan(2^-i) to the axis X with shifts
+       and adds, the sum of the rotations is the angle and the final X is
+       the magnitude times the gain of the CORDIC (1.6468)
+
+  @param __X__         Position of the axis X (-512 to 512)
+  @param __Y__         Position of the axis Y (-512 to 512)
+  @param __ANGLE__     Returns the angle in degrees (-180 to 180, like atan2)
+  @param __MAGNITUDE__ Returns the magnitude (0 to 724)
+*/
+static void CordicVector(int __X__, int __Y__, int &__ANGLE__, int &__MAGNITUDE__){
+	int32_t x = (int32_t)__X__ << 6, y = (int32_t)__Y__ << 6;   // 6 bits more for the shifts
+	int32_t angle = 0;
+	if(x < 0){                                  // The CORDIC converges in -90 to 90, rotate 180 degrees
+		angle = y >= 0 ? (180L << 8) : -(180L << 8);
+		x = -x;
+		y = -y;
+	}
+	for(uint8_t i = 0; i < CORDIC_STEPS; i++){
+		int32_t step = (int16_t)pgm_read_word(&CORDIC_ATAN[i]);
+		int32_t _x = x;
+		if(y > 0){ x += y >> i;  y -= _x >> i; angle += step; }
+		else     { x -= y >> i;  y += _x >> i; angle -= step; }
+	}
+	__ANGLE__ = (int)((angle + 128) >> 8);
+	__MAGNITUDE__ = (int)(((x * 19899L) >> 15) >> 6);         // 19899 / 2^15 = 1 / 1.6468
+}
+
+// ---------------------------------------------------------------------------
+// Methods for the Joysticks
+//       - Controler::Calibrate(int pinX, int pinY)
+//       - Controler::ReadValues(int pinX, int pinY)
+//       - Calibrate()
+//       - LoadCalibration()
+//       - SaveCalibration()
+//       - CalibrationByte(void *__JOYSTICKS__, uint16_t __INDEX__)
+//       - ConvertToVector()
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct RFControl -> JOYSTICK_DRIVER -> Controler
+  @Function Calibrate
+  @purpuse Finds the center of the joystick with the average of
+       JOYSTICK_CALIBRATION samples (the joystick must be released), if it is
+       farther than JOYSTICK_CENTER_MAX from 512 the ideal center is used
+
+  @param pinX Analog pin of the axis X
+  @param pinY Analog pin of the axis Y
+*/
+void RFControl::JOYSTICK_DRIVER::Controler::Calibrate(int pinX, int pinY){
+	const int pins[2] = {pinX, pinY};
+	for(int axis = 0; axis < 2; axis++){
+		int32_t sum = 0;
+		for(int x = 0; x < JOYSTICK_CALIBRATION; x++)
+			sum += SampleAxis(pins[axis]);
+		int16_t center = sum / JOYSTICK_CALIBRATION;
+		if(center > JOYSTICK_ZERO + JOYSTICK_CENTER_MAX * JOYSTICK_OVERSAMPLE ||
+		   center < JOYSTICK_ZERO - JOYSTICK_CENTER_MAX * JOYSTICK_OVERSAMPLE)
+			center = JOYSTICK_ZERO;
+		Center[axis] = center;
+		Filtered[axis] = center;
+	}
+}
+
+/**
+  @Struct RFControl -> JOYSTICK_DRIVER -> Controler
+  @Function ReadValues
+  @purpuse Samples both axes, filters them and updates ReadX and ReadY
+
+  @param pinX Analog pin of the axis X
+  @param pinY Analog pin of the axis Y
+  @return Returns true if the joystick is out of the deadzone
+*/
+bool RFControl::JOYSTICK_DRIVER::Controler::ReadValues(int pinX, int pinY){
+	Filtered[0] += (SampleAxis(pinX) - Filtered[0]) >> JOYSTICK_FILTER_SHIFT;
+	Filtered[1] += (SampleAxis(pinY) - Filtered[1]) >> JOYSTICK_FILTER_SHIFT;
+	ReadX = ScaleAxis(Filtered[0], Center[0]);
+	ReadY = ScaleAxis(Filtered[1], Center[1]);
+	return ReadX != 0 || ReadY != 0;
 }
 
+/**
+  @Struct RFControl -> JOYSTICK_DRIVER
+  @Function Calibrate
+  @purpuse Finds the center of both joysticks (call it with the joysticks released)
+*/
+void RFControl::JOYSTICK_DRIVER::Calibrate(){
+	JoystickMover.Calibrate(JOYSTICK1_X, JOYSTICK1_Y);
+	JoystickRotar.Calibrate(JOYSTICK2_X, JOYSTICK2_Y);
+}
+
+/**
+  @Struct RFControl -> JOYSTICK_DRIVER
+  @Function LoadCalibration
+  @purpuse Reads the centers of both joysticks saved in the EEPROM (FAST_BOOT)
+       instead of sampling them
+
+  @return Returns true if the record was found and his CRC is right
+*/
+bool RFControl::JOYSTICK_DRIVER::LoadCalibration(){
+	QURStoreReader reader;
+	if(!reader.Begin(QUR_STORE_JOYSTICKS, QUR_STORE_TAG_JOYSTICKS, JOYSTICK_RECORD))
+		return false;
+	int16_t centers[4];
+	for(int x = 0; x < 4; x++)
+		centers[x] = (int16_t)reader.Read16();
+	if(!reader.End())
+		return false;
+	for(int axis = 0; axis < 2; axis++){
+		JoystickMover.Center[axis] = JoystickMover.Filtered[axis] = centers[axis];
+		JoystickRotar.Center[axis] = JoystickRotar.Filtered[axis] = centers[2 + axis];
+	}
+	return true;
+}
+
+/**
+  @Struct RFControl -> JOYSTICK_DRIVER
+  @Function SaveCalibration
+  @purpuse Starts to save the centers in the EEPROM, TaskJoysticks writes them
+       one byte at a time
+*/
+void RFControl::JOYSTICK_DRIVER::SaveCalibration(){
+	Store.Begin(QUR_STORE_JOYSTICKS, QUR_STORE_TAG_JOYSTICKS, JOYSTICK_RECORD, CalibrationByte, this);
+}
+
+/**
+  @Struct RFControl -> JOYSTICK_DRIVER
+  @Function CalibrationByte
+  @purpuse Byte of the record of the EEPROM: the centers X and Y of the mover
+       and of the rotation (little endian)
+
+  @param __JOYSTICKS__ Instance of JOYSTICK_DRIVER
+  @param __INDEX__     Byte of the record (0 to JOYSTICK_RECORD - 1)
+  @return Returns the byte
+*/
+uint8_t RFControl::JOYSTICK_DRIVER::CalibrationByte(void *__JOYSTICKS__, uint16_t __INDEX__){
+	JOYSTICK_DRIVER *Joysticks = (JOYSTICK_DRIVER *)__JOYSTICKS__;
+	Controler &joystick = __INDEX__ < 4 ? Joysticks->JoystickMover : Joysticks->JoystickRotar;
+	uint16_t center = (uint16_t)joystick.Center[(__INDEX__ >> 1) & 1];
+	return (__INDEX__ & 1) ? (uint8_t)(center >> 8) : (uint8_t)center;
+}
+
+/**
+  @Struct RFControl -> JOYSTICK_DRIVER
+  @Function ConvertToVector
+  @purpuse Samples both joysticks, the last one moved out of his deadzone
+       selects the Mode and his position is converted to Angle and Magnitude
+*/
 void RFControl::JOYSTICK_DRIVER::ConvertToVector(){
-	JoystickMover.ReadValues(JOYSTICK1_X, JOYSTICK1_Y);
-	JoystickRotar.ReadValues(JOYSTICK2_X, JOYSTICK2_Y);
-	int _x = Mode == WALKING ? JoystickMover.ReadX : JoystickRotar.ReadX;
-	int _y = Mode == WALKING ? JoystickMover.ReadX : JoystickRotar.ReadX;
-	int r = sqrt(_x*_x + _y*_y);
-	Angle = atan2(_y, _x);
-    Angle = (180*Angle)/M_PI;
+	bool mover = JoystickMover.ReadValues(JOYSTICK1_X, JOYSTICK1_Y);
+	bool rotar = JoystickRotar.ReadValues(JOYSTICK2_X, JOYSTICK2_Y);
+	if(mover)      Mode = WALKING;
+	else if(rotar) Mode = ROTATION;
+	Controler &stick = Mode == WALKING ? JoystickMover : JoystickRotar;
+	int r;
+	CordicVector(stick.ReadX, stick.ReadY, Angle, r);
+	Magnitude = r >= 512 ? 100 : (r * 100L + 256) >> 9;       // Rounded, 100 at the end of the axis
 }
 
 int RFControl::PUSH_DRIVER::UpdateStatus(){
@@ -66,82 +244,69 @@ int RFControl::PUSH_DRIVER::UpdateStatus(){
 }
 
 // ---------------------------------------------------------------------------
-// Methods for Timers controller
-//       - BackgroundTime()
-//       - SetTimer(int __FINAL__)
+// Methods for the RFControl
+//       - UpdateLCD()
+//       - StartLCD()
+//       - StartRF()
+//       - SendData()
+//       - CheckRadio()
+//       - CommandChanged()
 // ---------------------------------------------------------------------------
 
 /**
-  @Struct RFControl -> TIMES
-  @Function BackgroundTime
-  @purpuse Checks if the timer ended
-
-  @return Return a boolean value if the timer is not ended (true if is ended or false if not)
-*/
-bool TIMES::BackgroundTime(){
-  // If (<Current Time> less <Initial Time> is less than <Final time>) return true, else return false
-  return ((millis() - TimeInitial) < TimeFinal);
-}
-
-/**
-  @Struct RFControl -> TIMES
-  @Function SetTimer
-  @purpuse Read a int argument that is the end time, and initialize the counter.
-
-  @param __FINAL__ Variable that indicates the term time
+  @Struct RFControl
+  @Function UpdateLCD
+  @purpuse Sends to the ModuleLCD the lines of the screen that changed without
+       waiting his answer: the ACKs are read as they arrive, the lines are
+       only sent when every line before was acknowledged (or LCD_ACK_TIMEOUT
+       passed, then all of them are sent again) and while they fit in the
+       buffer of the Serial. The text is made in fixed buffers (no String)
 */
-void TIMES::SetTimer(int __FINAL__){
-  TimeInitial = millis();     // Sets the <Initial Time> to NOW
-  TimeFinal   = __FINAL__;    // Sets the Final Time to the argument __FINAL__
-}
-
 void RFControl::UpdateLCD(){
-	TIMES SerialOut;
-	FLAG.WAITING();
-	String *__DATA__; 
-	__DATA__[0] = ("Modo: " + String(Joysticks.Mode == true ? "Caminata" : "Rotacion"));
-	__DATA__[1] = "Angulo: " + String(Data.Angle);
-	__DATA__[2] = ("A:" + String(Data.VectorPush[0]) + " B:" + String(Data.VectorPush[2]) + " C:" + String(Data.VectorPush[2]));
-	for (int i = 0; i < 3; ++i)
-		Serial.println(__DATA__[i]);
-	SerialOut.SetTimer(500);
-	while(!SerialOut.BackgroundTime()){
-		if(LCDController.available() > 0){
-			if(LCDController.read() == '0'){
-				FLAG.OK();
-				break;
-			}
-		}
-		FLAG.ANIMATE(0);
+	while(LCDController.available() > 0){
+		if(LCDParser.Feed(LCDController.read()) == QUR_LCD_ACK && LCDPending)
+			LCDPending--;
+	}
+	if(LCDPending){
+		if(!LCDTimeout.Expired())                 // The module is still drawing the last lines
+			return;
+		LCDTimeouts++;                            // Lost answer, the module could have lost the lines
+		LCDPending = 0;
+		LCDForce = true;
+	}
+	if(++LCDRefresh >= LCD_REFRESH)
+		LCDForce = true;
+	char lines[LCD_LINES][QUR_LCD_COLS + 1];
+	snprintf(lines[0], sizeof(lines[0]), "Modo: %s", Joysticks.Mode == WALKING ? "Caminata" : "Rotacion");
+	snprintf(lines[1], sizeof(lines[1]), "Angulo: %d", Data.Angle);
+	snprintf(lines[2], sizeof(lines[2]), "A:%d B:%d C:%d", Data.Buttons & 1, (Data.Buttons >> 1) & 1, (Data.Buttons >> 2) & 1);
+	for(uint8_t x = 0; x < LCD_LINES; x++){
+		if(!LCDForce && strcmp(lines[x], LCDShown[x]) == 0)
+			continue;
+		if(LCDController.availableForWrite() < QUR_LCD_FRAME_MAX)
+			return;                               // The rest of the lines in the next period
+		uint8_t frame[QUR_LCD_FRAME_MAX];
+		LCDController.write(frame, QURLCDLine(x, lines[x], frame));
+		strcpy(LCDShown[x], lines[x]);
+		LCDPending++;
+		LCDTimeout.SetTimer(LCD_ACK_TIMEOUT);
+	}
+	if(LCDForce){
+		LCDForce = false;
+		LCDRefresh = 0;
 	}
 }
 
+/**
+  @Struct RFControl
+  @Function StartLCD
+  @purpuse Opens the port of the ModuleLCD without waiting for him: every line
+       is acknowledged (UpdateLCD), a module that starts later or doesn't
+       answer gets the whole screen again after LCD_ACK_TIMEOUT
+*/
 void RFControl::StartLCD(){
-	TIMES SerialOut;
-	FLAG.WAITING();
 	LCDController.begin(38400);
-	SerialOut.SetTimer(1000);
-	while(!LCDController || !SerialOut.BackgroundTime()){
-		for(int x = 0; x < 5; x ++){
-	        FLAG.ANIMATE(2);
-	    }
-	}
-	if(!SerialOut.BackgroundTime()){
-	    FLAG.ERROR();
-	}
-	else{
-		LCDController.print('0');
-		SerialOut.SetTimer(1000);
-		while(!SerialOut.BackgroundTime()){
-			if(LCDController.available() > 0){
-				if(LCDController.read() == '0'){
-					FLAG.OK();	
-					break;
-				}
-			}
-			FLAG.ANIMATE(0);
-		}
-	}
+	LCDForce = true;
 }
 
 void RFControl::StartRF(){
@@ -151,29 +316,180 @@ void RFControl::StartRF(){
   	RFController.setPALevel(RF24_PA_MAX);
   	RFController.setDataRate( RF24_250KBPS ) ; 
   	RFController.openWritingPipe(addresses[0]);
+  	RFController.enableDynamicPayloads();		// Only the bytes of the packet are sent (less airtime)
+  	RFController.enableAckPayload();			// The ACKs bring the state of the robot
+  	RFController.setRetries(RF_RETRY_DELAY, RF_RETRY_COUNT);
   	FLAG.OK();
 }
 
-void RFControl::SendData(){
-	FLAG.WAITING();
-	bool isSended = RFController.write(&Data, sizeof(Data));
-	if (!isSended && !TimeOutSender.BackgroundTime()){
+/**
+  @Struct RFControl
+  @Function SendData
+  @purpuse Starts the transmission of Data and returns without waiting, the
+       nRF24 does the retries and CheckRadio reads the result. A packet that
+       is not acknowledged is not repeated here: the next sample (or
+       keepalive) sends a newer one
+
+  @return Returns true if the packet started or false if other is in the air
+*/
+bool RFControl::SendData(){
+	if(Transmitting)
+		return false;
+	uint8_t packet[QUR_PACKET_MAX];
+	uint8_t length = Writer.Drive(Data, packet);
+	Pending = Data;
+	RFController.startWrite(packet, length, false);
+	Transmitting = true;
+	TxTimeout.SetTimer(RF_TX_TIMEOUT);
+	return true;
+}
+
+/**
+  @Struct RFControl
+  @Function CheckRadio
+  @purpuse Reads the end of the transmission in progress: with TX_DS the
+       command arrived and the ACK payload (the state of the robot) is read,
+       with MAX_RT or RF_TX_TIMEOUT the packet is dropped from the TX FIFO
+*/
+void RFControl::CheckRadio(){
+	if(!Transmitting)
+		return;
+	bool sent, failed, received;
+	RFController.whatHappened(sent, failed, received);   // Clears the flags
+	if(sent){
+		Transmitting = false;
+		Last = Pending;
+		Sent++;
+		FLAG.OK();
+		while(RFController.available()){                  // ACK payloads (a STATUS, the rest is discarded)
+			uint8_t packet[QUR_PACKET_MAX];
+			uint8_t length = RFController.getDynamicPayloadSize();
+			if(length == 0 || length > QUR_PACKET_MAX){       // Corrupted length, the library flushes it
+				RFController.read(packet, QUR_PACKET_MAX);
+				continue;
+			}
+			RFController.read(packet, length);
+			if(StatusReader.Decode(packet, length, Robot) == QUR_PACKET_STATUS)
+				Statuses++;
+		}
+	}
+	else if(failed || TxTimeout.Expired()){
+		RFController.flush_tx();                          // MAX_RT keeps the packet in the FIFO
+		Transmitting = false;
+		Failed++;
 		FLAG.ERROR();
-		SendData();
 	}
-	FLAG.OK();
 }
 
+/**
+  @Struct RFControl
+  @Function CommandChanged
+  @purpuse Compares Data with the last command acknowledged, the small moves
+       of the joystick wait the keepalive
+
+  @return Returns true if the mode, the buttons or the release changed, or if
+       the angle or the magnitude moved at least JOYSTICK_ANGLE_STEP or
+       JOYSTICK_MAGNITUDE_STEP
+*/
+bool RFControl::CommandChanged(){
+	if(Data.Mode != Last.Mode || Data.Buttons != Last.Buttons)
+		return true;
+	if((Data.Magnitude == 0) != (Last.Magnitude == 0))
+		return true;
+	if(abs((int)Data.Magnitude - (int)Last.Magnitude) >= JOYSTICK_MAGNITUDE_STEP)
+		return true;
+	int angle = Data.Angle - Last.Angle;      // Shortest turn between both angles
+	if(angle > 180)  angle -= 360;
+	if(angle < -180) angle += 360;
+	return Data.Magnitude > 0 && abs(angle) >= JOYSTICK_ANGLE_STEP;
+}
+
+// ---------------------------------------------------------------------------
+// Stages of the Routine
+//       - TaskJoysticks(void *__CONTROL__)
+//       - TaskSend(void *__CONTROL__)
+//       - TaskLCD(void *__CONTROL__)
+//       - TaskRadio(void *__CONTROL__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct RFControl
+  @Function TaskJoysticks
+  @purpuse Samples the joysticks and the buttons and updates the command, a
+       significant change is sent right away and restarts the keepalive
+
+  @param __CONTROL__ Instance of RFControl
+*/
+void RFControl::TaskJoysticks(void *__CONTROL__){
+	RFControl *Control = (RFControl *)__CONTROL__;
+	Control->Joysticks.ConvertToVector();
+	Control->PushControl.UpdateStatus();
+	Control->Data.Mode  = Control->Joysticks.Mode;
+	Control->Data.Angle = Control->Joysticks.Angle;
+	Control->Data.Magnitude = Control->Joysticks.Magnitude;
+	Control->Data.Buttons = 0;
+	for(int x = 0; x < 3; x++)
+		Control->Data.Buttons |= (Control->PushControl.Buttons[x] ? 1 : 0) << x;
+	if(Control->CommandChanged() && Control->SendData())
+		Control->Scheduler.Restart(TASK_SEND);
+#if FAST_BOOT
+	Control->Joysticks.Store.Step();      // One byte of the centers to the EEPROM (if it changed)
+#endif
+}
+
+/**
+  @Struct RFControl
+  @Function TaskSend
+  @purpuse Sends the last command to the robot when nothing changed in
+       RATE_KEEPALIVE (keepalive)
+
+  @param __CONTROL__ Instance of RFControl
+*/
+void RFControl::TaskSend(void *__CONTROL__){
+	RFControl *Control = (RFControl *)__CONTROL__;
+	Control->Keepalives++;
+	Control->SendData();
+}
+
+/**
+  @Struct RFControl
+  @Function TaskLCD
+  @purpuse Refreshes the screen of the ModuleLCD (never waits)
+
+  @param __CONTROL__ Instance of RFControl
+*/
+void RFControl::TaskLCD(void *__CONTROL__){
+	((RFControl *)__CONTROL__)->UpdateLCD();
+}
+
+/**
+  @Struct RFControl
+  @Function TaskRadio
+  @purpuse Finishes the transmission in progress (never waits)
+
+  @param __CONTROL__ Instance of RFControl
+*/
+void RFControl::TaskRadio(void *__CONTROL__){
+	((RFControl *)__CONTROL__)->CheckRadio();
+}
+
+/**
+  @Struct RFControl
+  @Function Routine
+  @purpuse Runs the stages that are due and returns, call it as fast as
+       possible from loop()
+*/
 void RFControl::Routine(){
-	TIMES RFtimeOut;
-	FLAG.OK();
-	Joysticks.ConvertToVector();
-	int isPushed = PushControl.UpdateStatus();
-	UpdateLCD();
-	RFtimeOut.SetTimer(500);
-	SendData();
+	Scheduler.Run();
 }
 
+/**
+  @Struct RFControl
+  @Function Start
+  @purpuse Finds the centers of the joysticks (FAST_BOOT: from the EEPROM), opens
+       the LCD and the antenna and adds the stages to the Scheduler, nothing
+       waits for a device
+*/
 void RFControl::Start(){
 	pinMode(JOYSTICK1_X, INPUT);
 	pinMode(JOYSTICK1_Y, INPUT);
@@ -183,8 +499,21 @@ void RFControl::Start(){
 	pinMode(PUSH_B, INPUT);
 	pinMode(PUSH_C, INPUT);
 	FLAG.Start();
+#if FAST_BOOT
+	if(digitalRead(PUSH_A) || !Joysticks.LoadCalibration()){   // First boot or the button A pressed in the reset
+		Joysticks.Calibrate();
+		Joysticks.SaveCalibration();
+	}
+#else
+	Joysticks.Calibrate();
 	for (int i = 0; i < 20; ++i)
 		FLAG.ANIMATE(0);
+#endif
 	StartLCD();
 	StartRF();
+	// Add the stages in the order of the TASK_ IDs, the keepalive follows a sample by PHASE_SEND
+	Scheduler.AddTask(TaskJoysticks, this, RATE_JOYSTICK);
+	Scheduler.AddTask(TaskSend,      this, RATE_KEEPALIVE, PHASE_SEND);
+	Scheduler.AddTask(TaskLCD,       this, RATE_LCD,  2 * PHASE_SEND);
+	Scheduler.AddTask(TaskRadio,     this, RATE_RADIO, PHASE_SEND / 2);
 }
\ No newline at end of file
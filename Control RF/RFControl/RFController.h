@@ -19,11 +19,36 @@
 // * Convert the Joystick Coord into Positions for the Hexapod Shield
 // * Push control for the customized controls from the plataform
 //
-// CONSTRUCTOR:
+// PIPELINE:
+// The Routine never waits: every stage is a task of the Scheduler (QURScheduler.h)
+// with his own rate, so a slow LCD can't delay the commands of the robot.
+//   * Joysticks (RATE_JOYSTICK): Reads the joysticks and the buttons into Data,
+//     if the command changed more than the JOYSTICK_*_STEP it is sent right away
+//   * RF (RATE_KEEPALIVE): Sends Data again when nothing changed (keepalive)
+//   * Radio (RATE_RADIO): Checks the end of the transmission in progress
+//   * LCD (RATE_LCD): Sends to the ModuleLCD the lines of the screen that
+//     changed (binary frames, QURLCDLink.h) only if the last ones were
+//     acknowledged or LCD_ACK_TIMEOUT passed, and only if they fit in the
+//     buffer of the Serial
 //
+// TRANSMISSION:
+// A packet is only started (startWrite), the nRF24 repeats it by himself
+// (RF_RETRY_COUNT retries every RF_RETRY_DELAY) and the Radio stage reads the
+// result, so sending never stops the Routine. While a packet is in the air
+// the new sends are refused and the next sample tries again. The ACK of the
+// robot brings his state (ACK payload, QURPacket.h -> QURStatus) without
+// extra packets in the air.
 //
-// METHODS:
+// CONSTRUCTOR:
+//   RFControl Control;
 //
+// METHODS:
+//   Control.Start()   - Initialize the joysticks, the LCD and the antenna (call it from setup())
+//                       With FAST_BOOT the centers of the joysticks come from the EEPROM and
+//                       nothing waits (the ModuleLCD gets the screen when he answers), hold
+//                       the button A in the reset to find the centers again
+//   Control.Routine() - Runs the stages that are due (call it as fast as possible from loop())
+//   Control.Status()  - Last state received from the robot (QURStatus), StatusCount() counts them
 //
 // HISTORY:
 // 06/20/2018 v1.0 - Initial release.
@@ -37,6 +62,10 @@
 	#include "RF24.h"
 #endif
 #include <Arduino.h>
+#include <QURPacket.h>
+#include <QURScheduler.h>
+#include <QURLCDLink.h>
+#include <QURStore.h>
 
 #define ROTATION false
 #define WALKING  true
@@ -56,16 +85,62 @@
 #define RGB_ERROR 	1
 #define RGB_WAIT  	2
 
-#define LCDController Serial   // RFController: Instance of the class RF24 to control the antenna.
-const byte addresses[][6] = {"0"};  // Addresses: Address of comunication
+#define LCDController Serial   // LCDController: Port of the ModuleLCD
 
-typedef struct TIMES
-  	{
-    	int TimeInitial = 0;    // This is the time reference when the timer initialize
-    	int TimeFinal = 0;      // This is the time in microseconds when the timer is going to end
-    	bool BackgroundTime();  // Backgroundtime: Return a boolean value if the timer is not ended (true if is ended or false if not)
-    	void SetTimer(int);     // SetTimer: Read a int argument that is the end time, and initialize the counter.
-  	};
+// ---------------------------------------------------------------------------
+// JOYSTICK DEFINE'S
+// Every axis is the sum of JOYSTICK_OVERSAMPLE reads, filtered with a IIR of
+// integers (new = old + (sample - old) / 2^JOYSTICK_FILTER_SHIFT), centered
+// with the calibration of Start() and without the deadzone. The angle and the
+// magnitude are calculated with CORDIC (only shifts and adds, no float)
+// ---------------------------------------------------------------------------
+#define JOYSTICK_OVERSAMPLE     4       // analogRead() per axis in every sample
+#define JOYSTICK_FILTER_SHIFT   1       // Weight of the new sample in the filter (1/2)
+#define JOYSTICK_DEADZONE       40      // Deadzone around the center (counts of the ADC)
+#define JOYSTICK_CALIBRATION    16      // Samples averaged to find the center in Start()
+#define JOYSTICK_CENTER_MAX     100     // Farthest center from 512 accepted, more means the stick was moved in Start()
+#define JOYSTICK_ANGLE_STEP     5       // Change of the angle in degrees that sends the command right away
+#define JOYSTICK_MAGNITUDE_STEP 5       // Change of the magnitude (0-100) that sends the command right away
+#define JOYSTICK_ZERO           (512 * JOYSTICK_OVERSAMPLE)   // Center of an axis without calibration
+#define JOYSTICK_SCALE          ((512L << 10) / ((512 - JOYSTICK_DEADZONE) * JOYSTICK_OVERSAMPLE))   // Axis without deadzone to +-512 (<< 10)
+#define CORDIC_STEPS            12      // Iterations of the CORDIC (the error is less than a degree)
+#define JOYSTICK_RECORD         8       // Bytes of the centers in the EEPROM (X and Y of the mover and the rotation, 16 bits)
+
+// With FAST_BOOT true Start() reads the centers of the joysticks from the EEPROM
+// (QURStore.h) instead of sampling them, skips the animation of the LED and
+// doesn't wait the ModuleLCD: the controller sends in less than 100 ms after
+// the reset. The first boot (or with the button A pressed) samples the centers
+// and TaskJoysticks saves them in the background
+#ifndef FAST_BOOT
+	#define FAST_BOOT true
+#endif
+
+// ---------------------------------------------------------------------------
+// TIMING DEFINE'S
+// Period in microseconds of every stage of the Routine (see QURScheduler.h)
+// ---------------------------------------------------------------------------
+#define RATE_JOYSTICK   5000UL      // Sample the joysticks and the buttons (200 Hz)
+#define RATE_KEEPALIVE  100000UL    // Send the command again if nothing changed (10 Hz)
+#define PHASE_SEND      1000UL      // The keepalive runs 1 ms after a sample, so it always has a fresh one
+#define RATE_RADIO      1000UL      // Check the end of the transmission (1 kHz)
+#define RATE_LCD        250000UL    // Refresh the screen of the ModuleLCD (4 Hz)
+#define LCD_ACK_TIMEOUT 500000UL    // Time to wait the ACKs of the ModuleLCD before sending all the lines again
+#define LCD_REFRESH     8           // Every LCD_REFRESH periods all the lines are sent (the ModuleLCD could have restarted)
+#define LCD_LINES       3           // Lines of the screen (Mode, Angle and Buttons)
+
+// Task IDs, in the order they are added to the Scheduler
+#define TASK_JOYSTICK   0
+#define TASK_SEND       1
+#define TASK_LCD        2
+#define TASK_RADIO      3
+
+// ---------------------------------------------------------------------------
+// RADIO DEFINE'S
+// ---------------------------------------------------------------------------
+#define RF_RETRY_DELAY  5           // Delay between the retries of the nRF24 ((5 + 1) * 250 us, the ACK payload needs it at 250 kbps)
+#define RF_RETRY_COUNT  3           // Retries of the nRF24 before MAX_RT (a lost packet costs ~7 ms of air, not of CPU)
+#define RF_TX_TIMEOUT   15000UL     // A transmission without TX_DS or MAX_RT in this time is dropped (radio not answering)
+const byte addresses[][6] = {"0"};  // Addresses: Address of comunication
 
 class RFControl
 {
@@ -73,14 +148,23 @@ class RFControl
 	{
 		typedef struct Controler
 		{
-			int ReadX = 0;
-			int ReadY = 0;
-			void ReadValues(int, int);
+			int16_t Filtered[2] = {JOYSTICK_ZERO, JOYSTICK_ZERO};   // Filtered: Output of the filter of every axis (X, Y)
+			int16_t Center[2] = {JOYSTICK_ZERO, JOYSTICK_ZERO};     // Center: Calibrated center of every axis (X, Y)
+			int ReadX = 0;                  // ReadX: Position of the axis X (-512 to 512, 0 inside the deadzone)
+			int ReadY = 0;                  // ReadY: Position of the axis Y (-512 to 512, 0 inside the deadzone)
+			void Calibrate(int, int);
+			bool ReadValues(int, int);
 		};
 		Controler JoystickRotar;
 		Controler JoystickMover;
 		int Angle = 0;
-		bool Mode = ROTATION;
+		uint8_t Magnitude = 0;
+		bool Mode = ROTATION;               // Mode: Follows the last joystick moved out of his deadzone
+		QURStoreWriter Store;               // Store: Saves the centers in the EEPROM (FAST_BOOT)
+		void Calibrate();
+		bool LoadCalibration();             // LoadCalibration: Reads the centers from the EEPROM, false if there are none
+		void SaveCalibration();             // SaveCalibration: Starts to save the centers in the EEPROM (TaskJoysticks)
+		static uint8_t CalibrationByte(void *, uint16_t);   // CalibrationByte: Byte N of the record of the EEPROM (QURStoreSource)
 		void ConvertToVector();
 	};
 
@@ -92,28 +176,47 @@ class RFControl
 
 	JOYSTICK_DRIVER Joysticks;
 	PUSH_DRIVER PushControl;
-	TIMES TimeOutSender;
+	QURScheduler Scheduler;             // Scheduler: Runs the stages of the Routine, every one at his own rate
+	QURTimer LCDTimeout;                // LCDTimeout: Ends when the ModuleLCD took too long to acknowledge
+	QURLCDParser LCDParser;             // LCDParser: Reads the ACKs of the ModuleLCD
+	char LCDShown[LCD_LINES][QUR_LCD_COLS + 1];  // LCDShown: Last text sent of every line
+	uint8_t LCDPending = 0;             // LCDPending: Lines sent without ACK
+	uint8_t LCDRefresh = 0;             // LCDRefresh: Periods since all the lines were sent
+	bool LCDForce = true;               // LCDForce: The next update sends every line
+	uint16_t LCDTimeouts = 0;           // LCDTimeouts: Updates not acknowledged (wraps)
+	uint16_t Sent = 0;                  // Sent: Packets acknowledged by the robot (wraps)
+	uint16_t Keepalives = 0;            // Keepalives: Packets sent without a change of the command (wraps)
+	uint16_t Failed = 0;                // Failed: Packets not acknowledged (wraps)
+	bool Transmitting = false;          // Transmitting: A packet is in the air, waiting TX_DS or MAX_RT
+	QURTimer TxTimeout;                 // TxTimeout: Ends when the radio took too long to finish
+	QURCommand Pending;                 // Pending: Command of the packet in the air
+	QURStatus Robot;                    // Robot: Last state received in an ACK
+	QURPacketReader StatusReader;       // StatusReader: Checks the STATUS packets of the robot
+	uint16_t Statuses = 0;              // Statuses: STATUS packets received (wraps)
 
 	// ---------------------------------------------------------------------------
-	// STRUCT OF PACKAGE RF
-	// This contains all data recived from the RF Controler in mode Vector 
-	// or mode Automatic
+	// COMMAND RF
+	// Mode, Angle and Buttons sent to the Hexapod, the packet is shared with
+	// the robot (QURPacket.h) so both read the same bytes
 	// ---------------------------------------------------------------------------
-	struct package
-	{
-	    bool Mode = WALKING;
-	    int Angle = 0;
-	    int VectorPush[3] = {0, 0, 0};
-	};
-	typedef struct package Package;
-	Package Data;                       // Data: Instance of Struct Package
+	QURCommand Data;                    // Data: Command sent to the Hexapod
+	QURPacketWriter Writer;             // Writer: Encodes Data into packets (sequence and CRC)
+	QURCommand Last;                    // Last: Last command acknowledged by the robot
 	void UpdateLCD();
 	void StartLCD();
 	void StartRF();
-	void SendData();
+	bool SendData();
+	void CheckRadio();
+	bool CommandChanged();
+	static void TaskJoysticks(void *);  // TaskJoysticks: Samples the joysticks and the buttons into Data
+	static void TaskSend(void *);       // TaskSend: Sends Data again to the robot (keepalive)
+	static void TaskLCD(void *);        // TaskLCD: Refreshes the screen without waiting the ModuleLCD
+	static void TaskRadio(void *);      // TaskRadio: Finishes the transmission in progress and reads the ACK payload
 public:
 	void Start();
 	void Routine();
+	const QURStatus &Status() const { return Robot; }
+	uint16_t StatusCount() const { return Statuses; }
 };
 
 #endif
\ No newline at end of file
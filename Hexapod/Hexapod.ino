@@ -1,88 +1,50 @@
-#define DEBUG true
+// The options of the firmware (DEBUG, PROFILER, MODULESD, PCLINK, geometry) are in QURConfig.h
 #include "QURHexapod.h"
 
-const int Limit_X[2][6] = 
+// Limits of the servos {MIN, MAX} per leg, in the flash (QURHexapod reads them with pgm_read_word)
+const int16_t Limit_X[2][6] PROGMEM = 
 {
 	{45, 45, 45, 45, 45, 45},
 	{135, 135, 135, 135, 135, 135}
 };
-const int Limit_Y[2][6] = 
+const int16_t Limit_Y[2][6] PROGMEM = 
 {
 	{0, 60, 90, 60, 0, 0},
 	{100, 160, 180, 160, 100, 100}
 };
-
-int   Walk[6][2][6] = {
-{
-	{50, 50, 50, 50, 50, 50},
-	{100, 50, 100, 75, 50, 50}
-},
-{
-	{80, 50, 20, 50, 50, 50},
-	{100, 50, 100, 100, 50, 50}
-	},
-{
-	{80, 50, 20, 35, 50, 50},
-	{50, 50, 50, 75, 50, 50}
-},
+#if __SERVOS__ > 2
+// Legs of 3 servos (__SERVOS__ 3 and SERVO_PINS_Z in QURConfig.h)
+const int16_t Limit_Z[2][6] PROGMEM = 
 {
-	{50, 50, 50, 35, 50, 50},
-	{50, 100, 50, 50, 75, 100}
-},
-{
-	{50, 20, 50, 50, 50, 80},
-	{50, 100, 50, 50, 100, 100}
-},
-{
-	{50, 20, 50, 50, 65, 80},
-	{50, 50, 50, 50, 75, 50}
-},
-{
-	{50, 50, 50, 50, 35, 50},
-	{50, 50, 50, 50, 50, 50}
-},
+	{30, 30, 30, 30, 30, 30},
+	{150, 150, 150, 150, 150, 150}
 };
+#endif
 
-int Rotate[6][2][6] = {
-{
-	{50, 50, 50, 50, 50, 50},
-	{50, 100, 50, 100, 50, 100}
-},
-{
-	{50, 80, 50, 80, 50, 80},
-	{50, 100, 50, 100, 50, 100}
-},
-{
-	{50, 80, 50, 80, 50, 80},
-	{50, 50, 50, 50, 50, 50}
-},
-{
-	{50, 50, 50, 50, 50, 50},
-	{100, 50, 100, 50, 100, 50}
-},
-{
-	{80, 50, 80, 50, 80, 50},
-	{100, 50, 100, 50, 100, 50}
-},
-{
-	{80, 50, 80, 50, 80, 50},
-	{50, 50, 50, 50, 50, 50}
-},
-{
-	{50, 50, 50, 50, 50, 50},
-	{50, 50, 50, 50, 50, 50}
-},
-};
+// The gaits (GAIT_WALK, GAIT_ROTATE, GAIT_STAND) are stored in the flash, they are
+// compiled from the files in "Gaits/" with Tools/GaitCompiler into QURGaits.h.
+// Example: QUR001H.PlayGait(GAIT_WALK);
+// Without tables the gait generator walks to the heading of the RF-Controller:
+// Example: QUR001H.StartWalk(GAIT_TRIPOD, 1000);
+#include "QURGaits.h"
+
+#if __SERVOS__ > 2
+QURHexapod QUR001H(Limit_X, Limit_Y, Limit_Z);
+#else
+QURHexapod QUR001H(Limit_X, Limit_Y);
+#endif
 
 void setup()
 {
 	RGB_SET_WAITING();
-	QURHexapod QUR001H(Limit_X, Limit_Y);
+	QUR001H.Start();				// With FAST_BOOT the tables of the servos come from the EEPROM
+#if !FAST_BOOT
 	delay(500);
+#endif
 	RGB_SET_OK();
 }
 
 void loop()
 {
-	
+	QUR001H.Routine();
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+// ---------------------------------------------------------------------------
+// Configuration of the Hexapod, Quantum robotics Library
+//
+// BACKGROUND:
+// The Arduino IDE compiles Hexapod.ino and every .cpp of the sketch
+// (QURHexapod.cpp, QURServoOutput.cpp, ...) apart, a #define written in the
+// sketch is only seen by Hexapod.ino. The options below change the members
+// of QURHexapod (histograms, buffers, vectors of the servos) or the code of
+// the Routine, so all the files must see the same value: they are only
+// changed here, QURHexapod.h includes this file before anything else.
+// A build define (-DPROFILER=true, CMake) reaches every file and overrides
+// the value of this file.
+// ---------------------------------------------------------------------------
+
+#ifndef QURCONFIG_H
+#define QURCONFIG_H
+
+// ---------------------------------------------------------------------------
+// GEOMETRY (QURGeometry.h)
+// 2, 4, 6 or 8 legs with 2 servos (X, Y) or 3 servos (X, Y, Z), this is the
+// only place to change them: every vector of the servos is sized with them.
+// The pins are one per leg in every axis, legs of 3 servos need SERVO_PINS_Z
+// ---------------------------------------------------------------------------
+#ifndef __SERVOS__
+  #define __SERVOS__  2     // Number of Servos per Leg
+#endif
+#ifndef __LEGS__
+  #define __LEGS__    6     // Number of Legs in the Robot
+#endif
+#ifndef SERVO_PINS_X
+  #define SERVO_PINS_X  {2, 3, 4, 5, 6, 7}
+#endif
+#ifndef SERVO_PINS_Y
+  #define SERVO_PINS_Y  {8, 9, 10, 11, 12, 13}
+#endif
+// Legs of 3 servos: define SERVO_PINS_Z too, for example {22, 23, 24, 25, 26, 27} (more
+// than 16 joints use QURTimerOutput, two PCA9685 or the Servo library with his timers)
+
+// ---------------------------------------------------------------------------
+// COMUNICATION
+// ---------------------------------------------------------------------------
+// Defined the port to comunicate to the plataform for Debugging or Interpretation
+#ifndef PCSerial
+  #define PCSerial Serial
+#endif
+// Define the baudrate for the Serial's PORTS
+#ifndef BAUDRATE
+  #define BAUDRATE 115200
+#endif
+// DEBUG Allows to the Hexapod to send data about the things is he doing to the PC from the Serial Port
+#ifndef DEBUG
+  #define DEBUG false
+#endif
+// DEBUG_LEVEL selects the messages compiled (QURDebug.h): DEBUG_LEVEL_NONE, ERROR, WARNING,
+// INFO or TRACE (every setpoint, hot path). DEBUG true is DEBUG_LEVEL_INFO. The messages are
+// numbers with binary arguments (QURMessages.h), decode them with Tools/DebugDecoder
+#ifndef DEBUG_LEVEL
+  #if DEBUG
+    #define DEBUG_LEVEL DEBUG_LEVEL_INFO
+  #else
+    #define DEBUG_LEVEL DEBUG_LEVEL_NONE
+  #endif
+#endif
+
+// ---------------------------------------------------------------------------
+// MODULESD
+// Define MODULESD works if you are using a Arduino Due or Mega and you connect a Module for controlling
+// a microSD this MODULE Works like Master -> Slave to a another Atmega328p conected to a MicroSD.
+// With MODULESD true the robot records his flight in the card (QURRecorder.h): the packets
+// received, the setpoints, the pulses of the joints and the timings of the loop, decode the
+// log in the PC with Tools/LogDecoder. QURHexapod keeps two blocks of 512 bytes for it
+// ---------------------------------------------------------------------------
+#ifndef MODULESD
+  #define MODULESD false
+#endif
+#ifndef SDcontrol
+  #define SDcontrol Serial1         // Port of the ModuleSD
+#endif
+#ifndef SD_BAUDRATE
+  #define SD_BAUDRATE 250000        // Baudrate of the ModuleSD (exact in a AVR of 16 MHz, 25 KB/s)
+#endif
+
+// ---------------------------------------------------------------------------
+// PCLINK
+// With PCLINK true the robot reads the frames of a PC in the PCSerial (QURPCLink.h):
+// setpoints of the 12 joints (direct or keyframes of the motion queue) and the mode,
+// and answers every batch of frames with his state. Streams 100+ setpoints per second
+// ---------------------------------------------------------------------------
+#ifndef PCLINK
+  #define PCLINK false
+#endif
+
+// ---------------------------------------------------------------------------
+// MOTION ENGINE (QURHexapod.h, QURMotionTimer.h)
+// ---------------------------------------------------------------------------
+#ifndef MOTION_RATE
+  #define MOTION_RATE   200         // Interpolations per second of the motion engine
+#endif
+#ifndef MOTION_QUEUE
+  #define MOTION_QUEUE  8           // Keyframes waiting in the queue (power of 2)
+#endif
+#ifndef MOTION_BLEND_SHIFT
+  #define MOTION_BLEND_SHIFT  4     // log2 of the maximum interpolations of a blend (16 = 80 ms at 200 Hz)
+#endif
+
+// ---------------------------------------------------------------------------
+// CALIBRATION
+// With FAST_BOOT true Start() reads the tables and the trims of the servos
+// from the EEPROM (QURStore.h) and setup() doesn't wait for them
+// ---------------------------------------------------------------------------
+#ifndef FAST_BOOT
+  #define FAST_BOOT true
+#endif
+
+// ---------------------------------------------------------------------------
+// TELEMETRY AND PROFILER
+// ---------------------------------------------------------------------------
+// If TELEMETRY is true the robot sends every RATE_TELEMETRY a line with his state to the PCSerial
+#ifndef TELEMETRY
+  #define TELEMETRY false
+#endif
+// If PROFILER is true the Routine measures the microseconds of his stages in
+// histograms and sends every RATE_PROFILE one stage to the PCSerial in a binary
+// frame (QURProfiler.h), decode them in the PC with Tools/ProfileDecoder
+#ifndef PROFILER
+  #define PROFILER false
+#endif
+// Timebase of the PROFILER, a board with a cycle counter can use it instead (the
+// host benchmark uses the nanoseconds of the host)
+#ifndef PROFILE_CLOCK
+  #define PROFILE_CLOCK micros
+#endif
+
+#endif
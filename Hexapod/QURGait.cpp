@@ -0,0 +1,64 @@
+// ---------------------------------------------------------------------------
+// See "QURGait.h" for the description of the gait format.
+// ---------------------------------------------------------------------------
+
+#include "QURGait.h"
+
+/**
+  @Struct GaitReader
+  @Function Begin
+  @purpuse Starts to read a gait stored in PROGMEM
+
+  @param __GAIT__ Pointer to the gait
+  @return Returns false if the gait is NULL or the version is not GAIT_VERSION
+*/
+bool GaitReader::Begin(const uint8_t *__GAIT__){
+  Gait = NULL;
+  if(__GAIT__ == NULL || pgm_read_byte(__GAIT__) != GAIT_VERSION)
+    return false;
+  Gait = __GAIT__;
+  Rewind();
+  return true;
+}
+
+/**
+  @Struct GaitReader
+  @Function Rewind
+  @purpuse Goes back to the first frame
+*/
+void GaitReader::Rewind(){
+  Offset = GAIT_HEADER;
+  Frame  = 0;
+}
+
+uint8_t GaitReader::Frames() const {
+  return Gait ? pgm_read_byte(Gait + 1) : 0;
+}
+
+bool GaitReader::Loop() const {
+  return Gait && (pgm_read_byte(Gait + 2) & GAIT_LOOP);
+}
+
+/**
+  @Struct GaitReader
+  @Function Next
+  @purpuse Reads the next frame, only the joints of the mask are changed in Setpoints
+
+  @param __DURATION__ Returns the duration of the frame in milliseconds
+  @return Returns false if there are no more frames
+*/
+bool GaitReader::Next(uint16_t &__DURATION__){
+  if(Gait == NULL || Frame >= Frames())
+    return false;
+  const uint8_t *data = Gait + Offset;
+  __DURATION__  = (uint16_t)pgm_read_byte(data) * GAIT_TIME_UNIT;
+  uint16_t mask = pgm_read_byte(data + 1) | ((uint16_t)pgm_read_byte(data + 2) << 8);
+  data += 3;
+  for(uint8_t x = 0; x < GAIT_JOINTS; x++){   // Cicle with a iterator 'x' that go over each joint of the mask
+    if(mask & (1U << x))
+      Setpoints[x] = pgm_read_byte(data++);
+  }
+  Offset = (uint16_t)(data - Gait);
+  Frame++;
+  return true;
+}
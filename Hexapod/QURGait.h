@@ -0,0 +1,50 @@
+// ---------------------------------------------------------------------------
+// Gait format of the Hexapod Quantum robotics Library
+//
+// BACKGROUND:
+// A gait is a sequence of keyframes (setpoints 0-100 of the 12 servos and a
+// duration) stored in the flash (PROGMEM), so it doesn't use SRAM. The gaits
+// are written as CSV/JSON in "Gaits/" and compiled with Tools/GaitCompiler
+// into "QURGaits.h". The QURHexapod plays them frame by frame (PlayGait).
+//
+// FORMAT (bytes):
+//   Header:  [0] GAIT_VERSION  [1] Number of frames  [2] Flags (GAIT_LOOP)
+//   Frame:   [0]    Duration in units of GAIT_TIME_UNIT milliseconds
+//            [1-2]  Mask of the joints that change (little endian), bit 0-5 are
+//                   the legs 0-5 in the Axis X and bit 6-11 the legs in Axis Y
+//            [3..]  One byte (0-100) for every bit set in the mask
+//   The first frame always has all the joints, so the gait can be restarted.
+//
+// READER:
+//   GaitReader Reader;
+//   Reader.Begin(GAIT_WALK);              - Starts to read a gait (pointer to PROGMEM)
+//   Reader.Next(Duration);                - Reads the next frame into Reader.Setpoints, returns false at the end
+//   Reader.Rewind();                      - Goes back to the first frame
+// ---------------------------------------------------------------------------
+
+#ifndef QURGAIT_H
+#define QURGAIT_H
+
+#include <Arduino.h>
+
+#define GAIT_VERSION     1      // Version of the format
+#define GAIT_JOINTS      12     // Joints per frame (6 legs in X and 6 legs in Y)
+#define GAIT_HEADER      3      // Bytes of the header
+#define GAIT_TIME_UNIT   10     // Milliseconds per unit of the duration
+#define GAIT_LOOP        0x01   // Flag: The gait starts again at the end
+#define GAIT_MAX_FRAMES  255    // Maximum frames per gait
+
+struct GaitReader
+{
+  const uint8_t *Gait = NULL;             // Gait: Pointer to the gait in PROGMEM
+  uint16_t Offset = 0;                    // Offset: Byte of the next frame
+  uint8_t Frame = 0;                      // Frame: Number of the next frame
+  uint8_t Setpoints[GAIT_JOINTS];         // Setpoints: Values of the last frame (the deltas are applied over them)
+  bool Begin(const uint8_t *);            // Begin: Starts to read a gait, returns false if the version is not valid
+  void Rewind();                          // Rewind: Goes back to the first frame
+  uint8_t Frames() const;                 // Frames: Number of frames of the gait
+  bool Loop() const;                      // Loop: The gait has the flag GAIT_LOOP
+  bool Next(uint16_t &);                  // Next: Reads the next frame into Setpoints and his duration in ms
+};
+
+#endif
@@ -0,0 +1,166 @@
+// ---------------------------------------------------------------------------
+// See "QURGaitGenerator.h" for the description of the generator.
+// ---------------------------------------------------------------------------
+
+#include "QURGaitGenerator.h"
+
+// Mounting angle of every leg in binary degrees (256 = 360 degrees):
+// front-right 45, front-left 135, middle-left 180, rear-left 225, rear-right 315, middle-right 0
+const uint8_t LEG_ANGLES[GEN_LEGS] PROGMEM = {32, 96, 128, 160, 224, 0};
+
+// Offset of every leg in the cycle (Q16) and part of the cycle on the ground (Q16)
+const uint16_t GAIT_OFFSETS[GAIT_TYPES][GEN_LEGS] PROGMEM = {
+  {    0, 32768,     0, 32768,     0, 32768},   // GAIT_TRIPOD: two alternating groups of 3 legs
+  {43691, 10923, 54613, 32768,     0, 21845},   // GAIT_RIPPLE: every side in sequence, the sides half cycle apart
+  {21845, 54613, 43691, 32768,     0, 10923}    // GAIT_WAVE: one leg after the other from rear-right
+};
+const uint16_t GAIT_DUTY[GAIT_TYPES] PROGMEM = {32768, 43691, 54613};
+
+// Quarter of a sine wave in Q7 (127 = 1.0), 64 steps of binary degree
+const int8_t SINE_Q7[65] PROGMEM = {
+    0,   3,   6,   9,  12,  16,  19,  22,  25,  28,  31,  34,  37,  40,  43,  46,
+   49,  51,  54,  57,  60,  63,  65,  68,  71,  73,  76,  78,  81,  83,  85,  88,
+   90,  92,  94,  96,  98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116,
+  117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127,
+  127
+};
+
+// Sine of a binary angle (256 = 360 degrees) in Q7
+static int8_t SineQ7(uint8_t __ANGLE__){
+  uint8_t index = __ANGLE__ & 0x3F;
+  int8_t value;
+  if(__ANGLE__ & 0x40)                        // Second and fourth quarter go down
+    value = (int8_t)pgm_read_byte(&SINE_Q7[64 - index]);
+  else
+    value = (int8_t)pgm_read_byte(&SINE_Q7[index]);
+  return (__ANGLE__ & 0x80) ? -value : value; // Second half is negative
+}
+
+/**
+  @Struct GaitGenerator
+  @Function Begin
+  @purpuse Selects the gait and the speed, and enables the generator
+
+  @param __GAIT__  Type of gait (GAIT_TRIPOD, GAIT_RIPPLE, GAIT_WAVE)
+  @param __CYCLE__ Milliseconds of one cycle
+  @param __TICK__  Microseconds between calls to Step
+*/
+void GaitGenerator::Begin(uint8_t __GAIT__, uint16_t __CYCLE__, uint32_t __TICK__){
+  Gait  = __GAIT__ < GAIT_TYPES ? __GAIT__ : GAIT_TRIPOD;
+  Duty  = pgm_read_word(&GAIT_DUTY[Gait]);
+  StanceScale = (uint16_t)(16777216UL / Duty);
+  SwingScale  = (uint16_t)(16777216UL / (65536UL - Duty));
+  TickPeriod  = __TICK__;
+  Phase = 0;
+  SetCycle(__CYCLE__);
+  UpdateAmplitudes();
+  Enabled = true;
+}
+
+/**
+  @Struct GaitGenerator
+  @Function SetCycle
+  @purpuse Changes the speed of the gait without losing the phase
+
+  @param __CYCLE__ Milliseconds of one cycle (0 = stop in the current phase)
+*/
+void GaitGenerator::SetCycle(uint16_t __CYCLE__){
+  if(__CYCLE__ == 0){
+    PhaseStep = 0;
+    return;
+  }
+  // 65536 * TickPeriod / (Cycle * 1000) without overflow for ticks up to 0.5 s
+  uint32_t step = (TickPeriod * 8192UL / 125UL) / __CYCLE__;
+  PhaseStep = step > 32767 ? 32767 : (uint16_t)step;   // Less than half cycle per tick
+}
+
+/**
+  @Struct GaitGenerator
+  @Function SetStride
+  @purpuse Sets the length of the stride and the height of the swing
+
+  @param __STRIDE__ Length of the stride in setpoint units of the servo X (0-100)
+  @param __LIFT__   Height of the swing in setpoint units of the servo Y (0-50)
+*/
+void GaitGenerator::SetStride(uint8_t __STRIDE__, uint8_t __LIFT__){
+  Stride = __STRIDE__ > 100 ? 100 : __STRIDE__;
+  Lift   = __LIFT__ > 100 - GEN_GROUND_Y ? 100 - GEN_GROUND_Y : __LIFT__;
+  UpdateAmplitudes();
+}
+
+/**
+  @Struct GaitGenerator
+  @Function SetHeading
+  @purpuse Sets the direction of the walk, the amplitudes are recalculated only
+       if it changed
+
+  @param __HEADING__ Direction in degrees (like atan2, 90 = forward)
+*/
+void GaitGenerator::SetHeading(int __HEADING__){
+  if(__HEADING__ == Heading && Turn == 0)
+    return;
+  Heading = __HEADING__;
+  Turn = 0;
+  UpdateAmplitudes();
+}
+
+/**
+  @Struct GaitGenerator
+  @Function SetTurn
+  @purpuse Rotates the robot in place
+
+  @param __TURN__ 1 = counter-clockwise, -1 = clockwise, 0 = walk to the Heading
+*/
+void GaitGenerator::SetTurn(int8_t __TURN__){
+  if(__TURN__ == Turn)
+    return;
+  Turn = __TURN__;
+  UpdateAmplitudes();
+}
+
+/**
+  @Struct GaitGenerator
+  @Function UpdateAmplitudes
+  @purpuse Projects the heading over the swing of every leg
+*/
+void GaitGenerator::UpdateAmplitudes(){
+  uint8_t heading = (uint8_t)(((int32_t)Heading * 182L) >> 8);   // Degrees to binary degrees (256 / 360)
+  for(uint8_t x = 0; x < GEN_LEGS; x++){                          // Cicle with a iterator 'x' that go over each LEG
+    if(Turn != 0)
+      Amplitude[x] = Turn > 0 ? (int8_t)Stride : -(int8_t)Stride;
+    else
+      Amplitude[x] = (int8_t)(((int16_t)Stride * SineQ7(pgm_read_byte(&LEG_ANGLES[x]) - heading)) >> 7);
+  }
+}
+
+/**
+  @Struct GaitGenerator
+  @Function Step
+  @purpuse Advances the phase one tick and writes the setpoints of every leg:
+       stance moves the foot from +Amplitude/2 to -Amplitude/2 on the ground,
+       swing returns it lifted with a parabola 4f(1 - f)
+
+  @param __X__ Vector of the setpoints in Axis X (GEN_LEGS)
+  @param __Y__ Vector of the setpoints in Axis Y (GEN_LEGS)
+*/
+void GaitGenerator::Step(int __X__[], int __Y__[]){
+  Phase += PhaseStep;                                             // Wraps at the end of the cycle
+  const uint16_t *offsets = GAIT_OFFSETS[Gait];
+  for(uint8_t x = 0; x < GEN_LEGS; x++){                          // Cicle with a iterator 'x' that go over each LEG
+    uint16_t phase = Phase + pgm_read_word(&offsets[x]);
+    int32_t amplitude = Amplitude[x];
+    uint32_t f;                                                   // f: Progress of the stance or the swing (Q16)
+    if(phase < Duty){                                             // Stance: foot on the ground going back
+      f = ((uint32_t)phase * StanceScale) >> 8;
+      if(f > 65535) f = 65535;
+      __X__[x] = GEN_CENTER_X + amplitude / 2 - ((amplitude * (int32_t)f) >> 16);
+      __Y__[x] = GEN_GROUND_Y;
+    }
+    else{                                                         // Swing: foot in the air going forward
+      f = ((uint32_t)(phase - Duty) * SwingScale) >> 8;
+      if(f > 65535) f = 65535;
+      __X__[x] = GEN_CENTER_X - amplitude / 2 + ((amplitude * (int32_t)f) >> 16);
+      __Y__[x] = GEN_GROUND_Y + (int)(((uint32_t)Lift * ((f * (65536UL - f)) >> 14)) >> 16);
+    }
+  }
+}
@@ -0,0 +1,75 @@
+// ---------------------------------------------------------------------------
+// Parametric gait generator of the Hexapod Quantum robotics Library
+//
+// BACKGROUND:
+// Computes the setpoints (0-100) of the 12 servos of a walking gait without
+// tables of frames. A phase accumulator (Q16, 65536 = one cycle) advances a
+// fixed step every control tick and every leg reads the cycle with his own
+// offset. While the leg is on the ground (stance, the first Duty part of the
+// cycle) the servo X moves the foot backward and in the air (swing) the foot
+// returns forward lifted with a parabola in the servo Y. Only additions,
+// multiplications and shifts are done per tick, the divisions are done when
+// the gait, the speed or the heading changes.
+//
+// HEADING:
+// The legs are 2DOF, the servo X swings the foot tangent to the body, so the
+// stride of every leg is the projection of the heading over his swing:
+// Stride * sin(LegAngle - Heading). The angles are like atan2() of the
+// joystick (0 = right, 90 = forward), LEG_ANGLES has the mounting angle of
+// every leg (numbered counter-clockwise from the front-right leg).
+// In turn mode all legs swing to the same side and the robot rotates.
+//
+// GAITS:
+//   GAIT_TRIPOD - 3 legs in the air at the same time (Duty 1/2), fastest
+//   GAIT_RIPPLE - 2 legs in the air (Duty 2/3)
+//   GAIT_WAVE   - 1 leg in the air (Duty 5/6), slowest and most stable
+//
+// USE:
+//   GaitGenerator Generator;
+//   Generator.Begin(GAIT_TRIPOD, 1000, 20000);  - Gait, cycle in ms and tick in microseconds
+//   Generator.SetHeading(90);                   - Walk forward
+//   Generator.Step(AnglesX, AnglesY);           - Every tick, writes the setpoints of the 6 legs
+// ---------------------------------------------------------------------------
+
+#ifndef QURGAITGENERATOR_H
+#define QURGAITGENERATOR_H
+
+#include <Arduino.h>
+
+#define GAIT_TRIPOD     0
+#define GAIT_RIPPLE     1
+#define GAIT_WAVE       2
+#define GAIT_TYPES      3
+
+#define GEN_LEGS        6       // Legs moved by the generator
+#define GEN_CENTER_X    50      // Setpoint of the servo X in the middle of the stride
+#define GEN_GROUND_Y    50      // Setpoint of the servo Y with the foot on the ground
+#define GEN_STRIDE      30      // DEFAULT: Length of the stride (setpoint units of the servo X)
+#define GEN_LIFT        50      // DEFAULT: Height of the swing (setpoint units of the servo Y)
+#define GEN_CYCLE       1000    // DEFAULT: Milliseconds of one cycle of the gait
+
+struct GaitGenerator
+{
+  bool Enabled = false;           // Enabled: The generator writes the setpoints
+  uint8_t Gait = GAIT_TRIPOD;     // Gait: Type of gait (GAIT_TRIPOD, GAIT_RIPPLE, GAIT_WAVE)
+  uint16_t Phase = 0;             // Phase: Phase accumulator of the cycle (Q16)
+  uint16_t PhaseStep = 0;         // PhaseStep: Phase advanced every tick (Q16), 0 = stopped
+  uint16_t Duty = 32768;          // Duty: Part of the cycle on the ground (Q16)
+  uint16_t StanceScale = 512;     // StanceScale: 2^24 / Duty, converts the phase of the stance to Q16
+  uint16_t SwingScale = 512;      // SwingScale: 2^24 / (65536 - Duty), converts the phase of the swing to Q16
+  uint32_t TickPeriod = 20000;    // TickPeriod: Microseconds between calls to Step
+  uint8_t Stride = GEN_STRIDE;    // Stride: Length of the stride (0-100)
+  uint8_t Lift = GEN_LIFT;        // Lift: Height of the swing (0-50)
+  int Heading = 90;               // Heading: Direction of the walk in degrees
+  int8_t Turn = 0;                // Turn: 0 = walk to Heading, 1 = rotate counter-clockwise, -1 = clockwise
+  int8_t Amplitude[GEN_LEGS];     // Amplitude: Stride of every leg with sign (projection of the heading)
+  void Begin(uint8_t, uint16_t, uint32_t);  // Begin: Selects the gait, the cycle (ms) and the tick (us) and enables the generator
+  void SetCycle(uint16_t);        // SetCycle: Milliseconds of one cycle (0 = stop in the current phase)
+  void SetStride(uint8_t, uint8_t);         // SetStride: Length of the stride and height of the swing
+  void SetHeading(int);           // SetHeading: Direction of the walk in degrees (walk mode)
+  void SetTurn(int8_t);           // SetTurn: Rotation in place (1 / -1), 0 returns to walk mode
+  void Step(int[], int[]);        // Step: Advances one tick and writes the setpoints X/Y of the legs
+  void UpdateAmplitudes();        // UpdateAmplitudes: Recalculates the stride of every leg
+};
+
+#endif
@@ -0,0 +1,33 @@
+// ---------------------------------------------------------------------------
+// Gaits of the Hexapod (format in QURGait.h)
+// Generated by Tools/GaitCompiler, don't edit it, edit the files in Gaits/
+// ---------------------------------------------------------------------------
+
+#ifndef QURGAITS_H
+#define QURGAITS_H
+
+#include "QURGait.h"
+
+// Gaits/walk.csv: 7 frames, 61 bytes, cycle 1750 ms (loop)
+const uint8_t GAIT_WALK[] PROGMEM = {
+    1,  7,  1, 25,255, 15, 50, 50, 50, 50, 50, 50,100, 50,100, 75,
+   50, 50, 25,  5,  2, 80, 20,100, 25, 72,  3, 35, 50, 50, 75, 25,
+  133, 14, 50, 50,100, 50, 75,100, 25, 42,  4, 20, 50, 80,100, 25,
+  144, 12, 65, 50, 75, 50, 25, 50,  4, 50, 35, 50, 50
+};
+
+// Gaits/rotate.csv: 7 frames, 57 bytes, cycle 1750 ms (loop)
+const uint8_t GAIT_ROTATE[] PROGMEM = {
+    1,  7,  1, 25,255, 15, 50, 50, 50, 50, 50, 50, 50,100, 50,100,
+   50,100, 25, 42,  0, 80, 80, 80, 25,128, 10, 50, 50, 50, 25,106,
+    5, 50, 50, 50,100,100,100, 25, 21,  0, 80, 80, 80, 25, 64,  5,
+   50, 50, 50, 25, 21,  0, 50, 50, 50
+};
+
+// Gaits/stand.json: 2 frames, 27 bytes, cycle 1300 ms
+const uint8_t GAIT_STAND[] PROGMEM = {
+    1,  2,  0, 50,255, 15, 50, 50, 50, 50, 50, 50,  0,  0,  0,  0,
+    0,  0, 80,192, 15, 50, 50, 50, 50, 50, 50
+};
+
+#endif
@@ -0,0 +1,99 @@
+// ---------------------------------------------------------------------------
+// Geometry of the robot, Hexapod Quantum robotics Library
+//
+// BACKGROUND:
+// The number of legs and of servos per leg are fixed when the firmware is
+// compiled (__LEGS__ and __SERVOS__ in QURConfig.h), so every vector of the
+// servos has his exact size and the index of a joint, his leg and his axis
+// are constants for the compiler. QURGeometry checks the layout at compile
+// time (legs, axes, bits of the masks and the table of pins): a sketch with
+// a layout that doesn't match the firmware doesn't compile, nothing is
+// checked when the robot runs. QURUnroll repeats a code once per joint
+// without loop, the index of every copy is a constant.
+//
+// LAYOUTS:
+//   2 to 8 legs (even) with 2 servos (X, Y) or 3 servos (X, Y, Z), up to 24
+//   joints (one bit of joint_mask_t and one channel of the output per joint,
+//   joint_mask_t has 32 bits only when the robot has more than 16 joints, like
+//   the hexapod of 3 servos). The joints are numbered leg by leg:
+//   JOINT = Leg * Servos + Axis.
+//
+// USE:
+//   typedef QURGeometry<6, 2> GEOMETRY;
+//   static_assert(GEOMETRY::PinsValid(SERVO_PINS), "...");  - Pins != 0 and not repeated
+//   QURUnroll<GEOMETRY::Joints>::Run([&](uint8_t x){ ... });  - x = 0, 1, ... Joints - 1
+// ---------------------------------------------------------------------------
+
+#ifndef QURGEOMETRY_H
+#define QURGEOMETRY_H
+
+#include <Arduino.h>
+#include "QURConfig.h"
+
+// One bit per servo, the masks of the motion interrupt stay of 16 bits if they fit
+#if __LEGS__ * __SERVOS__ > 16
+typedef uint32_t joint_mask_t;
+#else
+typedef uint16_t joint_mask_t;
+#endif
+
+// ---------------------------------------------------------------------------
+// Layout of the legs and the servos, everything is evaluated by the compiler
+// Methods:
+//      - uint8_t Joint(uint8_t, uint8_t)
+//      - uint8_t Leg(uint8_t)
+//      - uint8_t Axis(uint8_t)
+//      - bool PinsValid(const uint8_t (&)[SERVOS][LEGS])
+// ---------------------------------------------------------------------------
+template <uint8_t LEGS, uint8_t SERVOS>
+struct QURGeometry
+{
+  static_assert(LEGS >= 2 && LEGS <= 8 && LEGS % 2 == 0, "__LEGS__ must be 2, 4, 6 or 8");
+  static_assert(SERVOS == 2 || SERVOS == 3, "__SERVOS__ must be 2 (X, Y) or 3 (X, Y, Z)");
+  static_assert(LEGS * SERVOS <= sizeof(joint_mask_t) * 8, "One bit of joint_mask_t per servo: the layout must be the one of QURConfig.h");
+
+  static constexpr uint8_t Legs   = LEGS;                 // Legs: Legs of the robot
+  static constexpr uint8_t Servos = SERVOS;               // Servos: Servos (axes) per leg
+  static constexpr uint8_t Joints = LEGS * SERVOS;        // Joints: Servos of the robot
+  static constexpr joint_mask_t Mask = (joint_mask_t)((1UL << Joints) - 1);   // Mask: Bits of all the servos
+
+  static constexpr uint8_t Joint(uint8_t __LEG__, uint8_t __AXIS__){ return __LEG__ * SERVOS + __AXIS__; }
+  static constexpr uint8_t Leg(uint8_t __JOINT__){ return __JOINT__ / SERVOS; }
+  static constexpr uint8_t Axis(uint8_t __JOINT__){ return __JOINT__ % SERVOS; }
+
+  // PinsValid: Every joint has a pin (a table with less pins than legs is filled with 0, the pin
+  // of the RX) and no pin is repeated
+  static constexpr bool PinsValid(const uint8_t (&__PINS__)[SERVOS][LEGS], uint8_t __JOINT__ = 0){
+    return __JOINT__ >= Joints ||
+           (Pin(__PINS__, __JOINT__) != 0 && Unique(__PINS__, __JOINT__, __JOINT__ + 1) && PinsValid(__PINS__, __JOINT__ + 1));
+  }
+  static constexpr uint8_t Pin(const uint8_t (&__PINS__)[SERVOS][LEGS], uint8_t __JOINT__){
+    return __PINS__[Axis(__JOINT__)][Leg(__JOINT__)];
+  }
+  static constexpr bool Unique(const uint8_t (&__PINS__)[SERVOS][LEGS], uint8_t __JOINT__, uint8_t __OTHER__){
+    return __OTHER__ >= Joints ||
+           (Pin(__PINS__, __JOINT__) != Pin(__PINS__, __OTHER__) && Unique(__PINS__, __JOINT__, __OTHER__ + 1));
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Calls __CODE__(0), __CODE__(1), ... __CODE__(N - 1) without loop (the hot
+// loops of the servos: no counter nor compare and every index is a constant
+// once the code is inlined)
+// ---------------------------------------------------------------------------
+template <uint8_t N>
+struct QURUnroll
+{
+  template <typename F> static inline __attribute__((always_inline)) void Run(F __CODE__){
+    QURUnroll<N - 1>::Run(__CODE__);
+    __CODE__(N - 1);
+  }
+};
+
+template <>
+struct QURUnroll<0>
+{
+  template <typename F> static inline __attribute__((always_inline)) void Run(F){}
+};
+
+#endif
@@ -9,190 +9,646 @@
 #include <Arduino.h>
 #include <RF24.h>
 
-RF24 RFController(RF_CE, RF_CSN);  // RFController: Instance of the class RF24 to control the antenna.
+static RF24 RFController(RF_CE, RF_CSN);  // RFController: Instance of the class RF24 to control the antenna.
+static QURServoLibrary DefaultOutput;      // DefaultOutput: Servo library, used without SetOutput or if the output can't start
 byte addresses[][6] = {"0"};       // Addresses: Address of comunication
 
-// ---------------------------------------------------------------------------
-// DEBUG Functions
-// Methods:
-//      - DEBUGER: Function that print data to the PC to see how is working 
-//                 the code.
-//      - STOP: Function that stop the code in a specific moment.
-// ---------------------------------------------------------------------------
+QURHexapod *QURHexapod::Instance = NULL;
 
-// Function that recives a Argument String and if DEBUG is enabled print it into the Serial PORT
-void DEBUGER(String __INFO__){
-  #ifndef DEBUG == true
-    PCSerial.println("DEBUG: " + String(__INFO__));
-  #endif
-}
+static_assert(GAIT_JOINTS == QUR_JOINTS && GEN_LEGS == QUR_JOINTS / 2, "The gaits and the link must carry the same legs");
+static_assert(MOTION_QUEUE >= 2 && (MOTION_QUEUE & (MOTION_QUEUE - 1)) == 0 && MOTION_QUEUE <= 128, "MOTION_QUEUE must be a power of 2 (2 to 128)");
 
 // ---------------------------------------------------------------------------
 // QURHexapod constructor
-// This constructor read 2 vector bidimencional and move them i+pñ*pto the MAX and MIN angles per Servo
+// This constructor keeps the tables of MAX and MIN angles (in the flash) and
+// builds the table of pulses of every Servo. The tables are references to
+// arrays of int16_t [2][__LEGS__] (the int of the AVR, the same size in every
+// board), a table of other layout or type doesn't compile
 // ---------------------------------------------------------------------------
-QURHexapod::QURHexapod(int __LIMITx__[__SERVOS__][__LEGS__], int __LIMITy__[__SERVOS__][__LEGS__]){
-  // This cicle go over any leg, with the iterator 'x'
-  for(int x = 0; x < __LEGS__; x++){
-    // Go to 'ServoDriver' -> 'Legs' and call the function SetMinMaxAngles and put in the data.
-    ServoDriver.Legs[x].SetMinMaxAngles(__LIMITx__[0][x], __LIMITx__[1][x], 0);
-    ServoDriver.Legs[x].SetMinMaxAngles(__LIMITy__[0][x], __LIMITy__[1][x], 1);
-    // Go to 'ServoDriver' -> 'Legs' -> 'Joint' and Sets the AXIS per Servo
-    ServoDriver.Legs[x].Joint[ANGLE_X].AXIS = ANGLE_X;
-    ServoDriver.Legs[x].Joint[ANGLE_Y].AXIS = ANGLE_Y;
-  }
+#if __SERVOS__ > 2
+QURHexapod::QURHexapod(const int16_t (&__LIMITx__)[2][__LEGS__], const int16_t (&__LIMITy__)[2][__LEGS__], const int16_t (&__LIMITz__)[2][__LEGS__]){
+  ServoDriver.Limits[ANGLE_Z] = __LIMITz__;
+#else
+QURHexapod::QURHexapod(const int16_t (&__LIMITx__)[2][__LEGS__], const int16_t (&__LIMITy__)[2][__LEGS__]){
+#endif
+  ServoDriver.Limits[ANGLE_X] = __LIMITx__;
+  ServoDriver.Limits[ANGLE_Y] = __LIMITy__;
+  ServoDriver.Output = &DefaultOutput;
+  for(uint8_t x = 0; x < __JOINTS__; x++)           // Every command in the middle
+    Angles[GEOMETRY::Axis(x)][GEOMETRY::Leg(x)] = 50;
+  for(uint8_t x = 0; x < __JOINTS__; x++){          // Cicle with a iterator 'x' that go over each SERVO
+    ServoDriver.Setpoint[x]  = -1;
+    ServoDriver.Trim[x]      = 0;
+    ServoDriver.Target[x]    = (int32_t)DEFAULT_PULSE_WIDTH << 8;
+    ServoDriver.Position[x]  = (int32_t)DEFAULT_PULSE_WIDTH << 8;
+    ServoDriver.Velocity[x]  = 0;
+    ServoDriver.Pulse[x]     = DEFAULT_PULSE_WIDTH;
+    ServoDriver.MoveStep[x]  = 0;
+    ServoDriver.MoveRest[x]  = 0;
+    ServoDriver.MoveError[x] = 0;
+    ServoDriver.SetProfile(x, DEFAULT_SPEED, DEFAULT_ACCEL);
+  }                                                 // The tables of pulses are read or built in Start()
+  ServoDriver.Dirty = JOINTS_MASK;                  // The first TaskSetpoints sends every setpoint
 }
 
 // ---------------------------------------------------------------------------
-// Methods for Legs control
-//    - SetMinMaxAngles(int __MIN__, int __MAX__, int __SELECTOR__)
-//    - GoToSetpoint()
+// Methods for Servos control
+//      - ConfigPinServo(uint8_t __JOINT__)
+//      - SetProfile(uint8_t __JOINT__, int __SPEED__, int __ACCEL__)
+//      - MinAngle(uint8_t __JOINT__)
+//      - MaxAngle(uint8_t __JOINT__)
+//      - Calibrate(uint8_t __JOINT__)
+//      - LoadCalibration()
+//      - SaveCalibration()
+//      - CalibrationByte(void *__DRIVER__, uint16_t __INDEX__)
+//      - CommandPulse(uint8_t __JOINT__, int __COMMAND__)
+//      - PostSetpoint(uint8_t __JOINT__)
+//      - Interpolate(uint8_t __JOINT__)
+//      - PlanMove(uint8_t __JOINT__)
+//      - StepMove(uint8_t __JOINT__, uint16_t __TICKS__)
+//      - WritePulse(uint8_t __JOINT__)
 // ---------------------------------------------------------------------------
 
 /**
-  @Struct QURHexapod -> SERVO_DRIVER -> Leg
-  @Function SetMinMaxAngles
-  @purpuse Function that allows to configure the Maximum and Minimum angle for the servo in especific Axis
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function ConfigPinServo
+ @purpuse Attach the servo to his pin, read from SERVO_PINS
 
-  @param __MIN__ Angle limit minimun for the servo
-  @param __MAX__ Angle limit minimun for the servo
+ @param __JOINT__ Servo (JOINT(leg, axis))
 */
-void QURHexapod::Leg::SetMinMaxAngles(int __MIN__, int __MAX__, int __SELECTOR__){
-  Joint[__SELECTOR__].MAX_Angle = __MAX__;    // Set Servo Max limit to the argument __MAX__
-  Joint[__SELECTOR__].MIN_Angle = __MIN__;    // Set Servo Min limit to the argument __MIN__
+void QURHexapod::SERVO_DRIVER::ConfigPinServo(uint8_t __JOINT__){
+  uint8_t pin = pgm_read_byte(&SERVO_PINS[GEOMETRY::Axis(__JOINT__)][GEOMETRY::Leg(__JOINT__)]);
+  Output->Attach(__JOINT__, pin);                 // Sets the new pin for servo
+  DEBUG_INFO(MESSAGE_SERVO_PIN, GEOMETRY::Leg(__JOINT__), "XYZ"[GEOMETRY::Axis(__JOINT__)], pin);  // DEBUG of the data
 }
 
 /**
-  @Struct QURHexapod -> SERVO_DRIVER -> Leg
-  @Function GoToSetpoint
-  @purpuse Function to move the servo a STEP to the current setpoint
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function SetProfile
+ @purpuse Sets the limits of the trapezoidal profile and converts them to the units of the motion engine
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+ @param __SPEED__ Maximum speed in degrees per second (up to MAX_SPEED)
+ @param __ACCEL__ Acceleration in degrees per second^2 (up to MAX_ACCEL)
 */
-void QURHexapod::Leg::GoToSetpoint(){
-  for(int x = 0; x < __SERVOS__; x++){                    // Cicle pointer 'x' to go over each leg
-    if(Joint[x].Estado != Joint[x].Setpoint){             // Check if the servo angle is equal to the setpoint
-      Joint[x].Is_Finished = false;                       // Flag 'Is_Finished' set False
-      Joint[x].Estado += (Joint[x].Estado < Joint[x].Setpoint ? STEP_SERVO : -STEP_SERVO); // Sets the STEP for the angle
-      Joint[x].Control.write(Joint[x].Estado);            // Write the angle updated to the Servo
-    }
-    else{                                                   // If servo angle is equal to the setpoint
-       Joint[x].Is_Finished = true;                         // Flag 'Is_Finished' set true
-    }
+void QURHexapod::SERVO_DRIVER::SetProfile(uint8_t __JOINT__, int __SPEED__, int __ACCEL__){
+  int32_t speed = __SPEED__ > MAX_SPEED ? SPEED_Q8_MAX : (int32_t)SPEED_TO_Q8(__SPEED__);
+  int32_t accel = __ACCEL__ > MAX_ACCEL ? ACCEL_Q8_MAX : (int32_t)ACCEL_TO_Q8(__ACCEL__);
+  noInterrupts();                                 // The motion interrupt reads the limits
+  SpeedLimit[__JOINT__] = speed > 0 ? speed : 1;  // The servo must always be able to move
+  AccelStep[__JOINT__]  = accel > 0 ? (int16_t)accel : 1;
+  interrupts();
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function MinAngle
+ @purpuse Reads the minimum angle of the servo from the table of the sketch (PROGMEM)
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+ @return Returns the angle in degrees
+*/
+int QURHexapod::SERVO_DRIVER::MinAngle(uint8_t __JOINT__){
+  return (int16_t)pgm_read_word(&Limits[GEOMETRY::Axis(__JOINT__)][0][GEOMETRY::Leg(__JOINT__)]);
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function MaxAngle
+ @purpuse Reads the maximum angle of the servo from the table of the sketch (PROGMEM)
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+ @return Returns the angle in degrees
+*/
+int QURHexapod::SERVO_DRIVER::MaxAngle(uint8_t __JOINT__){
+  return (int16_t)pgm_read_word(&Limits[GEOMETRY::Axis(__JOINT__)][1][GEOMETRY::Leg(__JOINT__)]);
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function Calibrate
+ @purpuse Builds the PulseTable: every point is the angle of the command between
+       the minimum and the maximum angle (with fraction of degree) converted to
+       pulse, plus the Trim, limited to the pulses of the servo. The divisions
+       are done here and not when the setpoints change
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+*/
+void QURHexapod::SERVO_DRIVER::Calibrate(uint8_t __JOINT__){
+  int32_t minimum = MinAngle(__JOINT__);
+  int32_t range   = MaxAngle(__JOINT__) - minimum;
+  uint16_t *table = PulseTable[__JOINT__];
+  for(int x = 0; x < CALIB_POINTS; x++){                  // Cicle with a iterator 'x' that go over each point of the table
+    int32_t angle = minimum * 256L + range * 256L * (x * CALIB_STEP) / 100L;                                      // Q8 degrees
+    int32_t pulse = (int32_t)(MIN_PULSE_WIDTH + Trim[__JOINT__]) * 16L + angle * PULSE_RANGE / (180L * 16L);    // Q4 microseconds
+    if(pulse < MIN_PULSE_WIDTH * 16L) pulse = MIN_PULSE_WIDTH * 16L;                                          // Limits of the servo
+    if(pulse > MAX_PULSE_WIDTH * 16L) pulse = MAX_PULSE_WIDTH * 16L;
+    table[x] = (uint16_t)pulse;
   }
 }
 
-// ---------------------------------------------------------------------------
-// Methods for Servos control
-//      - ConfigPinServo(int __SELECTOR__)
-// ---------------------------------------------------------------------------
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function LoadCalibration
+ @purpuse Reads the PulseTables and the Trims saved in the EEPROM (FAST_BOOT),
+       a few EEPROM reads per point instead of his division. The Trims are
+       kept if only the limits of the sketch changed (the tables must be built)
+
+ @return Returns true if the tables were saved with the layout and the limits of the sketch
+*/
+bool QURHexapod::SERVO_DRIVER::LoadCalibration(){
+  QURStoreReader reader;
+  if(!reader.Begin(QUR_STORE_ROBOT, QUR_STORE_TAG_ROBOT, CALIB_RECORD))
+    return false;
+  bool layout = reader.Read8() == CALIB_LAYOUT;
+  bool limits = true;
+  int8_t trim[__JOINTS__];
+  for(uint8_t x = 0; x < __JOINTS__; x++){            // Cicle with a iterator 'x' that go over each SERVO
+    limits &= (int16_t)reader.Read16() == MinAngle(x);
+    limits &= (int16_t)reader.Read16() == MaxAngle(x);
+    trim[x] = (int8_t)reader.Read8();
+    for(uint8_t point = 0; point < CALIB_POINTS; point++)
+      PulseTable[x][point] = reader.Read16();
+  }
+  if(!reader.End() || !layout)                        // Half written or of other robot
+    return false;
+  memcpy(Trim, trim, sizeof(Trim));
+  return limits;
+}
 
 /**
- @Struct QURHexapod -> SERVO_DRIVER -> Leg -> Joints
- @Function ConfigPinServo
- @purpuse Read a value int and sets the ID and PIN for the Servo
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function SaveCalibration
+ @purpuse Starts to save the PulseTables and the Trims in the EEPROM, TaskServos
+       writes them one byte at a time (a save in progress starts again)
+*/
+void QURHexapod::SERVO_DRIVER::SaveCalibration(){
+  Store.Begin(QUR_STORE_ROBOT, QUR_STORE_TAG_ROBOT, CALIB_RECORD, CalibrationByte, this);
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function CalibrationByte
+ @purpuse Byte of the record of the EEPROM: the layout, then every servo with
+       his limits, his Trim and his PulseTable (little endian)
 
- @param __SELECTOR__ Is the new ID value for the servo
+ @param __DRIVER__ Instance of SERVO_DRIVER
+ @param __INDEX__  Byte of the record (0 to CALIB_RECORD - 1)
+ @return Returns the byte
 */
-void QURHexapod::Joints::ConfigPinServo(int __SELECTOR__){
-  ID = __SELECTOR__;                          // ID is equal to the __SELECTOR__
-  Control.attach(PIN_AVAILABLES[AXIS][ID]);   // Sets the new pin for servo
-  DEBUGER(" ID: " + String(ID) + " / PIN: " + String(PIN_AVAILABLES[AXIS][ID]));  // DEBUG of the data
+uint8_t QURHexapod::SERVO_DRIVER::CalibrationByte(void *__DRIVER__, uint16_t __INDEX__){
+  SERVO_DRIVER *Driver = (SERVO_DRIVER *)__DRIVER__;
+  if(__INDEX__ == 0)
+    return CALIB_LAYOUT;
+  uint8_t joint = (__INDEX__ - 1) / CALIB_RECORD_JOINT;
+  uint8_t field = (__INDEX__ - 1) % CALIB_RECORD_JOINT;
+  if(field == 4)
+    return (uint8_t)Driver->Trim[joint];
+  uint16_t value;
+  if(field < 4)
+    value = (uint16_t)(field < 2 ? Driver->MinAngle(joint) : Driver->MaxAngle(joint));
+  else
+    value = Driver->PulseTable[joint][(field - 5) >> 1];
+  return ((field < 4 ? field : field - 5) & 1) ? (uint8_t)(value >> 8) : (uint8_t)value;
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function CommandPulse
+ @purpuse Converts a command into a pulse with the PulseTable, the commands
+       between two points are interpolated
+
+ @param __JOINT__   Servo (JOINT(leg, axis))
+ @param __COMMAND__ Command of the servo (0-100)
+ @return Returns the pulse in Q8 microseconds
+*/
+int32_t QURHexapod::SERVO_DRIVER::CommandPulse(uint8_t __JOINT__, int __COMMAND__){
+  __COMMAND__ = constrain(__COMMAND__, 0, 100);
+  const uint16_t *table = PulseTable[__JOINT__];
+  uint8_t point = __COMMAND__ >> CALIB_SHIFT;
+  int32_t pulse = table[point];
+  uint8_t fraction = __COMMAND__ & (CALIB_STEP - 1);
+  if(fraction)                                            // Between two points of the table
+    pulse += ((int32_t)(table[point + 1] - table[point]) * fraction) >> CALIB_SHIFT;
+  return pulse << 4;                                      // Q4 to Q8
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function PostSetpoint
+ @purpuse Converts the Setpoint (command) into a pulse and sends it to the motion engine
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+*/
+void QURHexapod::SERVO_DRIVER::PostSetpoint(uint8_t __JOINT__){
+  int32_t target = CommandPulse(__JOINT__, Setpoint[__JOINT__]);   // Pulse of the setpoint in Q8 microseconds
+  noInterrupts();                             // Target is 32 bits, the interrupt can't read it half written
+  if(target != Target[__JOINT__]){
+    Target[__JOINT__] = target;
+    Finished &= ~JOINT_BIT(__JOINT__);   // The interrupt sets it again when the servo arrives
+  }
+  interrupts();
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function Interpolate
+ @purpuse Moves the servo one interpolation with a trapezoidal profile: accelerates
+       until SpeedLimit and decelerates when the braking distance (v^2 / 2a)
+       reaches the distance to the Target. Writes the servo only if the pulse changed.
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+*/
+void QURHexapod::SERVO_DRIVER::Interpolate(uint8_t __JOINT__){
+  joint_mask_t bit = JOINT_BIT(__JOINT__);
+  int32_t velocity = Velocity[__JOINT__];
+  int32_t error = Target[__JOINT__] - Position[__JOINT__];   // Distance to the target (with direction)
+  if(error == 0 && velocity == 0){                        // The servo is in his place
+    Finished |= bit;
+    return;
+  }
+  Finished &= ~bit;
+  int32_t accel = AccelStep[__JOINT__];
+  if(velocity != 0 && ((error > 0) != (velocity > 0))){   // Moving away from the target (it changed): brake
+    if(velocity > 0) velocity = velocity > accel ? velocity - accel : 0;
+    else             velocity = -velocity > accel ? velocity + accel : 0;
+  }
+  else{
+    int32_t distance = error < 0 ? -error : error;
+    int32_t speed    = velocity < 0 ? -velocity : velocity;
+    int32_t limit    = SpeedLimit[__JOINT__];
+    if(speed * speed >= 2 * accel * distance)             // Braking distance reached: decelerate
+      speed = speed > 2 * accel ? speed - accel : accel;
+    else                                                  // Accelerate until the maximum speed
+      speed = speed + accel < limit ? speed + accel : limit;
+    if(speed > distance)                                  // Arrive exactly to the target
+      speed = distance;
+    velocity = error > 0 ? speed : -speed;
+  }
+  Velocity[__JOINT__] = velocity;
+  Position[__JOINT__] += velocity;
+  WritePulse(__JOINT__);
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function PlanMove
+ @purpuse Sets the Target of a coordinated move from the Setpoint. The motion
+       interrupt must be stopped (Planning) while is called
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+ @return Returns the interpolations needed to do the move at MaxSpeed
+*/
+int32_t QURHexapod::SERVO_DRIVER::PlanMove(uint8_t __JOINT__){
+  Target[__JOINT__]    = CommandPulse(__JOINT__, Setpoint[__JOINT__]);
+  Velocity[__JOINT__]  = 0;                   // The coordinated move starts from rest
+  MoveError[__JOINT__] = 0;
+  int32_t distance = Target[__JOINT__] - Position[__JOINT__];
+  if(distance < 0) distance = -distance;
+  return (distance + SpeedLimit[__JOINT__] - 1) / SpeedLimit[__JOINT__];
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function StepMove
+ @purpuse Moves the servo one interpolation of the coordinated move. The distance
+       is divided in __TICKS__ steps of MoveStep, the remainder is added one
+       unit at a time like the Bresenham line, so after __TICKS__ calls the
+       Position is exactly the Target
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+ @param __TICKS__ Interpolations of the coordinated move
+*/
+void QURHexapod::SERVO_DRIVER::StepMove(uint8_t __JOINT__, uint16_t __TICKS__){
+  Position[__JOINT__] += MoveStep[__JOINT__];
+  uint32_t error = (uint32_t)MoveError[__JOINT__] + MoveRest[__JOINT__];
+  if(error >= __TICKS__){
+    error -= __TICKS__;
+    Position[__JOINT__] += (MoveBackward >> __JOINT__) & 1 ? -1 : 1;
+  }
+  MoveError[__JOINT__] = (uint16_t)error;
+  WritePulse(__JOINT__);
+}
+
+/**
+ @Struct QURHexapod -> SERVO_DRIVER
+ @Function WritePulse
+ @purpuse Stages the Position of the servo in the Output only if the pulse in microseconds
+       changed, BackgroundProcess latches all of them together
+
+ @param __JOINT__ Servo (JOINT(leg, axis))
+*/
+void QURHexapod::SERVO_DRIVER::WritePulse(uint8_t __JOINT__){
+  uint16_t pulse = (uint16_t)((Position[__JOINT__] + 128) >> 8);   // Round Q8 to microseconds
+  if(pulse != Pulse[__JOINT__]){
+    Pulse[__JOINT__] = pulse;
+    Output->Set(__JOINT__, pulse);                        // Stage the pulse updated for the Latch
+  }
 }
 
 // ---------------------------------------------------------------------------
 // Methods for Robot control
 //       - ProcessFinished()
 //       - BackgroundProcess()
-//       - UpdateSetpoints(int AnglesX[__LEGS__], int AnglesY[__LEGS__])
+//       - UpdateSetpoints(int Angles[][__LEGS__])
+//       - StartMove()
 // ---------------------------------------------------------------------------
 
 /**
   @Struct QURHexapod -> SERVO_DRIVER
   @Function ProcessFinished
-  @purpuse Check if all servos finished
+  @purpuse Check if all servos finished, every servo has a bit in the mask Finished
 
   @return Returns true if all Servos are in their place or false if not.
 */
 bool QURHexapod::SERVO_DRIVER::ProcessFinished(){
-  for(int x = 0; x < __LEGS__; x++){          // Cicle with a iterator 'x' that go over each LEG
-    for(int y = 0; y < __SERVOS__; y++){    // Cicle with a iterator 'y' that go over each SERVO
-      if(!Legs[x].Joint[y].Is_Finished){  // If this servo<x, y> has not finished
-        return false;                   // Broke the Funtion and return false
-                        // (Because still one servo that has not finished)
-      }
-    }
-  }
-  return true;                                // If all Servos has finished return true
+  return Finished == JOINTS_MASK;
 }
 
 /**
   @Struct QURHexapod -> SERVO_DRIVER
   @Function BackgroundProcess
-  @purpuse Funtion that go over all servos and move them to their Setpoints
+  @purpuse Funtion that go over all servos and move them one interpolation to their
+       Setpoints. Is called MOTION_RATE times per second by the motion interrupt.
+       The pulses that changed are sent together at the end (Output->Latch).
+       If the next keyframe of the queue is planned it starts when the move
+       in progress ends, or half of the blend before if they are blended
 */
 void QURHexapod::SERVO_DRIVER::BackgroundProcess(){
-  for(int x = 0; x < __LEGS__; x++){          // Cicle with a iterator 'x' that go over each LEG
-    Legs[x].GoToSetpoint();                 // Call function from LEG->'GoToSetpoint' to move the leg
-    delay(TIMEOUT_LEG);                     // Wait the movement from the SERVO and the delay of speed
+  if(Planning)                                // The Routine is changing the move, skip this interpolation
+    return;
+  if(NextReady && !Blending){                 // The next keyframe of the queue is planned
+    uint16_t remaining = MoveTicks - MoveTick;
+    if(remaining == 0)                        // Nothing in progress: start it in this interpolation
+      StartNext(0);
+    else if(remaining == ((1U << NextBlend) >> 1)){   // Half of the blend before the corner
+      Blending = true;
+      BlendTick = 0;
+    }
+  }
+  if(Blending){                               // Corner between the move in progress and the next
+    QURUnroll<__JOINTS__>::Run([this](uint8_t x){ BlendStep(x); });
+    if(++BlendTick == (1U << NextBlend))      // The blend ends in the middle of the next move
+      StartNext(BlendTick >> 1);
+  }
+  else if(MoveTick < MoveTicks){              // Coordinated move in progress
+    MoveTick++;
+    uint16_t ticks = MoveTicks;
+    QURUnroll<__JOINTS__>::Run([this, ticks](uint8_t x){ StepMove(x, ticks); });
   }
+  else{
+    // Unrolled over each SERVO: move the servo one step of his profile
+    QURUnroll<__JOINTS__>::Run([this](uint8_t x){ Interpolate(x); });
+  }
+  Output->Latch();                            // All the servos of this interpolation in the same frame
 }
 
 /**
   @Struct QURHexapod -> SERVO_DRIVER
   @Function UpdateSetpoints
-  @purpuse Function that update the Setpoint of all servos.
+  @purpuse Function that update the Setpoint of the servos marked in Dirty, the
+       rest are not read. Only the commands that changed are converted to
+       pulses (with the table of every joint). The servos are unrolled, the
+       leg and the axis of every joint are constants
+
+  @param Angles Setpoints of the robot per axis and leg (QURHexapod::Angles)
+*/
+void QURHexapod::SERVO_DRIVER::UpdateSetpoints(int Angles[][__LEGS__]){
+  bool changed = false;                        // changed: Some setpoint is different (new keyframe)
+  joint_mask_t dirty = Dirty;
+  Dirty = 0;
+  QURUnroll<__JOINTS__>::Run([&](uint8_t joint){   // Unrolled over each SERVO, only the marked are read
+    if(!(dirty & JOINT_BIT(joint)))
+      return;
+    uint8_t leg = GEOMETRY::Leg(joint), axis = GEOMETRY::Axis(joint);
+    int command = constrain(Angles[axis][leg], 0, 100);
+    if(command == Setpoint[joint])             // Same command, nothing to convert
+      return;
+    Setpoint[joint] = (int8_t)command;         // The servo keeps the command (0-100), his table converts it
+    if(!changed)
+      ClearQueue();                            // A new setpoint cancels the keyframes of the queue
+    changed = true;
+    if(!Coordinated)
+      PostSetpoint(joint);                     // Send the setpoint to the motion engine
+    DEBUG_TRACE(MESSAGE_SETPOINT, "XYZ"[axis], leg, command);   // DEBUG of Data
+  });
+  if(Coordinated && changed){                  // A new keyframe: all the servos move together
+    StartMove();
+  }
+}
 
-  @param AnglesX Vector that contains the values for the Setpoints in AXIS X
-  @param AnglesY Vector that contains the values for the Setpoints in AXIS Y
+/**
+  @Struct QURHexapod -> SERVO_DRIVER
+  @Function StartMove
+  @purpuse Starts a coordinated move from the actual position to the Setpoints.
+       The duration is KeyframeTime or, if it is 0, the time of the servo that
+       needs more time at his MaxSpeed. The motion interrupt is paused with
+       the flag Planning instead of disabling the interrupts, so the pulses of
+       the servos are not delayed by the divisions.
 */
-void QURHexapod::SERVO_DRIVER::UpdateSetpoints(int AnglesX[__LEGS__], int AnglesY[__LEGS__]){
-  for(int ptr = 0; ptr < __LEGS__; ptr++){     // Cicle with a iterator 'ptr' that go over each LEG
-    // This funcions works converting the Setpoints from a Dimention Linear(0 - 100) into a Dimention of angles(LIMIT_MIN, LIMIT_MAX)
-    // After the convertion saves it into the Servo.
-    //      Definition map function:
-    //          - map -> Function that converts a value from a specific range into a other value in other range
-    //      Example:
-    //          - map(Value to converto, Initial range MIN, Initial range MAX, To range MIN, To range MAX);
-    Legs[ptr].Joint[ANGLE_X].Setpoint = map(AnglesX[ptr], 0, 100, Legs[ptr].Joint[ANGLE_X].MIN_Angle, Legs[ptr].Joint[ANGLE_X].MAX_Angle);
-    Legs[ptr].Joint[ANGLE_Y].Setpoint = map(AnglesY[ptr], 0, 100, Legs[ptr].Joint[ANGLE_X].MIN_Angle, Legs[ptr].Joint[ANGLE_X].MAX_Angle);
-    DEBUGER(" Setpoint X -> " + String(Legs[ptr].Joint[ANGLE_X].Setpoint));   // DEBUG of Data
-    DEBUGER(" Setpoint Y -> " + String(Legs[ptr].Joint[ANGLE_Y].Setpoint));   // DEBUG of Data
+void QURHexapod::SERVO_DRIVER::StartMove(){
+  Planning = true;                                    // The interrupt skips the interpolations until the end
+  QueueTail = QueueHead;                              // The keyframes of the queue are replaced by this move
+  NextReady = false;
+  Blending  = false;
+  int32_t ticks = (int32_t)KeyframeTime * MOTION_RATE / 1000;
+  int32_t slowest = 1;
+  for(uint8_t x = 0; x < __JOINTS__; x++){            // Cicle with a iterator 'x' that go over each SERVO
+    int32_t needed = PlanMove(x);
+    if(needed > slowest) slowest = needed;
+  }
+  if(ticks <= 0) ticks = slowest;
+  if(ticks > 65535) ticks = 65535;
+  MoveBackward = 0;
+  for(uint8_t x = 0; x < __JOINTS__; x++){
+    int32_t distance = Target[x] - Position[x];
+    int32_t rest = distance % ticks;                  // Remainder: distributed one unit at a time
+    MoveStep[x] = distance / ticks;                   // Quotient: Q8 microseconds every interpolation
+    if(rest < 0){
+      MoveBackward |= JOINT_BIT(x);
+      rest = -rest;
+    }
+    MoveRest[x] = (uint16_t)rest;
   }
+  Finished  = 0;
+  MoveTicks = (uint16_t)ticks;
+  MoveTick  = 0;
+  Planning  = false;                                  // Release the interrupt
 }
 
 // ---------------------------------------------------------------------------
-// Methods for Timers controller
-//       - BackgroundTime()
-//       - SetTimer(int __FINAL__)
+// Methods for the motion queue
+//       - QueueFrame(int __SETPOINTSX__[], int __SETPOINTSY__[], uint16_t __DURATION__)
+//       - PlanNext()
+//       - StartNext(uint16_t __TICK__)
+//       - BlendStep(uint8_t __JOINT__)
+//       - ClearQueue()
+//       - QueueBusy()
 // ---------------------------------------------------------------------------
 
 /**
-  @Struct QURHexapod -> TIMES
-  @Function BackgroundTime
-  @purpuse Checks if the timer ended
+  @Struct QURHexapod -> SERVO_DRIVER
+  @Function QueueFrame
+  @purpuse Adds a keyframe at the end of the Queue
 
-  @return Return a boolean value if the timer is not ended (true if is ended or false if not)
+  @param __SETPOINTSX__ Setpoints (0-100) of the legs in AXIS X
+  @param __SETPOINTSY__ Setpoints (0-100) of the legs in AXIS Y
+  @param __DURATION__   Milliseconds since the keyframe before (0 = the time of the slowest servo)
+  @return Returns false if the Queue is full
 */
-bool QURHexapod::TIMES::BackgroundTime(){
-  // If (<Current Time> less <Initial Time> is less than <Final time>) return true, else return false
-  return ((millis() - TimeInitial) < TimeFinal);
+bool QURHexapod::SERVO_DRIVER::QueueFrame(int __SETPOINTSX__[], int __SETPOINTSY__[], uint16_t __DURATION__){
+  if((uint8_t)(QueueHead - QueueTail) >= MOTION_QUEUE)
+    return false;
+  MOTION_FRAME &frame = Queue[QueueHead & (MOTION_QUEUE - 1)];
+  for(uint8_t x = 0; x < __LEGS__; x++){              // Cicle with a iterator 'x' that go over each LEG
+    frame.Setpoint[JOINT(x, ANGLE_X)] = (int8_t)constrain(__SETPOINTSX__[x], 0, 100);
+    frame.Setpoint[JOINT(x, ANGLE_Y)] = (int8_t)constrain(__SETPOINTSY__[x], 0, 100);
+#if __SERVOS__ > 2
+    int8_t z = Setpoint[JOINT(x, ANGLE_Z)];           // The Axis Z keeps his command
+    frame.Setpoint[JOINT(x, ANGLE_Z)] = z < 0 ? 50 : z;
+#endif
+  }
+  frame.Duration = __DURATION__;
+  QueueHead++;
+  return true;
 }
 
 /**
-  @Struct QURHexapod -> TIMES
-  @Function SetTimer
-  @purpuse Read a int argument that is the end time, and initialize the counter.
+  @Struct QURHexapod -> SERVO_DRIVER
+  @Function PlanNext
+  @purpuse Plans the oldest keyframe of the Queue as the next move while the
+       move in progress continues (lookahead): the move starts in the Target
+       of the move in progress, the divisions are done here and not in the
+       interrupt. The blend is the longest power of 2 whose half fits in what
+       is left of the move in progress (with one interpolation of margin, the
+       interrupt can advance it while this plans) and that fits in the next move
 
-  @param __FINAL__ Variable that indicates the term time
+  @return Returns true if a keyframe was planned
 */
-void QURHexapod::TIMES::SetTimer(int __FINAL__){
-  TimeInitial = millis();     // Sets the <Initial Time> to NOW
-  TimeFinal   = __FINAL__;    // Sets the Final Time to the argument __FINAL__
+bool QURHexapod::SERVO_DRIVER::PlanNext(){
+  if(NextReady || QueueHead == QueueTail)             // The next move is waiting the interrupt or nothing to plan
+    return false;
+  MOTION_FRAME &frame = Queue[QueueTail & (MOTION_QUEUE - 1)];
+  int32_t ticks = (int32_t)frame.Duration * MOTION_RATE / 1000;
+  int32_t slowest = 1;
+  for(uint8_t x = 0; x < __JOINTS__; x++){            // Cicle with a iterator 'x' that go over each SERVO
+    Setpoint[x]   = frame.Setpoint[x];
+    NextTarget[x] = CommandPulse(x, frame.Setpoint[x]);
+    int32_t distance = NextTarget[x] - Target[x];
+    if(distance < 0) distance = -distance;
+    int32_t needed = (distance + SpeedLimit[x] - 1) / SpeedLimit[x];
+    if(needed > slowest) slowest = needed;
+  }
+  if(ticks <= 0) ticks = slowest;
+  if(ticks > 65535) ticks = 65535;
+  for(uint8_t x = 0; x < __JOINTS__; x++)
+    NextStep[x] = (NextTarget[x] - Target[x]) / ticks;  // The remainder is distributed by StartNext
+  NextTicks = (uint16_t)ticks;
+  uint8_t shift = 0;
+  noInterrupts();
+  uint16_t remaining = MoveTicks - MoveTick;          // Interpolations left of the move in progress
+  interrupts();
+  if(remaining > 0){                                  // Blend only with a move in progress
+    while(shift < MOTION_BLEND_SHIFT && (1U << shift) < remaining && (2UL << shift) <= (uint32_t)ticks)
+      shift++;
+  }
+  NextBlend = shift;
+  QueueTail++;
+  noInterrupts();                                     // The Next vectors are written before the interrupt sees them
+  NextReady = true;
+  interrupts();
+  return true;
+}
+
+/**
+  @Struct QURHexapod -> SERVO_DRIVER
+  @Function StartNext
+  @purpuse Starts the next move from his interpolation __TICK__ (the end of
+       the blend). The steps planned are kept and the remainder is measured
+       from the actual Position, so the move always arrives exactly to his
+       Target (the blend and the remainders don't accumulate error). Only if
+       the move didn't start where it was planned a division is needed
+
+  @param __TICK__ Interpolations of the next move already done by the blend
+*/
+void QURHexapod::SERVO_DRIVER::StartNext(uint16_t __TICK__){
+  int32_t ticks = (int32_t)NextTicks - __TICK__;       // Interpolations left of the next move
+  joint_mask_t backward = 0;
+  for(uint8_t x = 0; x < __JOINTS__; x++){            // Cicle with a iterator 'x' that go over each SERVO
+    int32_t step = NextStep[x];
+    int32_t rest = NextTarget[x] - Position[x] - step * ticks;
+    if(rest >= ticks || rest <= -ticks){              // Not started where it was planned
+      step += rest / ticks;
+      rest %= ticks;
+    }
+    if(rest < 0){
+      backward |= JOINT_BIT(x);
+      rest = -rest;
+    }
+    Target[x]    = NextTarget[x];
+    Velocity[x]  = 0;
+    MoveStep[x]  = step;
+    MoveRest[x]  = (uint16_t)rest;
+    MoveError[x] = 0;
+  }
+  MoveBackward = backward;
+  Finished  = 0;
+  MoveTicks = (uint16_t)ticks;
+  MoveTick  = 0;
+  Blending  = false;
+  NextReady = false;                                  // The Routine can plan the next keyframe
+}
+
+/**
+  @Struct QURHexapod -> SERVO_DRIVER
+  @Function BlendStep
+  @purpuse Moves the servo one interpolation of the blend: the speed changes
+       linearly from the step of the move in progress to the step of the next
+       move, in the middle of every interpolation, so after the blend the
+       servo is in the line of the next move
+
+  @param __JOINT__ Servo (JOINT(leg, axis))
+*/
+void QURHexapod::SERVO_DRIVER::BlendStep(uint8_t __JOINT__){
+  int32_t from = MoveStep[__JOINT__];
+  Position[__JOINT__] += from + (((NextStep[__JOINT__] - from) * (int32_t)(2 * BlendTick + 1)) >> (NextBlend + 1));
+  WritePulse(__JOINT__);
+}
+
+/**
+  @Struct QURHexapod -> SERVO_DRIVER
+  @Function ClearQueue
+  @purpuse Discards the keyframes that didn't start. If the interrupt is in the
+       blend the servos go to the corner with their profile
+*/
+void QURHexapod::SERVO_DRIVER::ClearQueue(){
+  QueueTail = QueueHead;
+  noInterrupts();
+  if(Blending){
+    Blending = false;
+    MoveTick = MoveTicks;                             // Ends the coordinated move, the profile finishes it
+  }
+  NextReady = false;
+  interrupts();
+}
+
+/**
+  @Struct QURHexapod -> SERVO_DRIVER
+  @Function QueueBusy
+  @purpuse Check if the queue has keyframes that didn't start
+
+  @return Returns true if there are keyframes waiting, planned or blending
+*/
+bool QURHexapod::SERVO_DRIVER::QueueBusy(){
+  return QueueHead != QueueTail || NextReady || Blending;
 }
 
 // ---------------------------------------------------------------------------
 // RF DRIVER Methods
 //       - Start()
+//       - Drain()
 //       - ReadData()
+//       - Answer()
 // ---------------------------------------------------------------------------
 
 /**
@@ -206,51 +662,676 @@ void QURHexapod::RF_DRIVER::Start(){
   RFController.setPALevel(RF24_PA_MAX);           // Set the Level into Maximum
   RFController.setDataRate( RF24_250KBPS );       // Set the speed of reading
   RFController.openReadingPipe(1, addresses[0]);  // Set the Address of comunication
+  RFController.enableDynamicPayloads();           // The packets have the length of his type
+  RFController.enableAckPayload();                // The ACKs bring the Status back to the controller
   RFController.startListening();                  // Start into lisent data.
+  Answer();                                       // The first command already gets a Status
+#if RF_IRQ >= 0
+  if(digitalPinToInterrupt(RF_IRQ) != NOT_AN_INTERRUPT){
+    RFController.maskIRQ(true, true, false);      // The IRQ only for the packets received
+    pinMode(RF_IRQ, INPUT);
+    ByInterrupt = true;
+    attachInterrupt(digitalPinToInterrupt(RF_IRQ), RadioInterrupt, FALLING);
+  }
+#endif
+}
+
+/**
+  @Struct QURHexapod -> RF_DRIVER
+  @Function Drain
+  @purpuse Moves every packet of the RX FIFO of the radio into the Ring. Is the
+       producer of the Ring: called by the IRQ of the nRF24 (or by ReadData
+       without IRQ). If the Ring is full the packets are read and discarded,
+       the radio must be empty so the IRQ can fall again
+*/
+void QURHexapod::RF_DRIVER::Drain(){
+  bool sent, failed, received;
+  RFController.whatHappened(sent, failed, received);     // Clear the flags, the IRQ goes high
+  bool overrun = false;
+  for(int x = 0; x < RF_FIFO_DEPTH && RFController.available(); x++){   // While there is a packet in the FIFO
+    uint8_t length = RFController.getDynamicPayloadSize();
+    uint8_t *slot = Ring.Reserve();
+    if(slot == NULL || length == 0 || length > QUR_PACKET_MAX){         // Full ring or corrupted length
+      uint8_t discard[QUR_PACKET_MAX];
+      RFController.read(discard, length && length <= QUR_PACKET_MAX ? length : QUR_PACKET_MAX);
+      Ring.Dropped = Ring.Dropped + 1;
+      overrun |= slot == NULL;
+      continue;
+    }
+    RFController.read(slot, length);
+    Ring.Commit(length);
+  }
+  if(overrun)
+    Ring.Overruns = Ring.Overruns + 1;
 }
 
 /**
   @Struct QURHexapod -> RF_DRIVER
   @Function ReadData
-  @purpuse Read the data from the RFController
+  @purpuse Decodes the packets of the Ring in the order they arrived, so no
+       packet is overwritten before it is used. Never waits: without IRQ it
+       drains the radio first, with IRQ an empty Ring is two indexes compared.
+       Every packet is checked and decoded into Data (QURPacket.h)
 */
 void QURHexapod::RF_DRIVER::ReadData(){
-  if (RFController.available()){                                      // If the Antenna is ON
-    TIMES Timer;                                                    // Instance a Timer from the Struct TIMES
-    Timer.SetTimer(TIMEOUT_RF);                                     // Set the Timer into the Limit of TIMEOUT for the Antenna
-    while (RFController.available() && !Timer.BackgroundTime()){    // While the RF is available and the timer has not ended
-      RFController.read( &Data, sizeof(Data));                    // Read the data and save they in the Struct Data
+  if(!ByInterrupt)
+    Drain();
+  uint8_t length;
+  const uint8_t *packet;
+  while((packet = Ring.Front(length)) != NULL){                       // While there is a packet in the Ring
+    int8_t type = Reader.Decode(packet, length, Data);                // Check it and save it into Data
+    if(type == QUR_PACKET_FULL || type == QUR_PACKET_DELTA)
+      JointsReceived = true;
+    Ring.Pop();
+    Received++;                                                       // Count the packet
+#if MODULESD
+    Instance->SDdriver.LogPacket(type, Data, Reader, Received);
+#endif
+  }
+}
+
+/**
+  @Struct QURHexapod -> RF_DRIVER
+  @Function Answer
+  @purpuse Writes the Status in the TX FIFO of the radio, the nRF24 sends it
+       inside the ACK of the next packet received. Only one Status is loaded
+       per batch of packets, so the FIFO (3 payloads) never fills. The IRQ
+       also talks with the radio, the SPI is not shared with it
+*/
+void QURHexapod::RF_DRIVER::Answer(){
+  Status.Received = Received;
+  Status.Lost     = Reader.Lost;
+  Status.Errors   = Reader.Errors;
+  uint8_t packet[QUR_PACKET_MAX];
+  uint8_t length = StatusWriter.Status(Status, packet);
+  noInterrupts();
+  RFController.writeAckPayload(1, packet, length);
+  interrupts();
+  Answered = Received;
+  Status.Loop = 0;                                // A new window for the longest loop
+}
+
+#if PCLINK
+// ---------------------------------------------------------------------------
+// Methods for PCDRIVER (link with the PC)
+//       - Start()
+//       - Answer(QURHexapod *__ROBOT__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURHexapod -> PCDRIVER
+  @Function Start
+  @purpuse Opens the PCSerial for the frames of the PC
+*/
+void QURHexapod::PCDRIVER::Start(){
+  PCSerial.begin(BAUDRATE);
+}
+
+/**
+  @Struct QURHexapod -> PCDRIVER
+  @Function Answer
+  @purpuse Sends the State of the robot to the PC: the last frame received, the
+       counters of the link and the commands of the servos. Only if the TX
+       buffer has space for the whole frame, so it never blocks the Routine
+
+  @param __ROBOT__ Robot that answers
+*/
+void QURHexapod::PCDRIVER::Answer(QURHexapod *__ROBOT__){
+  if(PCSerial.availableForWrite() < QUR_PC_WIRE_MAX)    // Try again in the next period
+    return;
+  QURPCState state;
+  state.Ack      = Parser.Sequence;
+  state.Received = Received;
+  state.Lost     = Parser.Lost;
+  state.Errors   = Parser.Errors;
+  state.Refused  = Refused;
+  state.Flags    = (__ROBOT__->All_Finished ? QUR_STATUS_FINISHED : 0) |
+                   (__ROBOT__->Generator.Enabled || __ROBOT__->GaitPlayer.Playing ? QUR_STATUS_WALKING : 0) |
+                   (__ROBOT__->ServoDriver.QueueBusy() ? QUR_STATUS_QUEUE : 0) |
+                   (__ROBOT__->ServoDriver.ManualMode ? QUR_PC_FLAG_MANUAL : 0);
+  state.Space    = __ROBOT__->QueueSpace();
+  for(uint8_t leg = 0; leg < LINK_LEGS; leg++){   // Cicle with a iterator 'leg' that go over each LEG (order of the frame)
+    state.Setpoints[leg]                  = (int8_t)__ROBOT__->Angles[ANGLE_X][leg];
+    state.Setpoints[QUR_JOINTS / 2 + leg] = (int8_t)__ROBOT__->Angles[ANGLE_Y][leg];
+  }
+  uint8_t frame[QUR_PC_WIRE_MAX];
+  PCSerial.write(frame, Writer.State(state, frame));
+  Answered = Received;
+  Space    = state.Space;
+  Periods  = 0;
+}
+#endif
+
+#if MODULESD
+// ---------------------------------------------------------------------------
+// Methods for ModuleSD (flight recorder)
+//       - Start()
+//       - LogPacket(int8_t __TYPE__, const QURCommand &__DATA__, const QURPacketReader &__READER__, uint16_t __RECEIVED__)
+//       - LogSetpoints(const int8_t __SETPOINTS__[])
+//       - LogJoints(const uint16_t __PULSES__[])
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURHexapod -> ModuleSD
+  @Function Start
+  @purpuse Opens the port of the ModuleSD, the first setpoints and pulses are
+       always recorded
+*/
+void QURHexapod::ModuleSD::Start(){
+  SDcontrol.begin(SD_BAUDRATE);
+  memset(Setpoint, -1, sizeof(Setpoint));         // Like the servos before the first update
+  memset(Pulse, 0, sizeof(Pulse));
+}
+
+/**
+  @Struct QURHexapod -> ModuleSD
+  @Function LogPacket
+  @purpuse Records a packet of the RF-Controller with the command after it and
+       the counters of the reader
+
+  @param __TYPE__     Result of Decode (type of packet or error)
+  @param __DATA__     Command after the packet
+  @param __READER__   Reader of the packets (Lost and Errors)
+  @param __RECEIVED__ Packets received
+*/
+void QURHexapod::ModuleSD::LogPacket(int8_t __TYPE__, const QURCommand &__DATA__, const QURPacketReader &__READER__, uint16_t __RECEIVED__){
+  QURLogRecord record(QUR_LOG_PACKET, (uint8_t)__TYPE__, micros());
+  record.Add8((__DATA__.Mode ? QUR_FLAG_MODE : 0) | (__DATA__.Buttons << 1));   // Like the flags of the packet
+  record.Add16((uint16_t)__DATA__.Angle);
+  record.Add8(__DATA__.Magnitude);
+  record.Add16(__RECEIVED__);
+  record.Add16(__READER__.Lost);
+  record.Add16(__READER__.Errors);
+  Recorder.Log(record);
+}
+
+/**
+  @Struct QURHexapod -> ModuleSD
+  @Function LogSetpoints
+  @purpuse Records the setpoints (0-100) of every axis that has a change since
+       his last record, a record per axis
+
+  @param __SETPOINTS__ Setpoints of the servos (SERVO_DRIVER::Setpoint)
+*/
+void QURHexapod::ModuleSD::LogSetpoints(const int8_t __SETPOINTS__[]){
+  uint32_t now = micros();
+  for(uint8_t axis = 0; axis < __SERVOS__; axis++){       // Cicle with a iterator 'axis' that go over each AXIS
+    bool changed = false;
+    for(uint8_t leg = 0; leg < __LEGS__; leg++)
+      changed |= __SETPOINTS__[JOINT(leg, axis)] != Setpoint[JOINT(leg, axis)];
+    if(!changed)
+      continue;
+    QURLogRecord record(QUR_LOG_SETPOINTS, axis, now);
+    for(uint8_t leg = 0; leg < __LEGS__; leg++){
+      record.Add8((uint8_t)__SETPOINTS__[JOINT(leg, axis)]);
+      Setpoint[JOINT(leg, axis)] = __SETPOINTS__[JOINT(leg, axis)];
+    }
+    Recorder.Log(record);
+  }
+}
+
+/**
+  @Struct QURHexapod -> ModuleSD
+  @Function LogJoints
+  @purpuse Records the pulses of the joints that changed since his last record,
+       every record has up to 5 consecutive joints
+
+  @param __PULSES__ Pulse in microseconds of every joint
+*/
+void QURHexapod::ModuleSD::LogJoints(const uint16_t __PULSES__[]){
+  uint32_t now = micros();
+  for(uint8_t first = 0; first < __JOINTS__; first += QUR_LOG_PAYLOAD / 2){
+    uint8_t last = first + QUR_LOG_PAYLOAD / 2 < __JOINTS__ ? first + QUR_LOG_PAYLOAD / 2 : __JOINTS__;
+    if(memcmp(__PULSES__ + first, Pulse + first, (last - first) * sizeof(uint16_t)) == 0)
+      continue;
+    QURLogRecord record(QUR_LOG_JOINTS, first, now);
+    for(uint8_t joint = first; joint < last; joint++){    // Cicle with a iterator 'joint' that go over each SERVO of the record
+      record.Add16(__PULSES__[joint]);
+      Pulse[joint] = __PULSES__[joint];
     }
+    Recorder.Log(record);
   }
 }
+#endif
 
 // ---------------------------------------------------------------------------
 // Hexapaod Methods
+//       - Start()
+//       - SetOutput(QURServoOutput *__OUTPUT__)
 //       - Routine()
 //       - SelectMode(bool __MODE__)
 //       - SetAnglesLeg(int __SETPOINTS__[], bool __SERVO__)
 //       - SetAngleServo(int __SETPOINT__, int __LEG__, bool __SERVO__)
+//       - SetAngleAxis(int __SETPOINT__, int __LEG__, uint8_t __AXIS__)
 //       - ServosFinished()
 // ---------------------------------------------------------------------------
 
+/**
+  @Struct QURHexapod
+  @Function Start
+  @purpuse Reads (FAST_BOOT) or builds the tables of the servos, attach every
+       servo to his pin and initialize the RF-Controller. This can't be done
+       in the constructor because the hardware is not ready until setup().
+       Nothing waits for a device, the Routine starts right after
+*/
+void QURHexapod::Start(){
+#if DEBUG_LEVEL > DEBUG_LEVEL_NONE
+  PCSerial.begin(BAUDRATE);
+  QURDebug.Begin(PCSerial);
+  QURDebug.Wait = true;                           // Nothing runs yet, the messages of the setup wait the port
+#endif
+  // The tables of the servos, from the EEPROM if they were saved with these limits (FAST_BOOT)
+  bool cached = FAST_BOOT && ServoDriver.LoadCalibration();
+  if(!cached){
+    for(uint8_t x = 0; x < __JOINTS__; x++)       // Build the table of pulses with the limits
+      ServoDriver.Calibrate(x);
+#if FAST_BOOT
+    ServoDriver.SaveCalibration();                // TaskServos saves them for the next boot
+#endif
+  }
+  DEBUG_INFO(MESSAGE_CALIBRATION, cached);
+  if(!ServoDriver.Output->Begin()){               // The output selected can't run in this board
+    DEBUG_WARNING(MESSAGE_OUTPUT_SERVO);
+    ServoDriver.Output = &DefaultOutput;
+  }
+  for(uint8_t x = 0; x < __JOINTS__; x++){       // Cicle with a iterator 'x' that go over each SERVO
+    ServoDriver.ConfigPinServo(x);
+  }
+  Instance = this;                                // The RF interrupt can fire as soon as the antenna starts
+  RFdriver.Start();                               // Initialize the antenna
+#if MODULESD
+  SDdriver.Start();                               // Open the port of the flight recorder
+#endif
+#if PCLINK
+  PCdriver.Start();                               // Open the port of the PC
+#endif
+  // Start the motion interrupt, without timer TaskServos interpolates
+  MotionByInterrupt = MotionTimerStart(MOTION_RATE, MotionInterrupt);
+  // Add the tasks in the order of the TASK_ IDs, the phases spread them so they don't run in the same pass
+  Scheduler.AddTask(TaskReadRF,    this, RATE_RF);
+  Scheduler.AddTask(TaskSetpoints, this, RATE_SETPOINTS, 1000);
+  Scheduler.AddTask(TaskServos,    this, RATE_SERVOS,    2000);
+  Scheduler.AddTask(TaskTelemetry, this, RATE_TELEMETRY, 3000);
+  Scheduler.AddTask(TaskGait,      this, RATE_GAIT,      4000);
+  Scheduler.Enable(TASK_TELEMETRY, TELEMETRY);
+  Scheduler.AddTask(TaskProfile,   this, RATE_PROFILE,   4500);
+  Scheduler.Enable(TASK_PROFILE, PROFILER);
+  Scheduler.AddTask(TaskRecorder,  this, RATE_RECORDER,  500);
+  Scheduler.Enable(TASK_RECORDER, MODULESD);
+  Scheduler.AddTask(TaskPCLink,    this, RATE_PCLINK,    250);
+  Scheduler.Enable(TASK_PCLINK, PCLINK);
+  DEBUG_INFO(MESSAGE_STARTED, MotionByInterrupt, RFdriver.ByInterrupt, TASK_PCLINK + 1);
+#if DEBUG_LEVEL > DEBUG_LEVEL_NONE
+  QURDebug.Wait = false;                          // The Routine never waits a message
+#endif
+}
+
 /**
   @Struct QURHexapod
   @Function Routine
   @purpuse Function Main and manage synchronize the RF to ROBOT, Additionally 
-       control the servos and their SetPoints
+       control the servos and their SetPoints. Runs the tasks that are due and
+       returns, call it as fast as possible from loop()
 */
 void QURHexapod::Routine(){
-  if(!ServoDriver.ManualMode){                    // If Robot is not in MANUAL
-    Timer.SetTimer(TIMEOUT_RF);                 // Initialize the Time rAfor read data from RF
-    while(!Timer.BackgroundTime()){             // While the timer is not ended
-      RFdriver.ReadData();                    // Read data from the RFController
-    }   
+#if PROFILER
+  uint16_t now = (uint16_t)PROFILE_CLOCK();
+  if(LastRoutine)
+    Profile[PROFILE_LOOP].Add(now - LastRoutine);
+  LastRoutine = now;
+#endif
+  Scheduler.Run();                                // Run the tasks (RF, Setpoints, Servos, Telemetry)
+}
+
+// ---------------------------------------------------------------------------
+// Tasks of the Routine
+//       - TaskReadRF(void *__ROBOT__)
+//       - TaskSetpoints(void *__ROBOT__)
+//       - TaskServos(void *__ROBOT__)
+//       - TaskTelemetry(void *__ROBOT__)
+//       - TaskGait(void *__ROBOT__)
+//       - TaskProfile(void *__ROBOT__)
+//       - TaskRecorder(void *__ROBOT__)
+//       - TaskPCLink(void *__ROBOT__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURHexapod
+  @Function TaskReadRF
+  @purpuse Read data from the RFController (only in mode AUTOMATIC)
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskReadRF(void *__ROBOT__){
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  RF_DRIVER &RF = Robot->RFdriver;
+  uint32_t now = micros();                        // The gap between two calls is the longest pass of the loop
+  if(RF.LastRead && now - RF.LastRead > RF.Status.Loop)
+    RF.Status.Loop = now - RF.LastRead > 0xFFFF ? 0xFFFF : (uint16_t)(now - RF.LastRead);
+  RF.LastRead = now;
+  if(!Robot->ServoDriver.ManualMode){             // If Robot is not in MANUAL
+    PROFILE_START(start);
+    Robot->RFdriver.ReadData();                 // Read data from the RFController
+    PROFILE_STOP(PROFILE_RF, start);
+    if(RF.Received != RF.Answered){             // The last Status was sent, load the next one
+      uint8_t missed = 0;
+      for(int8_t x = 0; x < TASK_PCLINK + 1; x++)
+        missed += (uint8_t)Robot->Scheduler.Task(x).Missed;
+      RF.Status.Missed = missed;
+      RF.Status.Flags  = (Robot->All_Finished ? QUR_STATUS_FINISHED : 0) |
+                         (Robot->Generator.Enabled || Robot->GaitPlayer.Playing ? QUR_STATUS_WALKING : 0) |
+                         (Robot->ServoDriver.QueueBusy() ? QUR_STATUS_QUEUE : 0);
+      RF.Answer();
+    }
+    if(Robot->RFdriver.JointsReceived && !Robot->Generator.Enabled && !Robot->GaitPlayer.Playing && !Robot->ServoDriver.QueueBusy()){
+      for(int x = 0; x < LINK_LEGS; x++){       // The joints of the controller are the setpoints (only the changed are marked)
+        Robot->SetAngleServo(Robot->RFdriver.Data.Joints[x], x, SERVO_X);
+        Robot->SetAngleServo(Robot->RFdriver.Data.Joints[QUR_JOINTS / 2 + x], x, SERVO_Y);
+      }
+    }
+    Robot->RFdriver.JointsReceived = false;
+  }
+}
+
+/**
+  @Struct QURHexapod
+  @Function TaskSetpoints
+  @purpuse Update the setpoints of the servos and the state of the process. If
+       the gait generator is walking it advances one tick first, steered by
+       the RF-Controller in mode AUTOMATIC. Without setpoints marked (Dirty)
+       nothing is converted
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskSetpoints(void *__ROBOT__){
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  if(Robot->Generator.Enabled){
+    if(!Robot->ServoDriver.ManualMode){                               // The joystick steers the walk
+      QURCommand &Data = Robot->RFdriver.Data;
+      if(Data.Mode == WALKING)
+        Robot->Generator.SetHeading(Data.Angle);
+      else                                                          // Joystick to the right rotates clockwise
+        Robot->Generator.SetTurn(Data.Angle > -90 && Data.Angle < 90 ? -1 : 1);
+    }
+    int setpointsX[GEN_LEGS], setpointsY[GEN_LEGS];
+    Robot->Generator.Step(setpointsX, setpointsY);
+    for(int x = 0; x < LINK_LEGS; x++){                             // The generator moves every leg (only the changed are marked)
+      Robot->SetAngleServo(setpointsX[x], x, SERVO_X);
+      Robot->SetAngleServo(setpointsY[x], x, SERVO_Y);
+    }
   }
-  ServoDriver.UpdateSetpoints(AnglesX, AnglesY);  // Call the function 'UpdateSetpoints' and update the setpoints
-  All_Finished = ServoDriver.ProcessFinished();   // Updates the state of the servos to check if they has finished
-  if(!All_Finished){                              // If the servos has not finished
-    ServoDriver.BackgroundProcess();            // Do the funtion 'BackgroundProcess' to move the servos
+  if(Robot->ServoDriver.Dirty){
+    PROFILE_START(start);
+    Robot->ServoDriver.UpdateSetpoints(Robot->Angles);  // Call the function 'UpdateSetpoints' and update the setpoints
+    PROFILE_STOP(PROFILE_SETPOINTS, start);
+#if MODULESD
+    Robot->SDdriver.LogSetpoints(Robot->ServoDriver.Setpoint);
+#endif
   }
+  PROFILE_START(check);
+  Robot->All_Finished = Robot->ServoDriver.ProcessFinished();         // Updates the state of the servos to check if they has finished
+  PROFILE_STOP(PROFILE_FINISHED, check);
+}
+
+/**
+  @Struct QURHexapod
+  @Function TaskServos
+  @purpuse Plans the next keyframe of the motion queue while the move in progress
+       continues and updates the state of the servos, if there is no motion
+       timer in this board it also moves the servos one interpolation (at the
+       same MOTION_RATE)
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskServos(void *__ROBOT__){
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  if(Robot->ServoDriver.PlanNext()){                                  // The commands of the robot follow the queue
+    for(uint8_t x = 0; x < __JOINTS__; x++)
+      Robot->Angles[GEOMETRY::Axis(x)][GEOMETRY::Leg(x)] = Robot->ServoDriver.Setpoint[x];
+  }
+  if(!Robot->MotionByInterrupt){                                      // Without motion timer
+    PROFILE_START(start);
+    Robot->ServoDriver.BackgroundProcess();                         // Do the funtion 'BackgroundProcess' to move the servos
+    PROFILE_STOP(PROFILE_MOTION, start);
+  }
+  PROFILE_START(check);
+  Robot->All_Finished = Robot->ServoDriver.ProcessFinished();         // Updates the state of the servos
+  PROFILE_STOP(PROFILE_FINISHED, check);
+#if MODULESD
+  uint16_t pulses[__JOINTS__];
+  noInterrupts();                                                     // The motion interrupt writes the pulses
+  memcpy(pulses, Robot->ServoDriver.Pulse, sizeof(pulses));
+  interrupts();
+  Robot->SDdriver.LogJoints(pulses);
+#endif
+#if FAST_BOOT
+  Robot->ServoDriver.Store.Step();                                    // One byte of the calibration to the EEPROM (if it changed)
+#endif
+}
+
+/**
+  @Struct QURHexapod
+  @Function TaskGait
+  @purpuse Reads the next frames of the gait from the flash and adds them to
+       the motion queue while it has space, so the next frame is always
+       planned before the frame in progress ends
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskGait(void *__ROBOT__){
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  GAIT_PLAYER &Player = Robot->GaitPlayer;
+  while(Player.Playing && Robot->QueueSpace()){          // Nothing to play or the queue is full
+    uint16_t duration;
+    if(!Player.Reader.Next(duration)){                   // End of the cycle
+      if(!Player.Reader.Loop() || (Player.Cycles && --Player.Cycles == 0)){
+        Player.Playing = false;
+        return;
+      }
+      Player.Reader.Rewind();
+      Player.Reader.Next(duration);
+    }
+    int setpointsX[__LEGS__], setpointsY[__LEGS__];
+    memcpy(setpointsX, Robot->Angles[ANGLE_X], sizeof(setpointsX));   // The legs out of the gait keep their setpoints
+    memcpy(setpointsY, Robot->Angles[ANGLE_Y], sizeof(setpointsY));
+    for(int x = 0; x < LINK_LEGS; x++){                  // Cicle with a iterator 'x' that go over each LEG
+      setpointsX[x] = Player.Reader.Setpoints[x];
+      setpointsY[x] = Player.Reader.Setpoints[GAIT_JOINTS / 2 + x];
+    }
+    Robot->QueueKeyframe(setpointsX, setpointsY, duration);
+  }
+}
+
+/**
+  @Struct QURHexapod
+  @Function TaskProfile
+  @purpuse Sends the histogram of one stage to the PC in a binary frame and
+       starts a new window for it, the stages are sent in turns. If the serial
+       buffer has no space for the buckets only the summary is sent
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskProfile(void *__ROBOT__){
+#if PROFILER
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  int space = PCSerial.availableForWrite();
+  if(space < QUR_PROFILE_SUMMARY)                 // Try again in the next period, the window keeps growing
+    return;
+  uint8_t stage = Robot->ProfileStage;
+  QURHistogram window;
+  noInterrupts();                                 // The interrupts (motion and RF) add samples too
+  window = Robot->Profile[stage];
+  Robot->Profile[stage].Reset();
+  interrupts();
+  uint8_t frame[QUR_PROFILE_FRAME_MAX];
+  uint8_t length = QURProfileFrame(window, stage, Robot->ProfileSequence++, frame,
+                                   space < QUR_PROFILE_FRAME_MAX ? space : QUR_PROFILE_FRAME_MAX);
+  PCSerial.write(frame, length);
+  Robot->ProfileStage = (stage + 1) % PROFILE_STAGES;
+#else
+  (void)__ROBOT__;
+#endif
+}
+
+/**
+  @Struct QURHexapod
+  @Function TaskRecorder
+  @purpuse Records the timings of the loop every LOG_TIMING periods and sends
+       to the ModuleSD the blocks of the log that are full, only the bytes
+       that fit in the TX buffer (never waits)
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskRecorder(void *__ROBOT__){
+#if MODULESD
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  ModuleSD &SD = Robot->SDdriver;
+  uint32_t now = micros();                        // The gap between two calls is the longest pass of the loop
+  if(SD.LastFlush && now - SD.LastFlush > SD.Gap)
+    SD.Gap = now - SD.LastFlush > 0xFFFF ? 0xFFFF : (uint16_t)(now - SD.LastFlush);
+  SD.LastFlush = now;
+  if(++SD.Periods >= LOG_TIMING){
+    uint16_t missed = 0;
+    for(int8_t x = 0; x < TASK_PCLINK + 1; x++)
+      missed += Robot->Scheduler.Task(x).Missed;
+    QURLogRecord record(QUR_LOG_TIMING, 0, now);
+    record.Add16(SD.Gap);
+    record.Add16(missed);
+    record.Add16(Robot->RFdriver.Ring.Overruns);
+    record.Add16(SD.Recorder.Lost);
+    record.Add16((uint16_t)SD.Recorder.Sequence);
+    SD.Recorder.Log(record);
+    SD.Periods = 0;
+    SD.Gap = 0;
+  }
+  SD.Recorder.Flush(SDcontrol);
+#else
+  (void)__ROBOT__;
+#endif
+}
+
+/**
+  @Struct QURHexapod
+  @Function TaskPCLink
+  @purpuse Feeds the bytes already received from the PC to the Parser (never
+       waits the rest of a frame) and applies every frame complete: MODE
+       selects the mode, SETPOINTS moves the servos only in mode MANUAL and
+       without a gait, direct (Duration 0) or as a keyframe of the motion
+       queue. After the batch the State goes back to the PC, and when the
+       queue has other space or every PCLINK_STATE periods without frames
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskPCLink(void *__ROBOT__){
+#if PCLINK
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  PCDRIVER &PC = Robot->PCdriver;
+  int available = PCSerial.available();           // Only the bytes in the RX buffer now
+  while(available-- > 0){
+    uint8_t type = PC.Parser.Feed((uint8_t)PCSerial.read());
+    if(type == 0 || type == QUR_PC_STATE)         // Frame in progress (or a frame of the robot)
+      continue;
+    PC.Received++;
+    if(type == QUR_PC_MODE){
+      Robot->SelectMode(PC.Parser.Mode());
+      continue;
+    }
+    uint8_t joints[QUR_JOINTS];
+    uint16_t duration;
+    PC.Parser.Setpoints(joints, duration);
+    if(!Robot->ServoDriver.ManualMode || Robot->Generator.Enabled || Robot->GaitPlayer.Playing){
+      PC.Refused++;
+      continue;
+    }
+    int setpointsX[__LEGS__], setpointsY[__LEGS__];
+    memcpy(setpointsX, Robot->Angles[ANGLE_X], sizeof(setpointsX));   // The legs out of the link keep their setpoints
+    memcpy(setpointsY, Robot->Angles[ANGLE_Y], sizeof(setpointsY));
+    for(int x = 0; x < LINK_LEGS; x++){           // Cicle with a iterator 'x' that go over each LEG
+      setpointsX[x] = joints[x];
+      setpointsY[x] = joints[QUR_JOINTS / 2 + x];
+    }
+    if(duration == 0){                            // Direct: only the servos that changed are marked
+      Robot->SetAnglesLeg(setpointsX, SERVO_X);
+      Robot->SetAnglesLeg(setpointsY, SERVO_Y);
+    }
+    else if(!Robot->QueueKeyframe(setpointsX, setpointsY, duration))
+      PC.Refused++;                               // The PC must wait the Space of the State
+  }
+  if(PC.Received != PC.Answered || PC.Space != Robot->QueueSpace() || ++PC.Periods >= PCLINK_STATE)
+    PC.Answer(Robot);
+#else
+  (void)__ROBOT__;
+#endif
+}
+
+/**
+  @Struct QURHexapod
+  @Function MotionInterrupt
+  @purpuse Callback of the motion timer, moves the servos one interpolation
+*/
+void QURHexapod::MotionInterrupt(){
+  if(Instance){
+    PROFILE_START(start);
+    Instance->ServoDriver.BackgroundProcess();
+    PROFILE_STOP(PROFILE_MOTION, start);
+  }
+}
+
+/**
+  @Struct QURHexapod
+  @Function RadioInterrupt
+  @purpuse Callback of the IRQ of the nRF24, moves the packets into the Ring.
+       The SPI of the drain takes 100-200 us in the AVR, like the motion
+       interrupt it masks only his own INTx and enables the interrupts again,
+       so the pulses of the Servo library keep their precision. The SPI of
+       the Routine (Answer) is done with the interrupts disabled
+*/
+void QURHexapod::RadioInterrupt(){
+  if(Instance){
+#if defined(RF_IRQ_MASK)
+    EIMSK &= ~RF_IRQ_MASK;
+    sei();
+#endif
+    PROFILE_START(start);
+    Instance->RFdriver.Drain();
+    PROFILE_STOP(PROFILE_RF_IRQ, start);
+#if defined(RF_IRQ_MASK)
+    cli();
+    EIMSK |= RF_IRQ_MASK;                         // A packet that arrived meanwhile left his flag, it runs again
+#endif
+  }
+}
+
+/**
+  @Struct QURHexapod
+  @Function TaskTelemetry
+  @purpuse Send a line with the state of the robot to the PC, if the serial
+       buffer has no space the line is skipped to never block the Routine
+
+  @param __ROBOT__ Instance of QURHexapod
+*/
+void QURHexapod::TaskTelemetry(void *__ROBOT__){
+  QURHexapod *Robot = (QURHexapod *)__ROBOT__;
+  if(PCSerial.availableForWrite() < 52)           // Longest line: "RF:65535 FIN:1 MISS:65535 65535 OVR:65535 65535\r\n"
+    return;
+  PCSerial.print("RF:");    PCSerial.print((unsigned int)Robot->RFdriver.Received);
+  PCSerial.print(" FIN:");  PCSerial.print((int)Robot->All_Finished);
+  PCSerial.print(" MISS:"); PCSerial.print((unsigned int)Robot->Scheduler.Task(TASK_RF).Missed);
+  PCSerial.print(' ');      PCSerial.print((unsigned int)Robot->Scheduler.Task(TASK_SERVOS).Missed);
+  PCSerial.print(" OVR:");  PCSerial.print((unsigned int)Robot->RFdriver.Ring.Overruns);
+  PCSerial.print(' ');      PCSerial.println((unsigned int)Robot->RFdriver.Ring.Dropped);
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetOutput
+  @purpuse Selects the output of the pulses of the servos (QURServoOutput.h),
+       it must be called before Start() that attaches the servos to it
+
+  @param __OUTPUT__ Output of the servos (NULL = Servo library)
+*/
+void QURHexapod::SetOutput(QURServoOutput *__OUTPUT__){
+  ServoDriver.Output = __OUTPUT__ ? __OUTPUT__ : &DefaultOutput;
 }
 
 /**
@@ -273,49 +1354,325 @@ void QURHexapod::SelectMode(bool __MODE__){
   @param __SERVO__      Boolean selector for selection the AXIS (true = AXIS X, false = AXIS Y)
 */
 void QURHexapod::SetAnglesLeg(int __SETPOINTS__[], bool __SERVO__){
-  for(int x = 0; x < 6; x++){             // Cicle with iterator 'x' for go over each leg
-    if(__SERVO__)                       // If boolean selector is true, AXIS X enables
-      AnglesX[x] = __SETPOINTS__[x];  // Save the new SETPOINT int AXIS X
-    else                                // Else is false so AXIS Y enables
-      AnglesY[x] = __SETPOINTS__[x];  // Save the new SETPOINT in AXIS Y
+  for(int x = 0; x < __LEGS__; x++){      // Cicle with iterator 'x' for go over each leg
+    SetAngleServo(__SETPOINTS__[x], x, __SERVO__);
   }
 }
 
 /**
   @Struct QURHexapod
   @Function SetAngleServo
-  @purpuse Allows change the current setpoint for a specific servo
+  @purpuse Allows change the current setpoint for a specific servo, if it is
+       different the servo is marked in Dirty for the next TaskSetpoints
 
   @param __SETPOINT__  Int that contains the new Setpoint for the servo
   @param __LEG__       Int selector to select the LEG (from 0 to <MAX_LEGS>)
   @param __SERVO__     Boolean selector to select the AXIS (true = AXIS X, false = AXIS Y)
 */
 void QURHexapod::SetAngleServo(int __SETPOINT__, int __LEG__, bool __SERVO__){
-  if(__SERVO__)                           // If boolean selector is true, AXIS X enables
-    AnglesX[__LEG__] = __SETPOINT__;    // Save the new SETPOINT int AXIS X
-  else                                    // Else is false so AXIS Y enables
-    AnglesY[__LEG__] = __SETPOINT__;    // Save the new SETPOINT in AXIS Y
+  SetAngleAxis(__SETPOINT__, __LEG__, __SERVO__ ? ANGLE_X : ANGLE_Y);   // If boolean selector is true, AXIS X enables
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetAngleAxis
+  @purpuse Like SetAngleServo with the number of the axis, the legs of 3
+       servos move the Axis Z with it
+
+  @param __SETPOINT__  Int that contains the new Setpoint for the servo
+  @param __LEG__       Int selector to select the LEG (from 0 to <MAX_LEGS>)
+  @param __AXIS__      Axis of the servo (ANGLE_X, ANGLE_Y or ANGLE_Z)
+*/
+void QURHexapod::SetAngleAxis(int __SETPOINT__, int __LEG__, uint8_t __AXIS__){
+  int &angle = Angles[__AXIS__][__LEG__];
+  if(angle == __SETPOINT__)
+    return;
+  angle = __SETPOINT__;                   // Save the new SETPOINT
+  ServoDriver.Dirty |= JOINT_BIT(JOINT(__LEG__, __AXIS__));
 }
 
 /**
   @Struct QURHexapod
   @Function ServosFinished
-  @purpuse Check if all servos finished
+  @purpuse Check if all servos finished, with the masks of the servos (no
+       setpoint waiting in Dirty, no keyframe in the motion queue and every
+       bit of Finished set)
 
   @return Returns true if all Servos are in their place or false if not.
 */
 bool QURHexapod::ServosFinished(){
-  return All_Finished;    // Return the state of the FLAG 'All_Finished'
+  return !ServoDriver.Dirty && !ServoDriver.QueueBusy() && ServoDriver.ProcessFinished();
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetProfile
+  @purpuse Sets the motion profile of all servos
+
+  @param __SPEED__ Maximum speed in degrees per second
+  @param __ACCEL__ Acceleration in degrees per second^2
+*/
+void QURHexapod::SetProfile(int __SPEED__, int __ACCEL__){
+  for(uint8_t x = 0; x < __JOINTS__; x++){    // Cicle with a iterator 'x' that go over each SERVO
+    ServoDriver.SetProfile(x, __SPEED__, __ACCEL__);
+  }
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetProfileServo
+  @purpuse Sets the motion profile of a specific servo
+
+  @param __SPEED__ Maximum speed in degrees per second
+  @param __ACCEL__ Acceleration in degrees per second^2
+  @param __LEG__   Int selector to select the LEG (from 0 to <MAX_LEGS>)
+  @param __SERVO__ Boolean selector to select the AXIS (true = AXIS X, false = AXIS Y)
+*/
+void QURHexapod::SetProfileServo(int __SPEED__, int __ACCEL__, int __LEG__, bool __SERVO__){
+  ServoDriver.SetProfile(JOINT(__LEG__, __SERVO__ ? ANGLE_X : ANGLE_Y), __SPEED__, __ACCEL__);
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetTrim
+  @purpuse Sets the offset of the pulse of a specific servo, the table of the
+       servo is rebuilt and the setpoint is sent again (with FAST_BOOT the
+       calibration is saved in the EEPROM in the background)
+
+  @param __TRIM__  Offset in microseconds (-128 to 127)
+  @param __LEG__   Int selector to select the LEG (from 0 to <MAX_LEGS>)
+  @param __SERVO__ Boolean selector to select the AXIS (true = AXIS X, false = AXIS Y)
+*/
+void QURHexapod::SetTrim(int __TRIM__, int __LEG__, bool __SERVO__){
+  uint8_t joint = JOINT(__LEG__, __SERVO__ ? ANGLE_X : ANGLE_Y);
+  ServoDriver.Trim[joint] = (int8_t)constrain(__TRIM__, -128, 127);
+  ServoDriver.Calibrate(joint);
+#if FAST_BOOT
+  ServoDriver.SaveCalibration();                      // The next boot starts with this trim
+#endif
+  if(ServoDriver.Setpoint[joint] >= 0)                // Move the servo to the calibrated pulse
+    ServoDriver.PostSetpoint(joint);
+}
+
+/**
+  @Struct QURHexapod
+  @Function PlayGait
+  @purpuse Starts to play a gait stored in the flash, the first frame starts in
+       the next pass of the Routine
+
+  @param __GAIT__   Pointer to the gait in PROGMEM (see QURGaits.h)
+  @param __CYCLES__ Number of cycles to play (0 = forever, only if the gait has GAIT_LOOP)
+  @return Returns false if the gait is not valid
+*/
+bool QURHexapod::PlayGait(const uint8_t *__GAIT__, uint8_t __CYCLES__){
+  GaitPlayer.Playing = false;
+  Generator.Enabled  = false;                         // The gait player and the generator can't move the legs together
+  ServoDriver.ClearQueue();                           // The frames of the gait before are discarded
+  if(!GaitPlayer.Reader.Begin(__GAIT__))
+    return false;
+  GaitPlayer.Cycles = __CYCLES__;
+  GaitPlayer.Playing = true;
+  return true;
+}
+
+/**
+  @Struct QURHexapod
+  @Function StopGait
+  @purpuse Stops the gait, the frame in progress ends his move and the frames
+       in the motion queue are discarded
+*/
+void QURHexapod::StopGait(){
+  GaitPlayer.Playing = false;
+  ServoDriver.ClearQueue();
+}
+
+/**
+  @Struct QURHexapod
+  @Function GaitPlaying
+  @purpuse Check if a gait is playing
+
+  @return Returns true while the gait has frames to play (in the flash or in the motion queue)
+*/
+bool QURHexapod::GaitPlaying(){
+  return GaitPlayer.Playing || ServoDriver.QueueBusy();
+}
+
+/**
+  @Struct QURHexapod
+  @Function StartWalk
+  @purpuse Starts to walk with the gait generator, the setpoints are calculated
+       every RATE_SETPOINTS and followed by the profile of every servo
+
+  @param __GAIT__  Type of gait (GAIT_TRIPOD, GAIT_RIPPLE, GAIT_WAVE)
+  @param __CYCLE__ Milliseconds of one cycle of the gait
+*/
+void QURHexapod::StartWalk(uint8_t __GAIT__, uint16_t __CYCLE__){
+  StopGait();                                         // The gait player and the generator can't move the legs together
+  SetCoordinated(false);
+  Generator.Begin(__GAIT__, __CYCLE__, RATE_SETPOINTS);
+}
+
+/**
+  @Struct QURHexapod
+  @Function StopWalk
+  @purpuse Stops the gait generator and puts every leg on the ground in the
+       middle of the stride
+*/
+void QURHexapod::StopWalk(){
+  Generator.Enabled = false;
+  for(int x = 0; x < __LEGS__; x++){                  // Cicle with a iterator 'x' that go over each LEG
+    SetAngleServo(GEN_CENTER_X, x, SERVO_X);
+    SetAngleServo(GEN_GROUND_Y, x, SERVO_Y);
+  }
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetWalkSpeed
+  @purpuse Changes the speed of the gait generator without losing the phase
+
+  @param __CYCLE__ Milliseconds of one cycle (0 = pause)
+*/
+void QURHexapod::SetWalkSpeed(uint16_t __CYCLE__){
+  Generator.SetCycle(__CYCLE__);
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetStride
+  @purpuse Sets the size of the steps of the gait generator
+
+  @param __STRIDE__ Length of the stride in setpoint units of the servo X (0-100)
+  @param __LIFT__   Height of the swing in setpoint units of the servo Y (0-50)
+*/
+void QURHexapod::SetStride(uint8_t __STRIDE__, uint8_t __LIFT__){
+  Generator.SetStride(__STRIDE__, __LIFT__);
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetHeading
+  @purpuse Sets the direction of the walk (in mode AUTOMATIC the RF-Controller overrides it)
+
+  @param __HEADING__ Direction in degrees (like atan2 of the joystick, 90 = forward)
+*/
+void QURHexapod::SetHeading(int __HEADING__){
+  Generator.SetHeading(__HEADING__);
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetTurn
+  @purpuse Rotates the robot in place with the gait generator
+
+  @param __TURN__ 1 = counter-clockwise, -1 = clockwise, 0 = walk to the heading
+*/
+void QURHexapod::SetTurn(int8_t __TURN__){
+  Generator.SetTurn(__TURN__);
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetCoordinated
+  @purpuse Enables or disables the coordinated mode (all the servos arrive together)
+
+  @param __MODE__     true = coordinated, false = every servo with his own profile
+  @param __DURATION__ Duration of every keyframe in milliseconds (0 = the time of the slowest servo)
+*/
+void QURHexapod::SetCoordinated(bool __MODE__, uint16_t __DURATION__){
+  ServoDriver.Coordinated  = __MODE__;
+  ServoDriver.KeyframeTime = __DURATION__;
+}
+
+/**
+  @Struct QURHexapod
+  @Function SetKeyframe
+  @purpuse Sets the setpoints of both axis and starts immediately a coordinated
+       move, the gait cycle time is the sum of the keyframe times
+
+  @param __SETPOINTSX__ Vector that contais the new Setpoints in AXIS X
+  @param __SETPOINTSY__ Vector that contais the new Setpoints in AXIS Y
+  @param __DURATION__   Duration of the keyframe in milliseconds (0 = the time of the slowest servo)
+*/
+void QURHexapod::SetKeyframe(int __SETPOINTSX__[], int __SETPOINTSY__[], uint16_t __DURATION__){
+  SetAnglesLeg(__SETPOINTSX__, SERVO_X);
+  SetAnglesLeg(__SETPOINTSY__, SERVO_Y);
+  SetCoordinated(true, __DURATION__);
+  ServoDriver.UpdateSetpoints(Angles);      // Don't wait the TaskSetpoints
+  All_Finished = false;
+}
+
+/**
+  @Struct QURHexapod
+  @Function QueueKeyframe
+  @purpuse Adds a keyframe at the end of the motion queue. The Routine plans it
+       before the keyframe in progress ends, so the servos don't stop between
+       them and the corner is blended. The producer (gait player, RF, PC) can
+       send the keyframes ahead of time while QueueSpace() is not 0
+
+  @param __SETPOINTSX__ Vector that contais the Setpoints in AXIS X
+  @param __SETPOINTSY__ Vector that contais the Setpoints in AXIS Y
+  @param __DURATION__   Milliseconds since the keyframe before (0 = the time of the slowest servo)
+  @return Returns false if the queue is full
+*/
+bool QURHexapod::QueueKeyframe(int __SETPOINTSX__[], int __SETPOINTSY__[], uint16_t __DURATION__){
+  return ServoDriver.QueueFrame(__SETPOINTSX__, __SETPOINTSY__, __DURATION__);
+}
+
+/**
+  @Struct QURHexapod
+  @Function QueueSpace
+  @purpuse Check the space of the motion queue
+
+  @return Returns the keyframes that can be added (0 to MOTION_QUEUE)
+*/
+uint8_t QURHexapod::QueueSpace(){
+  return MOTION_QUEUE - (uint8_t)(ServoDriver.QueueHead - ServoDriver.QueueTail);
+}
+
+/**
+  @Struct QURHexapod
+  @Function ClearQueue
+  @purpuse Discards the keyframes of the motion queue, the keyframe in progress ends his move
+*/
+void QURHexapod::ClearQueue(){
+  ServoDriver.ClearQueue();
+}
+
+/**
+  @Struct QURHexapod
+  @Function RamReport
+  @purpuse Prints to the PCSerial the bytes of RAM of every part of the robot
+       (sizeof of this board, the Simulator prints the sizes of the host)
+*/
+void QURHexapod::RamReport(){
+  PCSerial.print("RAM servos: ");       PCSerial.println((unsigned int)sizeof(SERVO_DRIVER));
+  PCSerial.print("RAM rf: ");           PCSerial.println((unsigned int)sizeof(RF_DRIVER));
+  PCSerial.print("RAM rf ring: ");      PCSerial.println((unsigned int)sizeof(QURPacketRing<RF_RING_SIZE, QUR_PACKET_MAX>));
+  PCSerial.print("RAM motion queue: "); PCSerial.println((unsigned int)(sizeof(MOTION_FRAME) * MOTION_QUEUE));
+  PCSerial.print("RAM gait player: ");  PCSerial.println((unsigned int)sizeof(GAIT_PLAYER));
+  PCSerial.print("RAM generator: ");    PCSerial.println((unsigned int)sizeof(GaitGenerator));
+  PCSerial.print("RAM scheduler: ");    PCSerial.println((unsigned int)sizeof(QURScheduler));
+  PCSerial.print("RAM servo output: "); PCSerial.println((unsigned int)sizeof(QURServoLibrary));
+#if PROFILER
+  PCSerial.print("RAM profiler: ");     PCSerial.println((unsigned int)sizeof(QURHistogram) * PROFILE_STAGES);
+#endif
+#if PCLINK
+  PCSerial.print("RAM pc link: ");      PCSerial.println((unsigned int)sizeof(PCDRIVER));
+#endif
+#if MODULESD
+  PCSerial.print("RAM recorder: ");     PCSerial.println((unsigned int)sizeof(ModuleSD));
+#endif
+  PCSerial.print("RAM robot: ");        PCSerial.println((unsigned int)sizeof(QURHexapod));
 }
 
 void QURHexapod::Debug(bool __ALL__, int __SERVO__, int __LEG__){
-  int ID   = ServoDriver.Legs[__LEG__].Joint[__SERVO__].ID;
-  int AXIS = ServoDriver.Legs[__LEG__].Joint[__SERVO__].AXIS;
-  int pin  = ServoDriver.Legs[__LEG__].Joint[__SERVO__].PIN_AVAILABLES[AXIS][ID];
-  int i = __ALL__ == true ? ServoDriver.Legs[__LEG__].Joint[__SERVO__].MIN_Angle : 0;
-  for (; i < (__ALL__ == true ? ServoDriver.Legs[__LEG__].Joint[__SERVO__].MAX_Angle : 180); ++i)
+  uint8_t joint = JOINT(__LEG__, __SERVO__);
+  int i = __ALL__ == true ? ServoDriver.MinAngle(joint) : 0;
+  for (; i < (__ALL__ == true ? ServoDriver.MaxAngle(joint) : 180); ++i)
   {
-    ServoDriver.Legs[__LEG__].Joint[__SERVO__].Control.write(i);
+    ServoDriver.Output->Set(joint, map(i, 0, 180, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH));   // Degrees to pulse like Servo::write
+    ServoDriver.Output->Latch();
     delay(100);
   }
 }
\ No newline at end of file
@@ -20,15 +20,49 @@
 // * Mode Manual: This mode allows you to operate the servos from the console
 //
 // CONSTRUCTOR:
-//   QURHexapod Hexapod(Limit_Angles_x, Limit_Angles_x )
-//     Limit_Angles_x & Limit_Angles_y - Vector to specify the limit angles for the servos in X and Y.
+//   QURHexapod Hexapod(Limit_Angles_x, Limit_Angles_y [, Limit_Angles_z])
+//     Limit_Angles_x & Limit_Angles_y - Tables {MIN, MAX} of the limit angles of every leg (const int16_t [2][__LEGS__]) for the servos in X and Y
+//                                       (and Z with __SERVOS__ 3). They must be declared PROGMEM, the robot reads them from the flash (a word each).
+//                                       A table of other size doesn't compile (the layout is in QURGeometry.h)
 //
 // METHODS:
+//   Robot.Start() - Attach the servos to their pins and initialize the RF-Controller (call it from setup())
+//   Robot.SetOutput(&_OUTPUT) - Selects how the pulses are sent (QURServoOutput.h: QURServoLibrary, QURTimerOutput, QURPCA9685), call it before Start()
+//                     If the output can't start in this board the robot uses the Servo library
 //   Robot.Routine() - Is the routine that the robots follows (Read data from RF(Automatic) or Read data from Vector(Manual), and after moves the servos to the setPoints)
+//                     Never blocks: every job is a task of the Scheduler with his own rate (RATE_RF, RATE_SETPOINTS, RATE_SERVOS, RATE_TELEMETRY)
+//                     With PROFILER true it measures his stages and sends them to the PC in binary frames (Tools/ProfileDecoder)
+//                     With MODULESD true it records his flight in the ModuleSD (QURRecorder.h, Tools/LogDecoder)
+//                     With PCLINK true a PC streams setpoints in the PCSerial (QURPCLink.h), they are applied in mode MANUAL
+//                     With DEBUG_LEVEL the messages of the levels enabled go to the PCSerial in binary (QURDebug.h, Tools/DebugDecoder)
 //   Robot.SelectMode(_MODE) - This change the mode to mode Manual or Automatic(MODE_ is true -> Automatic, _MODE_ is false -> Manual)
 //   Robot.SetAnglesLeg(_SETPOINTS[], __SERVO)   - Sets the setpoints for the Servos in X or Y from the vector "SETPOINTS_"
 //   Robot.SetAngle(_SETPOINT, __LEG, __SERVO) - Sets the setpoint to a specific LEG("LEG" a value from 0 to the number of Legs) and SERVO("SERVO_" -> true is X and false is Y). 
-//   Robot.ServosFinished() - Returns a value true if the servos are in the setpoints or false if they are not
+//   Robot.SetAngleAxis(_SETPOINT, __LEG, _AXIS) - Like SetAngleServo with the axis ANGLE_X, ANGLE_Y or ANGLE_Z (legs of 3 servos)
+//   Robot.ServosFinished() - Returns a value true if the servos are in the setpoints or false if they are not (constant time, masks of the servos)
+//   Robot.SetProfile(_SPEED, _ACCEL) - Sets the maximum speed (degrees/s) and acceleration (degrees/s^2) of all servos
+//                     They are clamped to MAX_SPEED and MAX_ACCEL (the arithmetic of the motion interrupt)
+//   Robot.SetProfileServo(_SPEED, _ACCEL, __LEG, __SERVO) - Sets the maximum speed and acceleration of a specific servo
+//   Robot.SetTrim(_TRIM, __LEG, __SERVO) - Sets the offset in microseconds of the pulse of a specific servo (calibration)
+//                     With FAST_BOOT the trims and the tables of the servos are saved in the EEPROM in the background
+//   Robot.SetCoordinated(_MODE, _TIME) - Enables the coordinated mode, all the servos arrive together in _TIME ms (0 = the slowest servo)
+//   Robot.SetKeyframe(_X[], _Y[], _TIME) - Sets the setpoints of both axis and starts a coordinated move of _TIME ms
+//   Robot.QueueKeyframe(_X[], _Y[], _TIME) - Adds a keyframe at the end of the motion queue, it starts _TIME ms after the keyframe before
+//                     without stopping between them (the corner is blended). Returns false if the queue is full
+//   Robot.QueueSpace() - Returns the keyframes that can be added to the motion queue
+//   Robot.ClearQueue() - Discards the keyframes of the queue, the keyframe in progress ends his move
+//                     A change of the setpoints (SetAngleServo, SetKeyframe, ...) also clears the queue
+//   Robot.PlayGait(GAIT_WALK, _CYCLES) - Plays a gait from the flash (QURGaits.h) _CYCLES times (0 = forever), streamed into the motion queue
+//   Robot.StopGait() - Stops the gait at the end of the frame in progress
+//   Robot.GaitPlaying() - Returns true while a gait is playing
+//   Robot.StartWalk(GAIT_TRIPOD, _CYCLE) - Walks with the gait generator (GAIT_TRIPOD, GAIT_RIPPLE, GAIT_WAVE), one cycle every _CYCLE ms
+//                     In AUTOMATIC the heading is the Angle sent by the RF-Controller
+//   Robot.StopWalk() - Stops the gait generator and puts the legs in the middle of the stride
+//   Robot.SetWalkSpeed(_CYCLE) - Changes the milliseconds of one cycle while walking (0 = pause)
+//   Robot.SetStride(_STRIDE, _LIFT) - Length of the stride (0-100) and height of the swing (0-50)
+//   Robot.SetHeading(_ANGLE) - Direction of the walk in degrees (90 = forward)
+//   Robot.SetTurn(_TURN) - Rotates in place (1 = counter-clockwise, -1 = clockwise, 0 = walk)
+//   QURHexapod::RamReport() - Prints the bytes of RAM used by every part of the robot to the PCSerial
 //
 // HISTORY:
 // 06/20/2018 v1.0 - Initial release.
@@ -37,51 +71,185 @@
 #ifndef QURHEXAPOD_H
 #define QURHEXAPOD_H
 
+// ---------------------------------------------------------------------------
+// Options of the firmware (the same for every file of the sketch)
+// ---------------------------------------------------------------------------
+#include "QURConfig.h"
+
 // ---------------------------------------------------------------------------
 // Required libraries for Hexapod Control 
 // ---------------------------------------------------------------------------
 #include <Servo.h> 
 #include <RF24.h>
 #include <Arduino.h>
+#include <QURScheduler.h>
+#include <QURPacket.h>
+#include <QURRing.h>
+#include <QURProfiler.h>
+#include <QURRecorder.h>
+#include <QURPCLink.h>
+#include <QURDebug.h>
+#include <QURStore.h>
+#include "QURMessages.h"
+#include "QURGeometry.h"
+#include "QURMotionTimer.h"
+#include "QURServoOutput.h"
+#include "QURGait.h"
+#include "QURGaitGenerator.h"
 
 // ---------------------------------------------------------------------------
 // COMUNICATION DEFINE'S
 // ---------------------------------------------------------------------------
-
-// Defined the port to comunicate to the plataform for Debugging or Interpretation
-#define PCSerial Serial
-// Define the baudrate for the Serial's PORTS
-#define BAUDRATE 115200
-#ifndef BAUDRATE
-  #define BAUDRATE 115200
+// The ports and the options of the communication (PCSerial, BAUDRATE, DEBUG_LEVEL,
+// MODULESD, PCLINK) are in QURConfig.h. The macros of the levels above DEBUG_LEVEL
+// are empty: no code and the arguments are not evaluated
+#if DEBUG_LEVEL >= DEBUG_LEVEL_ERROR
+  #define DEBUG_ERROR(...)    QURDebug.Log(DEBUG_LEVEL_ERROR, __VA_ARGS__)
+#else
+  #define DEBUG_ERROR(...)
+#endif
+#if DEBUG_LEVEL >= DEBUG_LEVEL_WARNING
+  #define DEBUG_WARNING(...)  QURDebug.Log(DEBUG_LEVEL_WARNING, __VA_ARGS__)
+#else
+  #define DEBUG_WARNING(...)
 #endif
-// Define MODULESD works if you are using a Arduino Due or Mega and you connect a Module for controlling
-// a microSD this MODULE Works like Master -> Slave to a another Atmega328p conected to a MicroSD.
-// if you are'nt using the ModuleSD set this.
-#define MODULESD false
-#ifdef MODULESD == true
-  #define SDcontrol Serial1
+#if DEBUG_LEVEL >= DEBUG_LEVEL_INFO
+  #define DEBUG_INFO(...)     QURDebug.Log(DEBUG_LEVEL_INFO, __VA_ARGS__)
+#else
+  #define DEBUG_INFO(...)
 #endif
-// If is'nt defined DEBUG set DEBUG to False (NOT DEBUGGING)
-// DEBUG Allows to the Hexapod to send data about the things is he doing to the PC from the Serial Port
-#ifndef DEBUG == true
-  #define DEBUG false
+#if DEBUG_LEVEL >= DEBUG_LEVEL_TRACE
+  #define DEBUG_TRACE(...)    QURDebug.Log(DEBUG_LEVEL_TRACE, __VA_ARGS__)
+#else
+  #define DEBUG_TRACE(...)
 #endif
 
 // ---------------------------------------------------------------------------
 // SERVO DRIVER DEFINE'S
 // ---------------------------------------------------------------------------
-#define __SERVOS__    2     // Number of Servos per Leg
-#define __LEGS__      6     // Number of Legs in the Robot
+// The layout is fixed when the firmware is compiled (QURGeometry.h): __LEGS__, __SERVOS__
+// and the pins SERVO_PINS_X/Y/Z are only changed in QURConfig.h. The vectors of the servos
+// are sized with them and the sketch must pass tables of the same size
 #define ANGLE_X       0     // Selector for the Angle X
 #define ANGLE_Y       1     // Selector for the Angle Y
-#define STEP_SERVO    1     // STEPs for the Servo motion 
+#define ANGLE_Z       2     // Selector for the Angle Z (only legs of 3 servos)
+typedef QURGeometry<__LEGS__, __SERVOS__> GEOMETRY;       // Layout checked by the compiler
+#define __JOINTS__    GEOMETRY::Joints                    // Number of Servos in the Robot
+#define JOINT(__LEG__, __AXIS__)  ((__LEG__) * __SERVOS__ + (__AXIS__))   // Index of a servo in the vectors of SERVO_DRIVER
+#define JOINTS_MASK   GEOMETRY::Mask                      // Bits of all the servos
+#define JOINT_BIT(__JOINT__)  ((joint_mask_t)((joint_mask_t)1 << (__JOINT__)))   // Bit of a servo in the masks
+// The RF command, the PC link and the gaits carry 6 legs in X and Y (QUR_JOINTS), in other
+// layouts the first LINK_LEGS legs follow them and the rest keep their setpoints
+#define LINK_LEGS     (__LEGS__ < QUR_JOINTS / 2 ? __LEGS__ : QUR_JOINTS / 2)
+// Pins of the servos per axis, one per leg (a pin missing or repeated doesn't compile)
+#if __SERVOS__ > 2 && !defined(SERVO_PINS_Z)
+  #error "Legs of 3 servos need the pins of the Axis Z (SERVO_PINS_Z)"
+#endif
+// Pins in the flash: SERVO_PINS[AXIS][LEG]
+#if __SERVOS__ > 2
+static constexpr uint8_t SERVO_PINS[__SERVOS__][__LEGS__] PROGMEM = {SERVO_PINS_X, SERVO_PINS_Y, SERVO_PINS_Z};
+#else
+static constexpr uint8_t SERVO_PINS[__SERVOS__][__LEGS__] PROGMEM = {SERVO_PINS_X, SERVO_PINS_Y};
+#endif
+static_assert(GEOMETRY::PinsValid(SERVO_PINS), "SERVO_PINS needs one pin per leg in every axis, without repeated pins");
+
+// ---------------------------------------------------------------------------
+// MOTION ENGINE DEFINE'S
+// The servos are interpolated by a timer interrupt (QURMotionTimer.h) with
+// a trapezoidal profile per joint: accelerate until MaxSpeed and decelerate
+// to arrive at the setpoint without overshoot. The positions are pulses in
+// fixed point Q8 (1 unit = 1/256 microseconds).
+// ---------------------------------------------------------------------------
+// MOTION_RATE: Interpolations per second of the motion engine (QURConfig.h)
+#define DEFAULT_SPEED   180         // Default maximum speed of the servos in degrees per second
+#define DEFAULT_ACCEL   720         // Default acceleration of the servos in degrees per second^2
+#define PULSE_RANGE     (MAX_PULSE_WIDTH - MIN_PULSE_WIDTH)   // Microseconds of pulse for 180 degrees
+#define SPEED_TO_Q8(v)  ((int64_t)(v) * PULSE_RANGE * 256L / (180L * MOTION_RATE))
+#define ACCEL_TO_Q8(a)  ((int64_t)(a) * PULSE_RANGE * 256L / (180L * MOTION_RATE * MOTION_RATE))
+// The interrupt compares speed^2 with 2 * accel * distance (distance <= PULSE_RANGE in Q8)
+// in int32_t, SetProfile clamps the limits so both fit: MAX_SPEED ~3500 degrees/s and
+// MAX_ACCEL ~34000 degrees/s^2 at 200 Hz
+#define SPEED_Q8_MAX    46340L                                      // sqrt(2^31 - 1)
+#define ACCEL_Q8_MAX    (0x7FFFFFFFL / (2L * PULSE_RANGE * 256L))
+#define MAX_SPEED       ((int32_t)(SPEED_Q8_MAX * 180LL * MOTION_RATE / (PULSE_RANGE * 256L)))
+#define MAX_ACCEL       ((int32_t)(ACCEL_Q8_MAX * 180LL * MOTION_RATE * MOTION_RATE / (PULSE_RANGE * 256L)))
+
+// ---------------------------------------------------------------------------
+// MOTION QUEUE DEFINE'S
+// The keyframes can be streamed ahead of time into a queue (QueueKeyframe).
+// The Routine plans the next keyframe while the one in progress moves, and
+// the motion interrupt starts it in the same interpolation that the other
+// ends, so there is no stop between keyframes. The corner between two moves
+// is blended: the last and first BLEND/2 interpolations change the speed of
+// every servo linearly from one move to the other (parabolic blend), BLEND is
+// a power of 2 up to 2^MOTION_BLEND_SHIFT and not longer than the moves.
+// ---------------------------------------------------------------------------
+// MOTION_QUEUE and MOTION_BLEND_SHIFT are in QURConfig.h
+
+// ---------------------------------------------------------------------------
+// CALIBRATION DEFINE'S
+// Every joint converts his command (0-100) into a pulse with his own lookup
+// table, built when the limits or the trim change (SERVO_DRIVER::Calibrate). The
+// table has a point every CALIB_STEP commands in Q4 microseconds (1/16 us),
+// the commands between two points are interpolated with shifts, so there is
+// no map() nor divisions when the setpoints change.
+// ---------------------------------------------------------------------------
+#define CALIB_SHIFT     2                       // log2 of CALIB_STEP
+#define CALIB_STEP      (1 << CALIB_SHIFT)      // Commands between two points of the table
+#define CALIB_POINTS    (100 / CALIB_STEP + 1)  // Points of the table (commands 0 to 100)
+// With FAST_BOOT true Start() reads the tables and the trims from the EEPROM
+// (QURStore.h) instead of building them (CALIB_POINTS divisions per servo,
+// ~12 ms in the AVR). The record is only used if it was saved with the layout
+// and the limits of the sketch, if not the tables are built and saved in the
+// background (TaskServos), like after every SetTrim. setup() doesn't wait for
+// anything else, the Routine runs in less than 100 ms after the reset
+#define CALIB_LAYOUT        ((__LEGS__ << 4) | __SERVOS__)          // Layout of the record (legs and servos)
+#define CALIB_RECORD_JOINT  (5 + CALIB_POINTS * 2)                  // Bytes of a servo: Min(16), Max(16), Trim and PulseTable(16)
+#define CALIB_RECORD        (1 + __JOINTS__ * CALIB_RECORD_JOINT)   // Bytes of the record: Layout and every servo
 
 // ---------------------------------------------------------------------------
 // TIMING DEFINE'S
+// Period in microseconds of every task of the Routine (see QURScheduler.h)
 // ---------------------------------------------------------------------------
-#define TIMEOUT_RF    50    // Maximum microseconds to read data from RF RF-Controller
-#define TIMEOUT_LEG   10    // Maximum microseconds for the movement of the legs
+#define RATE_RF         1000UL      // Decode the packets of the RF ring (1 kHz, if the ring is empty it only compares two indexes)
+#define RATE_SETPOINTS  20000UL     // Update the setpoints of the servos (50 Hz)
+#define RATE_SERVOS     (1000000UL / MOTION_RATE)   // Check the servos (and interpolate them if there is no motion timer)
+#define RATE_TELEMETRY  100000UL    // Send the state of the robot to the PC (10 Hz)
+#define RATE_GAIT       5000UL      // Stream the frames of the gait into the motion queue (200 Hz)
+#define RATE_RECORDER   1000UL      // Send the log to the ModuleSD (1 kHz, the TX buffer of 64 bytes leaves in 2.5 ms)
+#define LOG_TIMING      100         // Periods of RATE_RECORDER between two records of the timings (10 Hz)
+#define RATE_PCLINK     1000UL      // Read the frames of the PC (1 kHz, the RX buffer of 64 bytes fills in 5.5 ms at 115200)
+#define PCLINK_STATE    100         // Periods of RATE_PCLINK without frames between two States (10 Hz, the PC sees the queue move)
+#define RF_FIFO_DEPTH   3           // Maximum packets in the RX FIFO of the nRF24 (bounds Drain)
+#define RF_RING_SIZE    8           // Packets between the RF interrupt and the Routine (power of 2)
+// TELEMETRY, PROFILER and PROFILE_CLOCK are in QURConfig.h
+#define RATE_PROFILE    50000UL     // Send the histogram of one stage of the PROFILER (20 Hz, every stage each 300 ms)
+
+// Task IDs, in the order they are added to the Scheduler
+#define TASK_RF         0
+#define TASK_SETPOINTS  1
+#define TASK_SERVOS     2
+#define TASK_TELEMETRY  3
+#define TASK_GAIT       4
+#define TASK_PROFILE    5
+#define TASK_RECORDER   6
+#define TASK_PCLINK     7
+
+// Stages measured by the PROFILER
+#define PROFILE_RF_IRQ     0    // Drain of the radio in the RF interrupt
+#define PROFILE_RF         1    // ReadData: decode of the RF packets
+#define PROFILE_SETPOINTS  2    // UpdateSetpoints
+#define PROFILE_FINISHED   3    // ProcessFinished
+#define PROFILE_MOTION     4    // BackgroundProcess (motion interrupt or TaskServos)
+#define PROFILE_LOOP       5    // Time between two calls of Routine() (jitter of loop())
+#define PROFILE_STAGES     6
+#if PROFILER
+  #define PROFILE_START(__T__)            uint16_t __T__ = (uint16_t)PROFILE_CLOCK()
+  #define PROFILE_STOP(__STAGE__, __T__)  QURHexapod::Instance->Profile[__STAGE__].Add((uint16_t)PROFILE_CLOCK() - __T__)
+#else
+  #define PROFILE_START(__T__)
+  #define PROFILE_STOP(__STAGE__, __T__)
+#endif
 
 // ---------------------------------------------------------------------------
 // AVAILABLES MODES DEFINE'S
@@ -100,8 +268,23 @@
 // ---------------------------------------------------------------------------
 // RF PROTOCOL DEFINE'S
 // ---------------------------------------------------------------------------
+#define WALKING   true      // Mode of the RF-Controller: the joystick is the heading of the walk
+#define ROTATION  false     // Mode of the RF-Controller: the joystick rotates the robot
 #define RF_CSN 49
 #define RF_CE  48
+// IRQ of the nRF24 (active low), must be an external interrupt pin of the board
+// (Mega: 2, 3, 18, 19, 20, 21). Define it as -1 if the IRQ is not wired, the
+// radio is then polled by TaskReadRF.
+#ifndef RF_IRQ
+  #define RF_IRQ 19
+#endif
+// Bit of RF_IRQ in EIMSK, the RF interrupt masks only himself while it drains the radio
+// (the Mega numbers the interrupts of attachInterrupt 0-5 as INT4, INT5, INT0, ..., INT3)
+#if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+  #define RF_IRQ_MASK  _BV((digitalPinToInterrupt(RF_IRQ) + 4) % 6)
+#elif defined(__AVR__)
+  #define RF_IRQ_MASK  _BV(digitalPinToInterrupt(RF_IRQ))
+#endif
 
 #define RGB_RED   A4
 #define RGB_GREEN A5
@@ -119,58 +302,109 @@
 // ---------------------------------------------------------------------------
 class QURHexapod
 {
-  // ---------------------------------------------------------------------------
-  // STRUCT FOR SERVOS
-  // Contains the variables thats allows to control every servo.
-  // Methods:
-  //      - void ConfigPinServo(int)
-  // ---------------------------------------------------------------------------
-  typedef struct Joints
-  {   
-    // Variable vector, contains the pins availables for the Servos
-    const int PIN_AVAILABLES[2][6] = {
-      {2, 3, 4, 5, 6, 7},
-      {8, 9, 10, 11, 12, 13}
-    };
-    int ID = 0;                 // ID: This declares what ID have the servo, this help to the algorithm
-    int Setpoint = 50;           // Setpoint: Is the Angle which the servo is going
-    int MAX_Angle = 0;          // MAX_Angles: Is the Maximum Angles available for the servo
-    int MIN_Angle = 0;          // MIN_Angles: Is the Minimum Angles available for the servo
-    int Estado = 0;             // Estado:: Is the actual Angle of the servo.
-    int AXIS = 0;               // AXIS: Variable selector between Axis X and Y. (AXIS == 0 is X and AXIS == 1 is Y)
-    bool Is_Finished = false;   // Is_Finished = Shows if the servo angles is equal to the setpoint
-    void ConfigPinServo(int);   // ConfigPinServo: Read a value int and sets the ID and PIN for the Servo
-    Servo Control;              // Control: Is the instancie of the Servo
-  };
-
-  // ---------------------------------------------------------------------------
-  // STRUCT FOR LEGS
-  // Contains the servos and function to control the Leg
-  // ---------------------------------------------------------------------------
-  typedef struct Leg
-  {
-    Joints Joint[__SERVOS__];               // Joint: Is the instance of the Struct Joints and instance a vector with a size equal to the number of Servos per Leg (DEFAULT: 2)
-    void SetMinMaxAngles(int, int, int);    // SetMinMaxAngles: Function that allows to configure the Maximum and Minimum angle for the servo in especific Axis
-    void GoToSetpoint();                    // GoToSetpoint: Function to move the servo a STEP to the current setpoint.
-  };
-
   // ---------------------------------------------------------------------------
   // STRUCT FOR LEGS AND SERVO CONTROL
-  // Contanis the Legs and function to move the legs at the same time.
-  // Control the setpoints and Servos.
-  // Buffer of movement.
+  // Contanis the state of every servo and function to move the legs at the
+  // same time. Control the setpoints and Servos.
+  // The state is stored by field and not by servo (struct of arrays): every
+  // vector has one element per joint (JOINT(leg, axis)), the flags are bits
+  // of a mask and the pins and limits stay in the flash. Target, Position,
+  // Velocity and the masks are shared with the motion interrupt.
+  // Coordinated mode: every change of the setpoints is a keyframe, all the
+  // servos move in a straight line (DDA) and arrive in the same interpolation
+  // after KeyframeTime milliseconds (0 = the time of the slowest servo).
+  // Motion queue: the keyframes of the Queue are planned one ahead into the
+  // Next vectors (PlanNext, Routine) and the interrupt starts them when the
+  // move in progress ends or blends both moves (StartNext, BlendStep).
   // Methods:
+  //      - void ConfigPinServo(uint8_t)
+  //      - void SetProfile(uint8_t, int, int)
+  //      - void Calibrate(uint8_t)
+  //      - bool LoadCalibration()
+  //      - void SaveCalibration()
+  //      - uint8_t CalibrationByte(void *, uint16_t)
+  //      - int32_t CommandPulse(uint8_t, int)
+  //      - void PostSetpoint(uint8_t)
+  //      - void Interpolate(uint8_t)
+  //      - int32_t PlanMove(uint8_t)
+  //      - void StepMove(uint8_t, uint16_t)
+  //      - void WritePulse(uint8_t)
   //      - bool ProcessFinished()
   //      - void BackgroundProcess()
-  //      - void UpdateSetpoints(int[], int[]);
+  //      - void UpdateSetpoints(int[][__LEGS__]);
+  //      - void StartMove()
+  //      - bool QueueFrame(int[], int[], uint16_t)
+  //      - bool PlanNext()
+  //      - void StartNext(uint16_t)
+  //      - void BlendStep(uint8_t)
+  //      - void ClearQueue()
+  //      - bool QueueBusy()
   // ---------------------------------------------------------------------------
+  struct MOTION_FRAME
+  {
+    int8_t Setpoint[__JOINTS__];    // Setpoint: Command (0-100) of every joint
+    uint16_t Duration;              // Duration: Milliseconds since the keyframe before (0 = the time of the slowest servo)
+  };
   typedef struct SERVO_DRIVER
   {
-    Leg Legs[__SERVOS__];                 // Legs: Is a Instancie of the Struct Leg and create a vector with a size equal to the number of Legs in the Hexapod (DEFAULT: 6)
+    const int16_t (*Limits[__SERVOS__])[__LEGS__];  // Limits: Tables {MIN, MAX} of the angles of every axis (PROGMEM of the sketch)
+    int8_t Setpoint[__JOINTS__];                    // Setpoint: Is the command (0-100) which the servo is going (-1 until the first update)
+    int8_t Trim[__JOINTS__];                        // Trim: Offset of the pulse in microseconds (mechanical calibration of the servo)
+    uint16_t PulseTable[__JOINTS__][CALIB_POINTS];  // PulseTable: Pulse in Q4 microseconds every CALIB_STEP commands
+    int32_t SpeedLimit[__JOINTS__];                 // SpeedLimit: Maximum speed in Q8 microseconds per interpolation
+    int16_t AccelStep[__JOINTS__];                  // AccelStep: Acceleration in Q8 microseconds per interpolation^2
+    volatile int32_t Target[__JOINTS__];            // Target: Setpoint of the servo in Q8 microseconds
+    int32_t Position[__JOINTS__];                   // Position: Actual pulse of the servo in Q8 microseconds
+    int32_t Velocity[__JOINTS__];                   // Velocity: Actual speed in Q8 microseconds per interpolation
+    uint16_t Pulse[__JOINTS__];                     // Pulse: Last pulse written to the servo in microseconds
+    int32_t MoveStep[__JOINTS__];                   // MoveStep: Q8 microseconds per interpolation of the coordinated move (quotient)
+    uint16_t MoveRest[__JOINTS__];                  // MoveRest: Remainder of the division distributed like Bresenham (< MoveTicks)
+    uint16_t MoveError[__JOINTS__];                 // MoveError: Accumulator of the remainder
+    joint_mask_t MoveBackward = 0;                  // MoveBackward: Bit of every servo whose remainder steps are negative
+    joint_mask_t Dirty = 0;                         // Dirty: Bit of every servo whose command (Angles) changed since UpdateSetpoints
+    volatile joint_mask_t Finished = 0;             // Finished: Bit of every servo that is in his setpoint
+    QURServoOutput *Output;                         // Output: Sends the pulses of all the servos (QURServoOutput.h, channel = joint)
+    QURStoreWriter Store;                           // Store: Saves the tables and the trims in the EEPROM (FAST_BOOT)
     bool ManualMode = AUTOMATIC;          // ManualMode: Variable that specifies the mode of control (DEFAULT: false)
+    bool Coordinated = false;             // Coordinated: All servos arrive together to the setpoints (DEFAULT: false)
+    uint16_t KeyframeTime = 0;            // KeyframeTime: Duration in milliseconds of a coordinated move (0 = slowest servo)
+    volatile bool Planning = false;       // Planning: The Routine is preparing a move, the interrupt must wait
+    volatile uint16_t MoveTicks = 0;      // MoveTicks: Interpolations of the coordinated move
+    volatile uint16_t MoveTick = 0;       // MoveTick: Interpolations done of the coordinated move
+    MOTION_FRAME Queue[MOTION_QUEUE];     // Queue: Keyframes waiting to be planned
+    uint8_t QueueHead = 0;                // QueueHead: Next keyframe to write (QueueFrame)
+    uint8_t QueueTail = 0;                // QueueTail: Next keyframe to plan (PlanNext)
+    int32_t NextTarget[__JOINTS__];       // NextTarget: Target of the next move in Q8 microseconds
+    int32_t NextStep[__JOINTS__];         // NextStep: Q8 microseconds per interpolation of the next move
+    uint16_t NextTicks = 0;               // NextTicks: Interpolations of the next move
+    uint8_t NextBlend = 0;                // NextBlend: log2 of the interpolations of the blend with the move in progress (0 = no blend)
+    volatile bool NextReady = false;      // NextReady: The next move is planned, only the interrupt clears it
+    volatile bool Blending = false;       // Blending: The interrupt is in the corner between the move in progress and the next
+    uint8_t BlendTick = 0;                // BlendTick: Interpolations done of the blend
+    void ConfigPinServo(uint8_t);         // ConfigPinServo: Attach the servo to his pin (SERVO_PINS)
+    void SetProfile(uint8_t, int, int);   // SetProfile: Sets the maximum speed and the acceleration of the servo
+    void Calibrate(uint8_t);              // Calibrate: Builds the PulseTable of the servo from the limits and the Trim
+    bool LoadCalibration();               // LoadCalibration: Reads the PulseTables and the Trims from the EEPROM, false if they must be built
+    void SaveCalibration();               // SaveCalibration: Starts to save the PulseTables and the Trims in the EEPROM (TaskServos)
+    static uint8_t CalibrationByte(void *, uint16_t);   // CalibrationByte: Byte N of the record of the EEPROM (QURStoreSource)
+    int32_t CommandPulse(uint8_t, int);   // CommandPulse: Converts a command (0-100) into a pulse in Q8 microseconds
+    void PostSetpoint(uint8_t);           // PostSetpoint: Sends the Setpoint of the servo to the motion engine (Target)
+    void Interpolate(uint8_t);            // Interpolate: Moves the servo one interpolation of the profile (motion interrupt)
+    int32_t PlanMove(uint8_t);            // PlanMove: Sets the Target of a coordinated move and returns the distance in interpolations at MaxSpeed
+    void StepMove(uint8_t, uint16_t);     // StepMove: Moves the servo one interpolation of the coordinated move (motion interrupt)
+    void WritePulse(uint8_t);             // WritePulse: Stages the Position in the Output if the pulse changed
+    int MinAngle(uint8_t);                // MinAngle: Minimum angle of the servo (from the flash)
+    int MaxAngle(uint8_t);                // MaxAngle: Maximum angle of the servo (from the flash)
     bool ProcessFinished();               // ProcessFinished: Function that returns true if all Servos are in their place or false if not.
-    void BackgroundProcess();             // BackgroundProcess: Funtion that go over all servos and move them to their Setpoints
-    void UpdateSetpoints(int[], int[]);   // UpdateSetpoints: Function that update the Setpoint of all servos.
+    void BackgroundProcess();             // BackgroundProcess: Funtion that go over all servos and move them to their Setpoints, then latches the Output (motion interrupt)
+    void UpdateSetpoints(int[][__LEGS__]);  // UpdateSetpoints: Function that update the Setpoint of all servos.
+    void StartMove();                     // StartMove: Starts a coordinated move to the Setpoints of all servos
+    bool QueueFrame(int[], int[], uint16_t);  // QueueFrame: Adds a keyframe at the end of the Queue, false if it is full
+    bool PlanNext();                      // PlanNext: Plans the oldest keyframe of the Queue as the next move (Routine)
+    void StartNext(uint16_t);             // StartNext: Starts the next move, from the interpolation N of it (motion interrupt)
+    void BlendStep(uint8_t);              // BlendStep: Moves the servo one interpolation of the blend (motion interrupt)
+    void ClearQueue();                    // ClearQueue: Discards the keyframes not started, the move in progress ends
+    bool QueueBusy();                     // QueueBusy: There are keyframes waiting or planned
   };
 
   // ---------------------------------------------------------------------------
@@ -179,82 +413,162 @@ class QURHexapod
   // that have the information of the instruction from the RF-Controller
   // Methods:
   //      - Start()
+  //      - Drain()
   //      - ReadData()
+  //      - Answer()
+  // The IRQ of the nRF24 moves the packets of the radio into the Ring
+  // (Drain), the Routine decodes them in order without waiting (ReadData).
+  // The state of the robot returns to the controller inside the ACK of his
+  // next command (ACK payload, no extra packets in the air): after every
+  // batch of packets the Routine loads a new Status (Answer).
   // ---------------------------------------------------------------------------
   typedef struct RF_DRIVER
   {
-    // ---------------------------------------------------------------------------
-    // STRUCT OF PACKAGE RF
-    // This contains all data recived from the RF Controler in mode Vector 
-    // or mode Automatic
-    // ---------------------------------------------------------------------------
-    struct package
-    {
-      int VectorAnglesX[6] = {0, 0, 0, 0, 0, 0};  // Contains the values of the setpoints for the servos in Axis X
-      int VectorAnglesY[6] = {0, 0, 0, 0, 0, 0};  // Contains the values of the setpoints for the servos in Axis Y
-      int VectorPush[3] = {0, 0, 0};              // Contains the states of the customized push
-    };
-    typedef struct package Package;
-    Package Data;                       // Data: Instance of Struct Package
+    QURPacketRing<RF_RING_SIZE, QUR_PACKET_MAX> Ring;   // Ring: Packets received and not decoded
+    bool ByInterrupt = false;           // ByInterrupt: The IRQ drains the radio (if not ReadData polls it)
+    QURCommand Data;                    // Data: Last command of the RF-Controller (QURPacket.h, shared with the controller)
+    QURPacketReader Reader;             // Reader: Checks the packets (version, CRC, sequence) and decodes them
+    bool JointsReceived = false;        // JointsReceived: A packet with the joints updated Data.Joints
+    uint16_t Received = 0;              // Received: Number of packets readed (wraps)
+    QURStatus Status;                   // Status: State of the robot for the controller (QURPacket.h)
+    QURPacketWriter StatusWriter;       // StatusWriter: Encodes the Status (his own sequence)
+    uint16_t Answered = 0;              // Answered: Received when the last Status was loaded
+    uint32_t LastRead = 0;              // LastRead: micros() of the last call of the RF task
     void Start();                       // Start: Function that initialize the RFController
-    void ReadData();                    // ReadData: Function thats do a Read from the RF-Control and save them into the Struct Data.
+    void Drain();                       // Drain: Moves the packets of the radio into the Ring (RF interrupt)
+    void ReadData();                    // ReadData: Decodes the packets of the Ring into Data
+    void Answer();                      // Answer: Loads the Status as the ACK payload of the next command
   };
 
   // ---------------------------------------------------------------------------
-  // STRUCT TO CONTROL TIMES
-  // This Struct serves to make timers without delay funcions, only using 
-  // the millins() funtion
-  // Methods:
-  //      - bool BackgroundTime()
-  //      - void SetTimer(int)
+  // STRUCT FOR THE GAIT PLAYER
+  // Plays a gait stored in the flash (QURGait.h), the frames are streamed
+  // into the motion queue with his duration while it has space.
   // ---------------------------------------------------------------------------
-  typedef struct TIMES
+  struct GAIT_PLAYER
   {
-    int TimeInitial = 0;    // This is the time reference when the timer initialize
-    int TimeFinal = 0;      // This is the time in microseconds when the timer is going to end
-    bool BackgroundTime();  // Backgroundtime: Return a boolean value if the timer is not ended (true if is ended or false if not)
-    void SetTimer(int);     // SetTimer: Read a int argument that is the end time, and initialize the counter.
+    GaitReader Reader;          // Reader: Decoder of the frames in PROGMEM
+    bool Playing = false;       // Playing: The player is sending frames
+    uint8_t Cycles = 0;         // Cycles: Cycles remaining (0 = forever)
   };
 
-  #ifdef MODULESD == true
+  #if PCLINK
     // ---------------------------------------------------------------------------
-    // STRUCT FOR RF COMUNICATION
-    // Contains the functions to manage and read data from the Desktop application
-    // and the control to comunicate with the Module SD
+    // STRUCT FOR PC COMUNICATION
+    // Contains the functions to read the frames of the Desktop application
+    // (QURPCLink.h). The bytes received are fed to the Parser as they are in
+    // the RX buffer, the Routine never waits the end of a frame. After every
+    // batch of frames the robot answers with his State (if the TX buffer has
+    // space, if not in the next period), also when the motion queue frees a
+    // keyframe (a planner sends the next one) and every PCLINK_STATE periods.
     // Methods:
-    //      - 
+    //      - Start()
+    //      - Answer(QURHexapod *)
     // ---------------------------------------------------------------------------
     typedef struct PCDRIVER
     {
-      
+      QURPCParser Parser;               // Parser: Decodes the frames of the PC one byte at a time
+      QURPCWriter Writer;               // Writer: Encodes the State (his own sequence)
+      uint16_t Received = 0;            // Received: Frames received (wraps)
+      uint16_t Refused = 0;             // Refused: Setpoints not applied (mode AUTOMATIC, walking or queue full)
+      uint16_t Answered = 0;            // Answered: Received when the last State was sent
+      uint8_t Periods = 0;              // Periods: Calls of TaskPCLink since the last State
+      uint8_t Space = 0;                // Space: Space of the motion queue in the last State
+      void Start();                     // Start: Opens the PCSerial
+      void Answer(QURHexapod *);        // Answer: Sends the State of the robot
     };
+    PCDRIVER PCdriver;
+  #endif
 
+  #if MODULESD
     // ---------------------------------------------------------------------------
     // STRUCT FOR COMUNICATION TO THE MODULESD
-    // Work in progress...
+    // Flight recorder: the tasks log what they did in the blocks of the
+    // Recorder and TaskRecorder sends the full blocks to the module. The
+    // setpoints and the joints are only logged when they changed.
+    // Methods:
+    //      - Start()
+    //      - LogPacket(int8_t, const QURCommand &, const QURPacketReader &, uint16_t)
+    //      - LogSetpoints(const int8_t[])
+    //      - LogJoints(const uint16_t[])
     // ---------------------------------------------------------------------------
     typedef struct ModuleSD
     {
-
+      QURRecorder Recorder;             // Recorder: Blocks of records waiting to be sent
+      int8_t Setpoint[__JOINTS__];      // Setpoint: Setpoints of the last records
+      uint16_t Pulse[__JOINTS__];       // Pulse: Pulses of the last records
+      uint32_t LastFlush = 0;           // LastFlush: micros() of the last call of TaskRecorder
+      uint16_t Gap = 0;                 // Gap: Longest time between two calls of TaskRecorder (loop stalls)
+      uint8_t Periods = 0;              // Periods: Calls of TaskRecorder since the last timing record
+      void Start();                     // Start: Opens the port of the module
+      void LogPacket(int8_t, const QURCommand &, const QURPacketReader &, uint16_t);  // LogPacket: Records a packet decoded
+      void LogSetpoints(const int8_t[]);  // LogSetpoints: Records the setpoints of the axis that changed
+      void LogJoints(const uint16_t[]);   // LogJoints: Records the pulses of the joints that changed
     };
     ModuleSD SDdriver;
   #endif
     
-  TIMES Timer;                // Timer: Instance of the Struct TIMES.
+  QURScheduler Scheduler;     // Scheduler: Runs the tasks of the Routine, every one at his own rate
   SERVO_DRIVER ServoDriver;   // ServoDriver: Instance of the Struct SERVO_DRIVER
   RF_DRIVER RFdriver;         // RFdriver: Instance of the RF_DRIVER
+  GAIT_PLAYER GaitPlayer;     // GaitPlayer: Instance of the GAIT_PLAYER
+  GaitGenerator Generator;    // Generator: Parametric gait (tripod, ripple, wave), steered by the RF-Controller
   
   bool All_Finished = false;  // All_Finished: Flag that indicates if all Servos are in their place
+  bool MotionByInterrupt = false;         // MotionByInterrupt: The motion timer is running (if not TaskServos interpolates)
+  static QURHexapod *Instance;            // Instance: Robot served by the interrupts (motion and RF)
+  static void MotionInterrupt();          // MotionInterrupt: Callback of the motion timer
+  static void RadioInterrupt();           // RadioInterrupt: Callback of the IRQ of the nRF24
+#if PROFILER
+  QURHistogram Profile[PROFILE_STAGES];   // Profile: Microseconds of every stage since his last frame
+  uint8_t ProfileStage = 0;               // ProfileStage: Next stage to send
+  uint8_t ProfileSequence = 0;            // ProfileSequence: Number of the next frame
+  uint16_t LastRoutine = 0;               // LastRoutine: micros() of the last call of Routine()
+#endif
 
-  int AnglesX[6] = {50,50,50,50,50,50};   // AnglesX: is the Setpoints of the Robot in Axis X 
-  int AnglesY[6] = {50,50,50,50,50,50};   // AnglesY: is the Setpoints of the Robot in Axis Y
+  int Angles[__SERVOS__][__LEGS__];       // Angles: is the Setpoints of the Robot per axis and leg, 50 at start (change them with SetAngleServo to mark the servo in Dirty)
+
+  // Tasks of the Routine, the argument is the instance of QURHexapod
+  static void TaskReadRF(void *);         // TaskReadRF: Reads the packets from the RF-Controller (only AUTOMATIC)
+  static void TaskSetpoints(void *);      // TaskSetpoints: Steps the gait generator and converts Angles into the setpoints of the servos
+  static void TaskServos(void *);         // TaskServos: Plans the next keyframe of the queue and checks if the servos finished (and interpolates them without motion timer)
+  static void TaskTelemetry(void *);      // TaskTelemetry: Sends the state of the robot to the PC
+  static void TaskGait(void *);           // TaskGait: Streams the frames of the gait into the motion queue
+  static void TaskProfile(void *);        // TaskProfile: Sends the histogram of one stage to the PC (only PROFILER)
+  static void TaskRecorder(void *);       // TaskRecorder: Records the timings and sends the log to the ModuleSD (only MODULESD)
+  static void TaskPCLink(void *);         // TaskPCLink: Reads the frames of the PC and applies them (only PCLINK)
 public:
-  QURHexapod(int [__SERVOS__][__LEGS__], int[__SERVOS__][__LEGS__]);
+#if __SERVOS__ > 2
+  QURHexapod(const int16_t (&)[2][__LEGS__], const int16_t (&)[2][__LEGS__], const int16_t (&)[2][__LEGS__]);
+#else
+  QURHexapod(const int16_t (&)[2][__LEGS__], const int16_t (&)[2][__LEGS__]);
+#endif
+  void Start();
+  void SetOutput(QURServoOutput *);
   void Routine();
   void SelectMode(bool);
   void SetAnglesLeg(int[], bool);
   void SetAngleServo(int, int, bool);
+  void SetAngleAxis(int, int, uint8_t);
   bool ServosFinished();
+  void SetProfile(int, int);
+  void SetProfileServo(int, int, int, bool);
+  void SetTrim(int, int, bool);
+  void SetCoordinated(bool, uint16_t = 0);
+  void SetKeyframe(int[], int[], uint16_t);
+  bool QueueKeyframe(int[], int[], uint16_t);
+  uint8_t QueueSpace();
+  void ClearQueue();
+  bool PlayGait(const uint8_t *, uint8_t = 0);
+  void StopGait();
+  bool GaitPlaying();
+  void StartWalk(uint8_t, uint16_t = GEN_CYCLE);
+  void StopWalk();
+  void SetWalkSpeed(uint16_t);
+  void SetStride(uint8_t, uint8_t);
+  void SetHeading(int);
+  void SetTurn(int8_t);
+  static void RamReport();
   void Debug(bool, int, int);
 };
 
@@ -0,0 +1,25 @@
+// ---------------------------------------------------------------------------
+// Debug messages of the Hexapod (QURDebug.h)
+//
+// The firmware only uses the number of the message (MESSAGE_*), the text is
+// used by Tools/DebugDecoder to print it again with his arguments. Add the
+// new messages at the end, the numbers of the old ones must not change
+// (captures of other builds). Arguments: %d %u %x %c are 16 bits, %ld %lu
+// %lx are 32 bits (long, unsigned long).
+// ---------------------------------------------------------------------------
+
+#ifndef QURMESSAGES_H
+#define QURMESSAGES_H
+
+#define QUR_MESSAGES(MESSAGE) \
+  MESSAGE(MESSAGE_SERVO_PIN,      "Leg %u / Axis %c / PIN: %u") \
+  MESSAGE(MESSAGE_SETPOINT,       "Setpoint %c leg %u -> %d") \
+  MESSAGE(MESSAGE_OUTPUT_SERVO,   "Servo output not available, using the Servo library") \
+  MESSAGE(MESSAGE_STARTED,        "Started: motion timer %u, RF interrupt %u, %u tasks") \
+  MESSAGE(MESSAGE_CALIBRATION,    "Tables of the servos: %u (1 = read from the EEPROM, 0 = built)")
+
+#define QUR_MESSAGE_ID(__ID__, __TEXT__) __ID__,
+enum QURMessage { QUR_MESSAGES(QUR_MESSAGE_ID) QUR_MESSAGE_COUNT };
+#undef QUR_MESSAGE_ID
+
+#endif
@@ -0,0 +1,79 @@
+// ---------------------------------------------------------------------------
+// See "QURMotionTimer.h" for the description of the motion timer.
+// ---------------------------------------------------------------------------
+
+#include "QURMotionTimer.h"
+
+#if defined(QUR_SIMULATOR)
+  #include <SimHardware.h>
+#endif
+
+static volatile MotionCallback MotionHandler = NULL;   // MotionHandler: Function called by the interrupt
+
+#if defined(__AVR__)
+
+/**
+  @Function MotionTimerStart
+  @purpuse Configure the Timer2 in CTC mode with the prescaler 1024 (15.625 kHz at 16 MHz)
+
+  @param __RATE__     Interrupts per second (62 to 15625 at 16 MHz)
+  @param __CALLBACK__ Function called in every interrupt
+  @return Returns true if the timer was configured
+*/
+bool MotionTimerStart(uint16_t __RATE__, MotionCallback __CALLBACK__){
+  uint32_t compare = (F_CPU / 1024UL) / __RATE__;
+  if(compare == 0 || compare > 256)
+    return false;
+  uint8_t oldSREG = SREG;
+  cli();
+  MotionHandler = __CALLBACK__;
+  TCCR2A = _BV(WGM21);                  // CTC mode, the counter restarts in OCR2A
+  TCCR2B = _BV(CS22) | _BV(CS21) | _BV(CS20);   // Prescaler 1024
+  OCR2A  = (uint8_t)(compare - 1);
+  TCNT2  = 0;
+  TIMSK2 |= _BV(OCIE2A);                // Enable the interrupt of compare A
+  SREG = oldSREG;
+  return true;
+}
+
+/**
+  @Function MotionTimerStop
+  @purpuse Disable the interrupt of the Timer2
+*/
+void MotionTimerStop(){
+  TIMSK2 &= ~_BV(OCIE2A);
+  MotionHandler = NULL;
+}
+
+ISR(TIMER2_COMPA_vect){
+  // The interrupts are enabled again so the Servo pulses (Timer5/Timer1) keep their precision,
+  // this interrupt is masked meanwhile so it can't nest with itself
+  TIMSK2 &= ~_BV(OCIE2A);
+  sei();
+  MotionCallback handler = MotionHandler;
+  if(handler)
+    handler();
+  cli();
+  if(MotionHandler)
+    TIMSK2 |= _BV(OCIE2A);
+}
+
+#elif defined(QUR_SIMULATOR)
+
+bool MotionTimerStart(uint16_t __RATE__, MotionCallback __CALLBACK__){
+  MotionHandler = __CALLBACK__;
+  SimTimer::Attach(1000000UL / __RATE__, __CALLBACK__);
+  return true;
+}
+
+void MotionTimerStop(){
+  SimTimer::Detach();
+  MotionHandler = NULL;
+}
+
+#else
+
+bool MotionTimerStart(uint16_t, MotionCallback){ return false; }
+void MotionTimerStop(){}
+
+#endif
@@ -0,0 +1,31 @@
+// ---------------------------------------------------------------------------
+// Motion timer of the Hexapod Quantum robotics Library
+//
+// BACKGROUND:
+// Periodic hardware interrupt that drives the interpolation of the servos
+// (see QURHexapod -> SERVO_DRIVER::BackgroundProcess), so the speed of the
+// robot doesn't depend on how fast loop() runs.
+//
+//   * AVR (Mega / 328p): Timer2 in CTC mode. The Servo library uses the
+//     Timer5/1/3/4 in the Mega and the Timer1 in the 328p, so the Timer2 is
+//     free (tone() can't be used with the Hexapod).
+//   * Host Simulator: virtual timer that fires while the virtual clock advances.
+//   * Others (Due): not available, MotionTimerStart returns false and the
+//     QURHexapod runs the interpolation from his Routine.
+//
+// METHODS:
+//   MotionTimerStart(__RATE__, __CALLBACK__) - Calls __CALLBACK__ __RATE__ times per second (interrupt context)
+//   MotionTimerStop()                        - Stops the interrupt
+// ---------------------------------------------------------------------------
+
+#ifndef QURMOTIONTIMER_H
+#define QURMOTIONTIMER_H
+
+#include <Arduino.h>
+
+typedef void (*MotionCallback)();
+
+bool MotionTimerStart(uint16_t, MotionCallback);
+void MotionTimerStop();
+
+#endif
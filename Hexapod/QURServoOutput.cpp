@@ -0,0 +1,361 @@
+// ---------------------------------------------------------------------------
+// See "QURServoOutput.h" for the description of the servo outputs.
+// ---------------------------------------------------------------------------
+
+#include "QURServoOutput.h"
+
+#if defined(QUR_SIMULATOR)
+  #include <SimHardware.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Methods for QURServoOutput
+//       - Set(uint8_t __CHANNEL__, uint16_t __MICROS__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURServoOutput
+  @Function Set
+  @purpuse Stages the pulse of a channel, nothing is sent until Latch()
+
+  @param __CHANNEL__ Channel (0 to SERVO_CHANNELS - 1)
+  @param __MICROS__  Pulse in microseconds
+*/
+void QURServoOutput::Set(uint8_t __CHANNEL__, uint16_t __MICROS__){
+  Pulses[__CHANNEL__] = __MICROS__;
+  Changed |= (joint_mask_t)1 << __CHANNEL__;
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURServoLibrary
+//       - Begin()
+//       - Attach(uint8_t __CHANNEL__, uint8_t __PIN__)
+//       - Latch()
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURServoLibrary
+  @Function Begin
+  @purpuse The Servo library works in every board
+
+  @return Returns true
+*/
+bool QURServoLibrary::Begin(){
+  return true;
+}
+
+/**
+  @Struct QURServoLibrary
+  @Function Attach
+  @purpuse Attach the Servo of the channel to his pin
+
+  @param __CHANNEL__ Channel (0 to SERVO_CHANNELS - 1)
+  @param __PIN__     Pin of the servo
+*/
+void QURServoLibrary::Attach(uint8_t __CHANNEL__, uint8_t __PIN__){
+  Control[__CHANNEL__].attach(__PIN__);
+}
+
+/**
+  @Struct QURServoLibrary
+  @Function Latch
+  @purpuse Writes the pulses staged, one channel at a time (the library sends
+       every channel in his own slot of the frame)
+*/
+void QURServoLibrary::Latch(){
+  joint_mask_t changed = Changed;
+  Changed = 0;
+  for(uint8_t x = 0; changed; x++, changed >>= 1){   // Cicle with a iterator 'x' that go over each channel staged
+    if(changed & 1)
+      Control[x].writeMicroseconds(Pulses[x]);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURTimerOutput
+//       - Begin()
+//       - Attach(uint8_t __CHANNEL__, uint8_t __PIN__)
+//       - Latch()
+// ---------------------------------------------------------------------------
+
+QURTimerOutput::QURTimerOutput(){
+  for(uint8_t x = 0; x < SERVO_CHANNELS; x++)
+    Pins[x] = 0xFF;
+}
+
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+
+#define PWM_TICKS_US  (F_CPU / 8000000UL)         // Ticks of the Timer4 per microsecond (prescaler 8)
+
+// Falling edge of a channel, the schedule is sorted by Ticks
+struct PwmEdge
+{
+  uint16_t Ticks;                 // Ticks: Time of the edge since the start of the frame
+  volatile uint8_t *Port;         // Port: Output register of the pin
+  uint8_t Mask;                   // Mask: Bit of the pin
+};
+
+static PwmEdge PwmNext[SERVO_CHANNELS];           // PwmNext: Schedule of the next frame (written by Latch)
+static PwmEdge PwmActive[SERVO_CHANNELS];         // PwmActive: Schedule of the frame in progress (only the interrupts)
+static volatile uint8_t PwmNextCount = 0;
+static uint8_t PwmActiveCount = 0;
+static uint8_t PwmIndex = 0;                      // PwmIndex: Next edge of PwmActive
+static volatile bool PwmPending = false;          // PwmPending: PwmNext has a new frame
+
+/**
+  @Struct QURTimerOutput
+  @Function Begin
+  @purpuse Configure the Timer4 in CTC mode (TOP = ICR4) with the prescaler 8,
+       the interrupt of the capture (TOP) starts every frame
+
+  @return Returns true
+*/
+bool QURTimerOutput::Begin(){
+  uint8_t oldSREG = SREG;
+  cli();
+  TCCR4A = 0;
+  TCCR4B = _BV(WGM43) | _BV(WGM42) | _BV(CS41);   // CTC mode 12, prescaler 8
+  ICR4   = (uint16_t)(SERVO_FRAME * PWM_TICKS_US - 1);
+  TCNT4  = 0;
+  TIFR4  = _BV(ICF4) | _BV(OCF4B);
+  TIMSK4 = _BV(ICIE4);                            // Start of every frame
+  SREG = oldSREG;
+  return true;
+}
+
+/**
+  @Struct QURTimerOutput
+  @Function Attach
+  @purpuse Configure the pin of the channel as output (low until the first Latch)
+
+  @param __CHANNEL__ Channel (0 to SERVO_CHANNELS - 1)
+  @param __PIN__     Pin of the servo
+*/
+void QURTimerOutput::Attach(uint8_t __CHANNEL__, uint8_t __PIN__){
+  Pins[__CHANNEL__] = __PIN__;
+  digitalWrite(__PIN__, LOW);
+  pinMode(__PIN__, OUTPUT);
+}
+
+/**
+  @Struct QURTimerOutput
+  @Function Latch
+  @purpuse Builds the schedule of the next frame with the pulses of all the
+       channels (sorted by time) and gives it to the interrupt, that swaps it
+       at the start of the frame
+*/
+void QURTimerOutput::Latch(){
+  if(!Changed)
+    return;
+  Changed = 0;
+  PwmEdge schedule[SERVO_CHANNELS];
+  uint8_t count = 0;
+  for(uint8_t x = 0; x < SERVO_CHANNELS; x++){            // Cicle with a iterator 'x' that go over each channel
+    if(Pins[x] == 0xFF)
+      continue;
+    PwmEdge edge;
+    edge.Ticks = Pulses[x] * PWM_TICKS_US;
+    edge.Port  = portOutputRegister(digitalPinToPort(Pins[x]));
+    edge.Mask  = digitalPinToBitMask(Pins[x]);
+    uint8_t y = count++;
+    while(y > 0 && schedule[y - 1].Ticks > edge.Ticks){  // Insertion sort, they are only 12
+      schedule[y] = schedule[y - 1];
+      y--;
+    }
+    schedule[y] = edge;
+  }
+  uint8_t oldSREG = SREG;
+  cli();
+  for(uint8_t x = 0; x < count; x++)
+    PwmNext[x] = schedule[x];
+  PwmNextCount = count;
+  PwmPending   = true;
+  SREG = oldSREG;
+}
+
+// Start of the frame: swaps the schedule and puts all the pins up
+ISR(TIMER4_CAPT_vect){
+  if(PwmPending){
+    for(uint8_t x = 0; x < PwmNextCount; x++)
+      PwmActive[x] = PwmNext[x];
+    PwmActiveCount = PwmNextCount;
+    PwmPending = false;
+  }
+  if(!PwmActiveCount)
+    return;
+  for(uint8_t x = 0; x < PwmActiveCount; x++)
+    *PwmActive[x].Port |= PwmActive[x].Mask;
+  PwmIndex = 0;
+  OCR4B  = PwmActive[0].Ticks;
+  TIFR4  = _BV(OCF4B);
+  TIMSK4 |= _BV(OCIE4B);
+}
+
+// Falling edges: every pin whose time arrived goes down, then the next compare
+ISR(TIMER4_COMPB_vect){
+  while(PwmIndex < PwmActiveCount){
+    PwmEdge &edge = PwmActive[PwmIndex];
+    if((int16_t)(edge.Ticks - TCNT4) > 0){                // Not yet: wait the compare
+      OCR4B = edge.Ticks;
+      if((int16_t)(edge.Ticks - TCNT4) > 0)               // The compare is in the future, it will fire
+        return;
+      continue;                                           // The counter passed it meanwhile
+    }
+    *edge.Port &= ~edge.Mask;
+    PwmIndex++;
+  }
+  TIMSK4 &= ~_BV(OCIE4B);
+}
+
+#elif defined(QUR_SIMULATOR)
+
+bool QURTimerOutput::Begin(){ return true; }
+
+void QURTimerOutput::Attach(uint8_t __CHANNEL__, uint8_t __PIN__){
+  Pins[__CHANNEL__] = __PIN__;
+  SimServo::Attach(__PIN__, true);
+}
+
+// All the channels are recorded in the same virtual time (the same frame)
+void QURTimerOutput::Latch(){
+  joint_mask_t changed = Changed;
+  Changed = 0;
+  for(uint8_t x = 0; changed; x++, changed >>= 1){
+    if((changed & 1) && Pins[x] != 0xFF)
+      SimServo::Record(Pins[x], Pulses[x]);
+  }
+}
+
+#else
+
+bool QURTimerOutput::Begin(){ return false; }
+void QURTimerOutput::Attach(uint8_t __CHANNEL__, uint8_t __PIN__){ Pins[__CHANNEL__] = __PIN__; }
+void QURTimerOutput::Latch(){ Changed = 0; }
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Methods for QURPCA9685
+//       - Begin()
+//       - Attach(uint8_t __CHANNEL__, uint8_t __PIN__)
+//       - Latch()
+//       - WriteRegister(uint8_t __DEVICE__, uint8_t __REGISTER__, uint8_t __VALUE__)
+// ---------------------------------------------------------------------------
+
+QURPCA9685::QURPCA9685(uint8_t __ADDRESS__){
+  Address = __ADDRESS__;
+  for(uint8_t x = 0; x < SERVO_CHANNELS; x++)
+    Counts[x] = 0xFFFF;
+}
+
+/**
+  @Struct QURPCA9685
+  @Function WriteRegister
+  @purpuse Writes one register of an expander
+
+  @param __DEVICE__   Expander (0 to PCA9685_DEVICES - 1, address Address + __DEVICE__)
+  @param __REGISTER__ Register
+  @param __VALUE__    Value
+  @return Returns true if the expander acknowledged
+*/
+bool QURPCA9685::WriteRegister(uint8_t __DEVICE__, uint8_t __REGISTER__, uint8_t __VALUE__){
+  Wire.beginTransmission(Address + __DEVICE__);
+  Wire.write(__REGISTER__);
+  Wire.write(__VALUE__);
+  return Wire.endTransmission() == 0;
+}
+
+/**
+  @Struct QURPCA9685
+  @Function Begin
+  @purpuse Starts the I2C bus at 400 kHz and configures the expanders: 50 Hz
+       (the PRESCALE is written sleeping), auto-increment and totem pole outputs
+
+  @return Returns false if an expander doesn't answer
+*/
+bool QURPCA9685::Begin(){
+  Wire.begin();
+  Wire.setClock(400000UL);
+#if defined(WIRE_HAS_TIMEOUT)
+  Wire.setWireTimeout(PCA9685_TIMEOUT, true);   // A stuck bus is reset, Latch never waits forever in the interrupt
+#endif
+  for(uint8_t x = 0; x < PCA9685_DEVICES; x++){  // Cicle with a iterator 'x' that go over each expander
+    if(!WriteRegister(x, PCA9685_MODE1, PCA9685_SLEEP))
+      return false;
+    WriteRegister(x, PCA9685_PRESCALE, PCA9685_PRESCALER);
+    WriteRegister(x, PCA9685_MODE2, PCA9685_OUTDRV);
+    WriteRegister(x, PCA9685_MODE1, PCA9685_AI);
+  }
+  delayMicroseconds(500);                       // The oscillators need 500 us to start
+  for(uint8_t x = 0; x < PCA9685_DEVICES; x++)
+    if(!WriteRegister(x, PCA9685_MODE1, PCA9685_RESTART | PCA9685_AI))
+      return false;
+  return true;
+}
+
+/**
+  @Struct QURPCA9685
+  @Function Attach
+  @purpuse The channels are the outputs of the expander, the pin is not used
+
+  @param __CHANNEL__ Channel (0 to SERVO_CHANNELS - 1)
+  @param __PIN__     Not used
+*/
+void QURPCA9685::Attach(uint8_t __CHANNEL__, uint8_t __PIN__){
+  (void)__CHANNEL__;
+  (void)__PIN__;
+}
+
+/**
+  @Struct QURPCA9685
+  @Function Latch
+  @purpuse Converts the pulses staged into counts of the PWM (4096 per frame)
+       and writes the channels from the first to the last that changed in
+       bursts of PCA9685_BURST channels (ON = 0, OFF = count), a burst never
+       crosses from an expander to the other. The bursts
+       are joined with a repeated START, the only STOP is after the last
+       one so the expander applies all the channels together. If a burst
+       fails (timeout or NACK) the rest are not sent and every channel of
+       the frame is sent again in the next Latch
+*/
+void QURPCA9685::Latch(){
+  joint_mask_t changed = Changed;
+  Changed = 0;
+  int8_t first = -1, last = -1;
+  for(uint8_t x = 0; changed; x++, changed >>= 1){       // Cicle with a iterator 'x' that go over each channel staged
+    if(!(changed & 1))
+      continue;
+    // Ticks of 1 / (25 MHz / (PRESCALE + 1)) = (PRESCALE + 1) / 25 microseconds
+    uint16_t count = (uint16_t)(((uint32_t)Pulses[x] * (PCA9685_OSCILLATOR / 1000000UL) + (PCA9685_PRESCALER + 1) / 2) / (PCA9685_PRESCALER + 1));
+    if(count > 4095) count = 4095;
+    if(count == Counts[x])                          // Same count, the resolution is ~4.9 us
+      continue;
+    Counts[x] = count;
+    if(first < 0) first = x;
+    last = x;
+  }
+  for(int8_t channel = first; first >= 0 && channel <= last; ){
+    uint8_t device = channel / PCA9685_OUTPUTS;
+    uint8_t end = channel + PCA9685_BURST - 1 < last ? channel + PCA9685_BURST - 1 : last;
+    if(end / PCA9685_OUTPUTS != device)             // The rest goes to the next expander
+      end = device * PCA9685_OUTPUTS + PCA9685_OUTPUTS - 1;
+    Wire.beginTransmission(Address + device);
+    Wire.write((uint8_t)(PCA9685_LED0_ON_L + 4 * (channel % PCA9685_OUTPUTS)));
+    for(uint8_t x = channel; x <= end; x++){
+      uint16_t count = Counts[x] == 0xFFFF ? 0 : Counts[x];
+      Wire.write((uint8_t)0);                       // ON = 0: all the channels go up together
+      Wire.write((uint8_t)0);
+      Wire.write((uint8_t)count);
+      Wire.write((uint8_t)(count >> 8));
+    }
+    if(Wire.endTransmission(end == last) != 0){     // STOP only after the last burst (the outputs change on it)
+      for(uint8_t x = first; x <= last; x++){         // Cicle with a iterator 'x' that go over each channel of the frame
+        Counts[x] = 0xFFFF;
+        Changed |= (joint_mask_t)1 << x;
+      }
+      Errors++;
+      return;
+    }
+    channel = end + 1;
+  }
+}
@@ -0,0 +1,144 @@
+// ---------------------------------------------------------------------------
+// Servo outputs of the Hexapod Quantum robotics Library
+//
+// BACKGROUND:
+// The motion engine (QURHexapod -> SERVO_DRIVER) doesn't write the servos one
+// by one, it stages the pulse of every servo that changed with Set() and at
+// the end of every interpolation publishes all of them together with Latch().
+// So every output can send the whole frame in the cheapest way of his
+// hardware and the legs never move with the pulses of different frames.
+//
+//   * QURServoLibrary (DEFAULT): Arduino Servo library, one write per servo.
+//     Works in every board, a Servo object per joint.
+//   * QURTimerOutput: Timer4 of the Mega in CTC mode (20 ms frame, 0.5 us
+//     resolution). All the pins go up at the start of the frame and every
+//     pin goes down at his compare, the new pulses are swapped in only at
+//     the start of a frame so the 12 channels latch in the same frame. It
+//     replaces the Servo library (don't attach Servo objects with it), the
+//     PWM of analogWrite on the pins 6, 7 and 8 is lost. Other boards: not
+//     available, Begin() returns false and QURHexapod uses QURServoLibrary.
+//   * QURPCA9685: PCA9685 I2C PWM expander (16 channels, 50 Hz, ~4.9 us of
+//     resolution). The registers of consecutive channels are written in
+//     burst transactions with auto-increment. The Wire buffer (BUFFER_LENGTH,
+//     32 bytes in AVR and Due) limits a burst to PCA9685_BURST channels, 12
+//     channels are 2 bursts: they are joined with a repeated START and only
+//     the last one ends with a STOP. The expander (OCH = 0) applies every
+//     register written on that STOP, so all the channels start in the same
+//     PWM cycle. A robot of more than 16 joints uses two expanders, the
+//     second one (Address + 1) has the channels 16 to 31.
+//     Latch() runs in the motion interrupt, QURMotionTimer enables the
+//     interrupts inside it so Wire can work. The bus has a timeout
+//     (PCA9685_TIMEOUT, setWireTimeout of the cores that have it), a stuck
+//     SDA resets the bus instead of freezing the robot in the interrupt and
+//     the channels are sent again in the next Latch.
+//
+// In the Host Simulator QURTimerOutput records the pulses in SimServo and the
+// Wire mock has a PCA9685 model (SimI2C).
+//
+// USE:
+//   QURPCA9685 Expander(0x40);
+//   Robot.SetOutput(&Expander);    // Before Robot.Start()
+//
+// METHODS:
+//   Output.Begin()                 - Starts the hardware, returns false if it can't be used in this board
+//   Output.Attach(_CHANNEL, _PIN)  - Connects a channel to a pin (the PCA9685 uses his own outputs)
+//   Output.Set(_CHANNEL, _MICROS)  - Stages the pulse of a channel for the next Latch()
+//   Output.Latch()                 - Publishes the pulses staged since the last Latch() together
+// ---------------------------------------------------------------------------
+
+#ifndef QURSERVOOUTPUT_H
+#define QURSERVOOUTPUT_H
+
+#include <Arduino.h>
+#include <Servo.h>
+#include <Wire.h>
+#include "QURGeometry.h"
+
+// Channels of an output: one per joint, at least the 16 outputs of a PCA9685
+#define SERVO_CHANNELS  (__LEGS__ * __SERVOS__ > 16 ? __LEGS__ * __SERVOS__ : 16)
+#define SERVO_FRAME     20000UL     // Microseconds of a frame of the servos (50 Hz)
+// Servo objects of QURServoLibrary, one per joint (the library reserves one slot per object
+// and drives 12 per timer: the Mega has 48 slots, more than 12 joints also take the Timer1)
+#define SERVO_LIBRARY_CHANNELS  (__LEGS__ * __SERVOS__)
+#if defined(MAX_SERVOS)
+static_assert(SERVO_LIBRARY_CHANNELS <= MAX_SERVOS, "The Servo library of this board can't drive every joint, use QURTimerOutput or QURPCA9685");
+#endif
+
+// ---------------------------------------------------------------------------
+// PCA9685 DEFINE'S
+// ---------------------------------------------------------------------------
+#define PCA9685_MODE1       0x00
+#define PCA9685_MODE2       0x01
+#define PCA9685_LED0_ON_L   0x06    // First register of the channel 0, every channel has 4 (ON_L, ON_H, OFF_L, OFF_H)
+#define PCA9685_PRESCALE    0xFE
+#define PCA9685_RESTART     0x80    // MODE1: Restart the PWM after the sleep
+#define PCA9685_AI          0x20    // MODE1: Auto-increment of the register
+#define PCA9685_SLEEP       0x10    // MODE1: Oscillator off (the PRESCALE can only be written sleeping)
+#define PCA9685_OUTDRV      0x04    // MODE2: Totem pole outputs (OCH = 0, the outputs change on STOP)
+#define PCA9685_OSCILLATOR  25000000UL  // Internal oscillator of the PCA9685 in Hz
+#define PCA9685_PRESCALER   ((uint8_t)((PCA9685_OSCILLATOR + 2048UL * (1000000UL / SERVO_FRAME)) / (4096UL * (1000000UL / SERVO_FRAME)) - 1))
+#ifndef BUFFER_LENGTH
+  #define BUFFER_LENGTH 32
+#endif
+#define PCA9685_BURST       ((BUFFER_LENGTH - 1) / 4)   // Channels per transaction (the register address + 4 bytes per channel)
+#define PCA9685_OUTPUTS     16      // Channels of an expander, the channels 16 to 31 are in a second one (Address + 1)
+#define PCA9685_DEVICES     ((SERVO_CHANNELS + PCA9685_OUTPUTS - 1) / PCA9685_OUTPUTS)
+#define PCA9685_TIMEOUT     2000    // Microseconds of a transaction before the bus is reset (a frame of 12 channels takes ~1.4 ms at 400 kHz)
+
+// ---------------------------------------------------------------------------
+// Interface of the servo outputs
+// ---------------------------------------------------------------------------
+class QURServoOutput
+{
+public:
+  virtual bool Begin() = 0;                 // Begin: Starts the hardware, false if this board can't use it
+  virtual void Attach(uint8_t, uint8_t) = 0;    // Attach: Connects a channel to a pin
+  void Set(uint8_t, uint16_t);              // Set: Pulse of a channel in microseconds for the next Latch
+  virtual void Latch() = 0;                 // Latch: Publishes the pulses changed since the last Latch
+protected:
+  uint16_t Pulses[SERVO_CHANNELS];          // Pulses: Last pulse of every channel in microseconds
+  joint_mask_t Changed = 0;                 // Changed: Bit of every channel staged since the last Latch
+};
+
+// ---------------------------------------------------------------------------
+// Arduino Servo library (DEFAULT)
+// ---------------------------------------------------------------------------
+class QURServoLibrary : public QURServoOutput
+{
+  Servo Control[SERVO_LIBRARY_CHANNELS];    // Control: Is the instancie of the Servo of every channel
+public:
+  bool Begin();
+  void Attach(uint8_t, uint8_t);
+  void Latch();
+};
+
+// ---------------------------------------------------------------------------
+// Hardware timer PWM (Timer4 of the Mega)
+// ---------------------------------------------------------------------------
+class QURTimerOutput : public QURServoOutput
+{
+  uint8_t Pins[SERVO_CHANNELS];             // Pins: Pin of every channel (0xFF = not attached)
+public:
+  QURTimerOutput();
+  bool Begin();
+  void Attach(uint8_t, uint8_t);
+  void Latch();
+};
+
+// ---------------------------------------------------------------------------
+// PCA9685 I2C PWM expander
+// ---------------------------------------------------------------------------
+class QURPCA9685 : public QURServoOutput
+{
+  uint8_t Address;                          // Address: I2C address of the expander (DEFAULT: 0x40), the second one is Address + 1
+  uint16_t Counts[SERVO_CHANNELS];          // Counts: Last OFF count sent to every channel (0xFFFF = never)
+  bool WriteRegister(uint8_t, uint8_t, uint8_t);
+public:
+  uint16_t Errors = 0;                      // Errors: Latches that the bus didn't finish (timeout or NACK), sent again in the next Latch
+  QURPCA9685(uint8_t = 0x40);
+  bool Begin();
+  void Attach(uint8_t, uint8_t);
+  void Latch();
+};
+
+#endif
@@ -0,0 +1,70 @@
+// ---------------------------------------------------------------------------
+// See "QURDebug.h" for the format of the messages.
+// ---------------------------------------------------------------------------
+
+#include "QURDebug.h"
+
+QURDebugger QURDebug;
+
+// ---------------------------------------------------------------------------
+// Methods for QURDebugFrame
+//       - QURDebugFrame(uint8_t __LEVEL__, uint8_t __MESSAGE__)
+//       - Add16(uint16_t __VALUE__)
+// ---------------------------------------------------------------------------
+
+QURDebugFrame::QURDebugFrame(uint8_t __LEVEL__, uint8_t __MESSAGE__){
+  Bytes[QUR_PC_HEADER]     = __LEVEL__;
+  Bytes[QUR_PC_HEADER + 1] = __MESSAGE__;
+  Length = QUR_PC_HEADER + 2;
+}
+
+void QURDebugFrame::Add16(uint16_t __VALUE__){
+  if(Length + 2 > QUR_DEBUG_FRAME_MAX - 1)        // The CRC needs the last byte
+    return;
+  Bytes[Length++] = (uint8_t)__VALUE__;
+  Bytes[Length++] = (uint8_t)(__VALUE__ >> 8);
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURDebugger
+//       - Begin(HardwareSerial &__PORT__)
+//       - Send(QURDebugFrame &__FRAME__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURDebugger
+  @Function Begin
+  @purpuse Selects the port of the messages, it must be open (begin)
+
+  @param __PORT__ Serial port (the PCSerial of the robot)
+*/
+void QURDebugger::Begin(HardwareSerial &__PORT__){
+  Port = &__PORT__;
+}
+
+/**
+  @Struct QURDebugger
+  @Function Send
+  @purpuse Writes the header and the CRC of the message and sends it encoded
+       (COBS) if the TX buffer has space for the whole frame, if not the
+       message is dropped and his sequence is lost (never waits, except Wait)
+
+  @param __FRAME__ Message with his arguments
+*/
+void QURDebugger::Send(QURDebugFrame &__FRAME__){
+  if(Port == NULL)
+    return;
+  uint8_t *bytes = __FRAME__.Bytes;
+  bytes[0] = QUR_PC_LOG;
+  bytes[1] = (uint8_t)Sequence;
+  bytes[2] = (uint8_t)(Sequence >> 8);
+  Sequence++;
+  bytes[__FRAME__.Length] = QURCrc8(bytes, __FRAME__.Length);
+  uint8_t wire[QUR_DEBUG_FRAME_MAX + 2];
+  uint8_t length = QURCobsEncode(bytes, __FRAME__.Length + 1, wire);
+  if(!Wait && Port->availableForWrite() < length){
+    if(Dropped < 0xFFFF) Dropped++;
+    return;
+  }
+  Port->write(wire, length);
+}
@@ -0,0 +1,85 @@
+// ---------------------------------------------------------------------------
+// Debug messages Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Before it the firmware printed the debug as text, building a String (heap)
+// in every call even when the debug was off. Now a message is a number (the
+// text stays in the PC) and his arguments in binary: the firmware only copies
+// a few bytes into a frame of the PC link (QURPCLink.h, type QUR_PC_LOG), and
+// Tools/DebugDecoder writes the text again with the table of the messages.
+// The firmware chooses a level when it is compiled (DEBUG_LEVEL), the calls
+// of the levels above it are macros without code (see QURHexapod.h), so a
+// message in the hot path costs nothing if it is off and a few microseconds
+// if it is on. A message never waits the serial port: if the TX buffer has no
+// space it is dropped (the sequence tells the decoder), except with Wait
+// (setup(), where nothing runs yet).
+//
+// FRAME (QUR_PC_LOG, before COBS):
+//   [0] QUR_PC_LOG  [1-2] Sequence  [3] Level  [4] Message  [5..] Arguments  [last] CRC8
+//   Every argument is 16 bits (char, bool, int, uint8_t, ...), long and
+//   unsigned long are 32 bits: in the text %d %u %x %c are 16 bits, %ld %lu %lx 32 bits
+//
+// USE:
+//   QURDebug.Begin(Serial);
+//   QURDebug.Log(DEBUG_LEVEL_INFO, MESSAGE_SERVO_PIN, leg, axis, pin);
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURDEBUG_H
+#define QURDEBUG_H
+
+#include <Arduino.h>
+#include "QURPCLink.h"
+
+// Levels of the messages
+#define DEBUG_LEVEL_NONE      0           // Nothing is sent
+#define DEBUG_LEVEL_ERROR     1           // The robot can't do something
+#define DEBUG_LEVEL_WARNING   2           // The robot works in other way (fallbacks)
+#define DEBUG_LEVEL_INFO      3           // Configuration and events (setup)
+#define DEBUG_LEVEL_TRACE     4           // Every step of the Routine (hot path)
+
+#define QUR_DEBUG_ARGUMENTS   12          // Bytes of the arguments of a message
+#define QUR_DEBUG_FRAME_MAX   (QUR_PC_HEADER + 2 + QUR_DEBUG_ARGUMENTS + 1)
+
+// ---------------------------------------------------------------------------
+// Message in construction, the arguments are written one by one
+// ---------------------------------------------------------------------------
+struct QURDebugFrame
+{
+  uint8_t Bytes[QUR_DEBUG_FRAME_MAX];   // Bytes: Frame before the COBS (the header is written by Send)
+  uint8_t Length;                       // Length: Bytes written
+  QURDebugFrame(uint8_t, uint8_t);      // Level and Message
+  void Add16(uint16_t);                 // Add16: Adds 16 bits (ignored if the arguments are full)
+  void Add(long __VALUE__)          { Add16((uint16_t)__VALUE__); Add16((uint16_t)((unsigned long)__VALUE__ >> 16)); }
+  void Add(unsigned long __VALUE__) { Add16((uint16_t)__VALUE__); Add16((uint16_t)(__VALUE__ >> 16)); }
+  template <typename T> void Add(T __VALUE__) { Add16((uint16_t)__VALUE__); }
+};
+
+// ---------------------------------------------------------------------------
+// Sends the messages to a serial port
+// Methods:
+//      - void Begin(HardwareSerial &)
+//      - void Send(QURDebugFrame &)
+//      - void Log(uint8_t, uint8_t, ...)
+// ---------------------------------------------------------------------------
+struct QURDebugger
+{
+  HardwareSerial *Port = NULL;          // Port: Serial of the messages (NULL = nothing is sent)
+  uint16_t Sequence = 0;                // Sequence: Number of the next message (wraps)
+  uint16_t Dropped = 0;                 // Dropped: Messages without space in the TX buffer (saturates)
+  bool Wait = false;                    // Wait: The messages wait for space (only in setup())
+  void Begin(HardwareSerial &);         // Begin: Selects the port (already open)
+  void Send(QURDebugFrame &);           // Send: Closes the frame and writes it if it fits
+  template <typename... A> void Log(uint8_t __LEVEL__, uint8_t __MESSAGE__, A... __ARGUMENTS__){
+    QURDebugFrame frame(__LEVEL__, __MESSAGE__);
+    int expand[] = {0, (frame.Add(__ARGUMENTS__), 0)...};   // Cicle over each ARGUMENT (in order)
+    (void)expand;
+    Send(frame);
+  }
+};
+
+extern QURDebugger QURDebug;
+
+#endif
@@ -0,0 +1,90 @@
+// ---------------------------------------------------------------------------
+// See "QURLCDLink.h" for the format of the frames.
+// ---------------------------------------------------------------------------
+
+#include "QURLCDLink.h"
+#include "QURPacket.h"
+
+// Header and CRC of a frame with the payload already in the buffer
+static uint8_t Frame(uint8_t __TYPE__, uint8_t *__BUFFER__, uint8_t __PAYLOAD__){
+  uint8_t length = QUR_LCD_OVERHEAD + __PAYLOAD__;
+  __BUFFER__[0] = QUR_LCD_SYNC;
+  __BUFFER__[1] = length;
+  __BUFFER__[2] = __TYPE__;
+  __BUFFER__[length - 1] = QURCrc8(__BUFFER__ + 1, length - 2);
+  return length;
+}
+
+/**
+  @Function QURLCDLine
+  @purpuse Writes the frame of a line, the text is cut or padded with spaces
+       to QUR_LCD_COLS characters
+
+  @param __ROW__    Number of the line (0 to QUR_LCD_LINES - 1)
+  @param __TEXT__   Text of the line
+  @param __BUFFER__ Buffer of QUR_LCD_FRAME_MAX bytes
+  @return Returns the length of the frame
+*/
+uint8_t QURLCDLine(uint8_t __ROW__, const char *__TEXT__, uint8_t *__BUFFER__){
+  __BUFFER__[3] = __ROW__;
+  for(uint8_t x = 0; x < QUR_LCD_COLS; x++){      // Cicle with a iterator 'x' that go over each character
+    __BUFFER__[4 + x] = *__TEXT__ ? (uint8_t)*__TEXT__ : ' ';
+    if(*__TEXT__)
+      __TEXT__++;
+  }
+  return Frame(QUR_LCD_LINE, __BUFFER__, 1 + QUR_LCD_COLS);
+}
+
+/**
+  @Function QURLCDAck
+  @purpuse Writes the ACK of a line
+
+  @param __ROW__    Number of the line received
+  @param __BUFFER__ Buffer of QUR_LCD_FRAME_MAX bytes
+  @return Returns the length of the frame
+*/
+uint8_t QURLCDAck(uint8_t __ROW__, uint8_t *__BUFFER__){
+  __BUFFER__[3] = __ROW__;
+  return Frame(QUR_LCD_ACK, __BUFFER__, 1);
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURLCDParser
+//       - Feed(uint8_t __BYTE__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURLCDParser
+  @Function Feed
+  @purpuse Adds a byte to the frame in progress. The bytes before a
+       QUR_LCD_SYNC are skipped, a frame with a wrong length or CRC is
+       discarded and the search starts again in the next byte
+
+  @param __BYTE__ Byte received
+  @return Returns the type of the frame when it is complete and valid, or 0
+*/
+uint8_t QURLCDParser::Feed(uint8_t __BYTE__){
+  if(Index == 0 && __BYTE__ != QUR_LCD_SYNC)      // Out of sync (or other bytes of the link)
+    return 0;
+  Buffer[Index++] = __BYTE__;
+  if(Index == 2 && (__BYTE__ < QUR_LCD_OVERHEAD || __BYTE__ > QUR_LCD_FRAME_MAX)){
+    Errors++;
+    Index = 0;
+    return 0;
+  }
+  if(Index < 2 || Index < Buffer[1])
+    return 0;
+  Index = 0;                                      // Complete: the next byte starts other frame
+  uint8_t length = Buffer[1];
+  if(QURCrc8(Buffer + 1, length - 2) != Buffer[length - 1]){
+    Errors++;
+    return 0;
+  }
+  uint8_t type = Buffer[2];
+  if((type == QUR_LCD_LINE && length != QUR_LCD_FRAME_MAX) || (type == QUR_LCD_ACK && length != QUR_LCD_OVERHEAD + 1) ||
+     (type != QUR_LCD_LINE && type != QUR_LCD_ACK)){
+    Errors++;
+    return 0;
+  }
+  return type;
+}
@@ -0,0 +1,62 @@
+// ---------------------------------------------------------------------------
+// LCD link Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Serial link between the RF-Controller and the ModuleLCD. Before it the
+// controller sent every screen as text lines of String and the module read
+// them byte by byte waiting the '\n', and answered with '0'. Now every line
+// of the screen is a small binary frame with a CRC, the controller only sends
+// the lines that changed and the module answers every frame with an ACK. The
+// bytes are read as they arrive (QURLCDParser), nobody waits the end of a
+// frame and there is no String (no heap) in any side.
+//
+// FRAME (bytes):
+//   [0] QUR_LCD_SYNC  [1] Length of the frame  [2] Type  [3..] Payload
+//   [last] CRC8 (QURCrc8) of the bytes 1 to last-1
+//   Payload of the Type:
+//     QUR_LCD_LINE   [Line] + QUR_LCD_COLS characters (padded with spaces)   21 bytes in total
+//     QUR_LCD_ACK    [Line received]                                        5 bytes in total
+//
+// USE:
+//   uint8_t length = QURLCDLine(1, "Angulo: 90", Buffer);    // Controller
+//   QURLCDParser Parser;                                      // Both sides
+//   if(Parser.Feed(Serial.read()) == QUR_LCD_LINE) ...Parser.Payload()...
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURLCDLINK_H
+#define QURLCDLINK_H
+
+#include <Arduino.h>
+
+#define QUR_LCD_SYNC        0x5A
+#define QUR_LCD_COLS        16          // Characters of a line of the LCD
+#define QUR_LCD_LINES       4           // Lines that the controller can send (the LCD shows 2 and scrolls)
+#define QUR_LCD_OVERHEAD    4           // Sync, Length, Type and CRC
+#define QUR_LCD_FRAME_MAX   (QUR_LCD_OVERHEAD + 1 + QUR_LCD_COLS)
+
+// Types of frame
+#define QUR_LCD_LINE        1           // Text of a line (controller -> module)
+#define QUR_LCD_ACK         2           // A line was received (module -> controller)
+
+// ---------------------------------------------------------------------------
+// Writes a frame, return the length
+// ---------------------------------------------------------------------------
+uint8_t QURLCDLine(uint8_t, const char *, uint8_t *);
+uint8_t QURLCDAck(uint8_t, uint8_t *);
+
+// ---------------------------------------------------------------------------
+// Reads the frames one byte at a time
+// ---------------------------------------------------------------------------
+struct QURLCDParser
+{
+  uint8_t Buffer[QUR_LCD_FRAME_MAX];    // Buffer: Bytes of the frame in progress
+  uint8_t Index = 0;                    // Index: Bytes received of the frame
+  uint16_t Errors = 0;                  // Errors: Frames rejected (length or CRC)
+  uint8_t Feed(uint8_t);                // Feed: Adds a byte, returns the type when a frame is complete and valid (0 if not)
+  const uint8_t *Payload() const { return Buffer + 3; }
+};
+
+#endif
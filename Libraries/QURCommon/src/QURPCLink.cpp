@@ -0,0 +1,235 @@
+// ---------------------------------------------------------------------------
+// See "QURPCLink.h" for the format of the frames.
+// ---------------------------------------------------------------------------
+
+#include "QURPCLink.h"
+
+#define SETPOINTS_LENGTH  (QUR_PC_HEADER + 2 + QUR_JOINTS + 1)
+#define MODE_LENGTH       (QUR_PC_HEADER + 1 + 1)
+#define STATE_LENGTH      (QUR_PC_HEADER + 12 + QUR_JOINTS + 1)
+#define LOG_LENGTH        (QUR_PC_HEADER + 2 + 1)          // Without arguments
+
+static uint16_t Read16(const uint8_t *__DATA__){
+  return __DATA__[0] | ((uint16_t)__DATA__[1] << 8);
+}
+
+static uint8_t Write16(uint8_t *__BUFFER__, uint8_t __INDEX__, uint16_t __VALUE__){
+  __BUFFER__[__INDEX__]     = (uint8_t)__VALUE__;
+  __BUFFER__[__INDEX__ + 1] = (uint8_t)(__VALUE__ >> 8);
+  return __INDEX__ + 2;
+}
+
+/**
+  @Function QURCobsEncode
+  @purpuse Encodes a block with COBS and adds the delimiter, every 0 of the
+       block is replaced by the distance to the next 0
+
+  @param __DATA__   Bytes to encode (less than 254)
+  @param __LENGTH__ Number of bytes
+  @param __BUFFER__ Buffer of __LENGTH__ + 2 bytes
+  @return Returns the bytes written (the delimiter included)
+*/
+uint8_t QURCobsEncode(const uint8_t *__DATA__, uint8_t __LENGTH__, uint8_t *__BUFFER__){
+  uint8_t code = 0, write = 1;                    // 'code' is the byte that counts the run in progress
+  for(uint8_t x = 0; x < __LENGTH__; x++){        // Cicle with a iterator 'x' that go over each BYTE
+    if(__DATA__[x] == 0){
+      __BUFFER__[code] = write - code;
+      code = write++;
+    }
+    else
+      __BUFFER__[write++] = __DATA__[x];
+  }
+  __BUFFER__[code] = write - code;
+  __BUFFER__[write++] = QUR_PC_DELIMITER;
+  return write;
+}
+
+/**
+  @Function QURCobsDecode
+  @purpuse Decodes a block of COBS in place (the decoded bytes are never
+       ahead of the bytes read)
+
+  @param __BUFFER__ Bytes received without the delimiter, the result is written here
+  @param __LENGTH__ Number of bytes received
+  @return Returns the bytes decoded, 0 if a code points out of the block
+*/
+uint8_t QURCobsDecode(uint8_t *__BUFFER__, uint8_t __LENGTH__){
+  uint8_t read = 0, write = 0;
+  while(read < __LENGTH__){
+    uint8_t code = __BUFFER__[read++];
+    if(code == 0 || (uint16_t)read + code - 1 > __LENGTH__)
+      return 0;
+    for(uint8_t x = 1; x < code; x++)
+      __BUFFER__[write++] = __BUFFER__[read++];
+    if(code < 0xFF && read < __LENGTH__)          // The run ended in a 0 (not the end of the block)
+      __BUFFER__[write++] = 0;
+  }
+  return write;
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURPCWriter
+//       - Setpoints(const uint8_t __JOINTS__[], uint16_t __DURATION__, uint8_t *__BUFFER__)
+//       - Mode(bool __MODE__, uint8_t *__BUFFER__)
+//       - State(const QURPCState &__STATE__, uint8_t *__BUFFER__)
+// ---------------------------------------------------------------------------
+
+// Header, CRC and COBS of a frame with the payload already in __FRAME__
+uint8_t QURPCWriter::Close(uint8_t __TYPE__, uint8_t *__FRAME__, uint8_t __LENGTH__){
+  __FRAME__[0] = __TYPE__;
+  Write16(__FRAME__, 1, Sequence++);
+  __FRAME__[__LENGTH__ - 1] = QURCrc8(__FRAME__, __LENGTH__ - 1);
+  return __LENGTH__;
+}
+
+/**
+  @Struct QURPCWriter
+  @Function Setpoints
+  @purpuse Writes the setpoints of the 12 joints (0-5 legs in Axis X, 6-11
+       legs in Axis Y, like QURCommand::Joints)
+
+  @param __JOINTS__   Setpoints (0-100)
+  @param __DURATION__ Milliseconds of the keyframe (0 = direct to the servos)
+  @param __BUFFER__   Buffer of QUR_PC_WIRE_MAX bytes
+  @return Returns the length in the wire
+*/
+uint8_t QURPCWriter::Setpoints(const uint8_t __JOINTS__[], uint16_t __DURATION__, uint8_t *__BUFFER__){
+  uint8_t frame[SETPOINTS_LENGTH];
+  Write16(frame, QUR_PC_HEADER, __DURATION__);
+  memcpy(frame + QUR_PC_HEADER + 2, __JOINTS__, QUR_JOINTS);
+  return QURCobsEncode(frame, Close(QUR_PC_SETPOINTS, frame, SETPOINTS_LENGTH), __BUFFER__);
+}
+
+/**
+  @Struct QURPCWriter
+  @Function Mode
+  @purpuse Writes the mode of the robot
+
+  @param __MODE__   MANUAL or AUTOMATIC
+  @param __BUFFER__ Buffer of QUR_PC_WIRE_MAX bytes
+  @return Returns the length in the wire
+*/
+uint8_t QURPCWriter::Mode(bool __MODE__, uint8_t *__BUFFER__){
+  uint8_t frame[MODE_LENGTH];
+  frame[QUR_PC_HEADER] = __MODE__ ? 1 : 0;
+  return QURCobsEncode(frame, Close(QUR_PC_MODE, frame, MODE_LENGTH), __BUFFER__);
+}
+
+/**
+  @Struct QURPCWriter
+  @Function State
+  @purpuse Writes the state of the robot
+
+  @param __STATE__  State to send
+  @param __BUFFER__ Buffer of QUR_PC_WIRE_MAX bytes
+  @return Returns the length in the wire
+*/
+uint8_t QURPCWriter::State(const QURPCState &__STATE__, uint8_t *__BUFFER__){
+  uint8_t frame[STATE_LENGTH];
+  uint8_t length = QUR_PC_HEADER;
+  length = Write16(frame, length, __STATE__.Ack);
+  length = Write16(frame, length, __STATE__.Received);
+  length = Write16(frame, length, __STATE__.Lost);
+  length = Write16(frame, length, __STATE__.Errors);
+  length = Write16(frame, length, __STATE__.Refused);
+  frame[length++] = __STATE__.Flags;
+  frame[length++] = __STATE__.Space;
+  memcpy(frame + length, __STATE__.Setpoints, QUR_JOINTS);
+  return QURCobsEncode(frame, Close(QUR_PC_STATE, frame, STATE_LENGTH), __BUFFER__);
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURPCParser
+//       - Feed(uint8_t __BYTE__)
+//       - Setpoints(uint8_t __JOINTS__[], uint16_t &__DURATION__)
+//       - Mode()
+//       - State(QURPCState &__STATE__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURPCParser
+  @Function Feed
+  @purpuse Adds a byte to the frame in progress, at the delimiter the frame is
+       decoded and checked (COBS, length of the type and CRC) and his sequence
+       is followed (not the one of the LOG, it has his own). A wrong frame is
+       discarded and counted, the next byte starts other frame
+
+  @param __BYTE__ Byte received
+  @return Returns the type of the frame when it is complete and valid, or 0
+*/
+uint8_t QURPCParser::Feed(uint8_t __BYTE__){
+  if(__BYTE__ != QUR_PC_DELIMITER){
+    if(Index < QUR_PC_WIRE_MAX)
+      Buffer[Index++] = __BYTE__;
+    else
+      Overflow = true;
+    return 0;
+  }
+  uint8_t received = Index;
+  bool overflow = Overflow;
+  Index = 0;                                      // The next byte starts other frame
+  Overflow = false;
+  if(received == 0)                               // Two delimiters together (a PC can send one to resync)
+    return 0;
+  uint8_t length = overflow ? 0 : QURCobsDecode(Buffer, received);
+  uint8_t type = length ? Buffer[0] : 0;
+  if((type == QUR_PC_SETPOINTS && length != SETPOINTS_LENGTH) || (type == QUR_PC_MODE && length != MODE_LENGTH) ||
+     (type == QUR_PC_STATE && length != STATE_LENGTH) || (type == QUR_PC_LOG && (length < LOG_LENGTH || length > QUR_PC_FRAME_MAX)) ||
+     type == 0 || type > QUR_PC_LOG || QURCrc8(Buffer, length - 1) != Buffer[length - 1]){
+    Errors++;
+    return 0;
+  }
+  Length = length;
+  if(type == QUR_PC_LOG)
+    return type;
+  uint16_t sequence = Read16(Buffer + 1);
+  uint16_t gap = sequence - Sequence - 1;
+  if(Started && gap < 0x8000)                     // Frames skipped (an old frame is not a gap)
+    Lost += gap;
+  Started  = true;
+  Sequence = sequence;
+  return type;
+}
+
+/**
+  @Struct QURPCParser
+  @Function Setpoints
+  @purpuse Reads the last frame received, it must be a SETPOINTS
+
+  @param __JOINTS__   Vector of QUR_JOINTS setpoints
+  @param __DURATION__ Milliseconds of the keyframe (0 = direct to the servos)
+*/
+void QURPCParser::Setpoints(uint8_t __JOINTS__[], uint16_t &__DURATION__) const {
+  __DURATION__ = Read16(Payload());
+  memcpy(__JOINTS__, Payload() + 2, QUR_JOINTS);
+}
+
+/**
+  @Struct QURPCParser
+  @Function Mode
+  @purpuse Reads the last frame received, it must be a MODE
+
+  @return Returns MANUAL or AUTOMATIC
+*/
+bool QURPCParser::Mode() const {
+  return Payload()[0] != 0;
+}
+
+/**
+  @Struct QURPCParser
+  @Function State
+  @purpuse Reads the last frame received, it must be a STATE
+
+  @param __STATE__ State of the robot
+*/
+void QURPCParser::State(QURPCState &__STATE__) const {
+  const uint8_t *data = Payload();
+  __STATE__.Ack      = Read16(data);
+  __STATE__.Received = Read16(data + 2);
+  __STATE__.Lost     = Read16(data + 4);
+  __STATE__.Errors   = Read16(data + 6);
+  __STATE__.Refused  = Read16(data + 8);
+  __STATE__.Flags    = data[10];
+  __STATE__.Space    = data[11];
+  memcpy(__STATE__.Setpoints, data + 12, QUR_JOINTS);
+}
@@ -0,0 +1,112 @@
+// ---------------------------------------------------------------------------
+// PC link Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Binary link between a PC (a planner, a script) and the Hexapod in the
+// PCSerial. Before it the mode MANUAL only could be fed by the sketch calling
+// SetAnglesLeg. Now the PC streams the setpoints of the 12 joints in small
+// frames with a sequence number and the robot answers with his state. The
+// frames are COBS encoded (Consistent Overhead Byte Stuffing): the byte 0
+// never appears inside a frame, so a 0 always ends a frame and the reader
+// finds the next one after any byte lost or corrupted, without waiting and
+// without timeouts. The bytes are read as they arrive (QURPCParser), a frame
+// is decoded in the same buffer that received it.
+//
+// FRAME (bytes before COBS, little endian):
+//   [0] Type  [1-2] Sequence  [3..] Payload  [last] CRC8 (QURCrc8) of the bytes before
+//   Payload of the Type:
+//     QUR_PC_SETPOINTS  [Duration(16)] + QUR_JOINTS setpoints (0-100)        18 bytes in total
+//                       Duration 0: the setpoints go direct to the servos,
+//                       else a keyframe of Duration ms in the motion queue
+//     QUR_PC_MODE       [Mode] (MANUAL = 1, AUTOMATIC = 0)                   5 bytes in total
+//     QUR_PC_STATE      [Ack(16), Received(16), Lost(16), Errors(16), Refused(16), Flags, Space]
+//                       + QUR_JOINTS commands of the servos                    28 bytes in total
+//     QUR_PC_LOG        [Level, Message] + arguments (QURDebug.h)            6 to 18 bytes
+//                       His Sequence is the one of the messages (not followed by the Parser)
+//   On the wire: COBS(frame) + QUR_PC_DELIMITER, a frame of N bytes uses N + 2
+//   (a setpoints frame is 20 bytes, 576 frames per second at 115200 baud)
+//
+// USE:
+//   QURPCWriter Writer;                                    QURPCParser Parser;
+//   uint8_t length = Writer.Setpoints(Joints, 0, Wire);    if(Parser.Feed(Serial.read()) == QUR_PC_SETPOINTS)
+//   Serial.write(Wire, length);                              Parser.Setpoints(Joints, Duration);
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURPCLINK_H
+#define QURPCLINK_H
+
+#include <Arduino.h>
+#include "QURPacket.h"
+
+#define QUR_PC_DELIMITER    0x00        // End of a frame in the wire
+#define QUR_PC_HEADER       3           // Type and Sequence
+#define QUR_PC_FRAME_MAX    28          // Bytes of the longest frame (STATE)
+#define QUR_PC_WIRE_MAX     (QUR_PC_FRAME_MAX + 2)  // COBS code of a frame (< 254 bytes) and the delimiter
+
+// Types of frame
+#define QUR_PC_SETPOINTS    1           // Setpoints of the joints (PC -> robot)
+#define QUR_PC_MODE         2           // Mode MANUAL or AUTOMATIC (PC -> robot)
+#define QUR_PC_STATE        3           // State of the robot (robot -> PC)
+#define QUR_PC_LOG          4           // Debug message (robot -> PC, QURDebug.h)
+
+// Flags of the STATE (with QUR_STATUS_FINISHED, QUR_STATUS_WALKING, QUR_STATUS_QUEUE)
+#define QUR_PC_FLAG_MANUAL  0x08        // The robot is in mode MANUAL (the setpoints are applied)
+
+// ---------------------------------------------------------------------------
+// COBS of a block (< 254 bytes): Encode returns the bytes written with the
+// delimiter, Decode returns the bytes decoded (0 if the code is wrong)
+// ---------------------------------------------------------------------------
+uint8_t QURCobsEncode(const uint8_t *, uint8_t, uint8_t *);
+uint8_t QURCobsDecode(uint8_t *, uint8_t);
+
+// ---------------------------------------------------------------------------
+// State of the Hexapod returned to the PC
+// ---------------------------------------------------------------------------
+struct QURPCState
+{
+  uint16_t Ack = 0;                     // Ack: Sequence of the last frame received
+  uint16_t Received = 0;                // Received: Frames received by the robot (wraps)
+  uint16_t Lost = 0;                    // Lost: Frames of the PC lost (gaps of the sequence)
+  uint16_t Errors = 0;                  // Errors: Frames rejected (COBS, length, CRC or type)
+  uint16_t Refused = 0;                 // Refused: Setpoints not applied (mode AUTOMATIC or motion queue full)
+  uint8_t Flags = 0;                    // Flags: State of the robot (QUR_STATUS_*, QUR_PC_FLAG_MANUAL)
+  uint8_t Space = 0;                    // Space: Keyframes that can be added to the motion queue
+  int8_t Setpoints[QUR_JOINTS] = {0};   // Setpoints: Command (0-100) of every servo, in the order of the SETPOINTS
+};
+
+// ---------------------------------------------------------------------------
+// Writes the frames already encoded for the wire
+// ---------------------------------------------------------------------------
+struct QURPCWriter
+{
+  uint16_t Sequence = 0;                // Sequence: Number of the next frame (wraps)
+  uint8_t Setpoints(const uint8_t[], uint16_t, uint8_t *);  // Setpoints: Writes a SETPOINTS frame, returns the length
+  uint8_t Mode(bool, uint8_t *);                            // Mode: Writes a MODE frame, returns the length
+  uint8_t State(const QURPCState &, uint8_t *);             // State: Writes a STATE frame, returns the length
+  uint8_t Close(uint8_t, uint8_t *, uint8_t);
+};
+
+// ---------------------------------------------------------------------------
+// Reads the frames one byte at a time
+// ---------------------------------------------------------------------------
+struct QURPCParser
+{
+  uint8_t Buffer[QUR_PC_WIRE_MAX];      // Buffer: Bytes of the frame in progress (decoded in place)
+  uint8_t Index = 0;                    // Index: Bytes received of the frame
+  uint8_t Length = 0;                   // Length: Bytes of the last frame decoded (type to CRC)
+  bool Overflow = false;                // Overflow: The frame in progress is too long, it is discarded at the delimiter
+  uint16_t Sequence = 0;                // Sequence: Sequence of the last valid frame
+  bool Started = false;                 // Started: Some frame was received
+  uint16_t Lost = 0;                    // Lost: Frames lost (gaps of the sequence)
+  uint16_t Errors = 0;                  // Errors: Frames rejected
+  uint8_t Feed(uint8_t);                // Feed: Adds a byte, returns the type when a frame is complete and valid (0 if not)
+  void Setpoints(uint8_t[], uint16_t &) const;   // Setpoints: Reads a SETPOINTS frame (joints and duration)
+  bool Mode() const;                             // Mode: Reads a MODE frame
+  void State(QURPCState &) const;                // State: Reads a STATE frame
+  const uint8_t *Payload() const { return Buffer + QUR_PC_HEADER; }
+};
+
+#endif
@@ -0,0 +1,338 @@
+// ---------------------------------------------------------------------------
+// See "QURPacket.h" for the format of the packets.
+// ---------------------------------------------------------------------------
+
+#include "QURPacket.h"
+
+// CRC8 of every nibble (polynomial 0x07), 16 bytes instead of a table of 256
+const uint8_t CRC8_NIBBLE[16] PROGMEM = {
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+  0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+#define FULL_BYTES   ((QUR_JOINTS * 7 + 7) / 8)    // Joints of 7 bits packed
+#define STATUS_BYTES 9                              // Received, Lost, Errors, Loop (16 bits) and Missed
+
+// Flags of the header of the commands
+static uint8_t CommandFlags(const QURCommand &__COMMAND__){
+  return (__COMMAND__.Mode ? QUR_FLAG_MODE : 0) | ((__COMMAND__.Buttons << 1) & QUR_FLAG_BUTTONS);
+}
+
+// Little endian 16 bits
+static uint8_t Write16(uint8_t *__BUFFER__, uint8_t __LENGTH__, uint16_t __VALUE__){
+  __BUFFER__[__LENGTH__++] = (uint8_t)__VALUE__;
+  __BUFFER__[__LENGTH__++] = (uint8_t)(__VALUE__ >> 8);
+  return __LENGTH__;
+}
+static uint16_t Read16(const uint8_t *__DATA__){
+  return __DATA__[0] | ((uint16_t)__DATA__[1] << 8);
+}
+
+/**
+  @Function QURCrc8
+  @purpuse Calculates the CRC8 of the bytes (a nibble at a time)
+
+  @param __DATA__   Bytes
+  @param __LENGTH__ Number of bytes
+  @param __CRC__    CRC8 of the bytes before (0 to start)
+  @return Returns the CRC8
+*/
+uint8_t QURCrc8(const uint8_t *__DATA__, uint8_t __LENGTH__, uint8_t __CRC__){
+  uint8_t crc = __CRC__;
+  while(__LENGTH__--){
+    crc ^= *__DATA__++;
+    crc = (crc << 4) ^ pgm_read_byte(&CRC8_NIBBLE[crc >> 4]);
+    crc = (crc << 4) ^ pgm_read_byte(&CRC8_NIBBLE[crc >> 4]);
+  }
+  return crc;
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURPacketWriter
+//       - Drive(const QURCommand &__COMMAND__, uint8_t *__BUFFER__)
+//       - Full(const QURCommand &__COMMAND__, uint8_t *__BUFFER__)
+//       - Joint(const QURCommand &__COMMAND__, uint8_t *__BUFFER__)
+//       - Status(const QURStatus &__STATUS__, uint8_t *__BUFFER__)
+//       - Resync()
+// ---------------------------------------------------------------------------
+
+uint8_t QURPacketWriter::Header(uint8_t __TYPE__, uint8_t __FLAGS__, uint8_t *__BUFFER__){
+  __BUFFER__[0] = QUR_PACKET_VERSION;
+  __BUFFER__[1] = Sequence++;
+  __BUFFER__[2] = __TYPE__;
+  __BUFFER__[3] = __FLAGS__;
+  return QUR_PACKET_HEADER;
+}
+
+uint8_t QURPacketWriter::Close(uint8_t *__BUFFER__, uint8_t __LENGTH__){
+  __BUFFER__[__LENGTH__] = QURCrc8(__BUFFER__, __LENGTH__);
+  return __LENGTH__ + 1;
+}
+
+/**
+  @Struct QURPacketWriter
+  @Function Drive
+  @purpuse Writes the mode, heading and magnitude of the joystick
+
+  @param __COMMAND__ Command to send
+  @param __BUFFER__  Buffer of QUR_PACKET_MAX bytes
+  @return Returns the length of the packet
+*/
+uint8_t QURPacketWriter::Drive(const QURCommand &__COMMAND__, uint8_t *__BUFFER__){
+  uint8_t length = Header(QUR_PACKET_DRIVE, CommandFlags(__COMMAND__), __BUFFER__);
+  __BUFFER__[length++] = (uint8_t)__COMMAND__.Angle;
+  __BUFFER__[length++] = (uint8_t)((uint16_t)__COMMAND__.Angle >> 8);
+  __BUFFER__[length++] = __COMMAND__.Magnitude;
+  return Close(__BUFFER__, length);
+}
+
+/**
+  @Struct QURPacketWriter
+  @Function Full
+  @purpuse Writes all the joints, 7 bits each one (0-127)
+
+  @param __COMMAND__ Command to send
+  @param __BUFFER__  Buffer of QUR_PACKET_MAX bytes
+  @return Returns the length of the packet
+*/
+uint8_t QURPacketWriter::Full(const QURCommand &__COMMAND__, uint8_t *__BUFFER__){
+  uint8_t length = Header(QUR_PACKET_FULL, CommandFlags(__COMMAND__), __BUFFER__);
+  uint16_t bits = 0;                              // bits: Accumulator of the bits not written
+  uint8_t count = 0;                              // count: Number of bits in the accumulator
+  for(uint8_t x = 0; x < QUR_JOINTS; x++){        // Cicle with a iterator 'x' that go over each joint
+    Joints[x] = __COMMAND__.Joints[x] & 0x7F;
+    bits |= (uint16_t)Joints[x] << count;
+    count += 7;
+    if(count >= 8){
+      __BUFFER__[length++] = (uint8_t)bits;
+      bits >>= 8;
+      count -= 8;
+    }
+  }
+  if(count)
+    __BUFFER__[length++] = (uint8_t)bits;
+  SinceFull = 0;
+  return Close(__BUFFER__, length);
+}
+
+/**
+  @Struct QURPacketWriter
+  @Function Joint
+  @purpuse Writes the joints that changed (DELTA), or all of them (FULL) if
+       it is the time of the keyframe or the DELTA would be longer
+
+  @param __COMMAND__ Command to send
+  @param __BUFFER__  Buffer of QUR_PACKET_MAX bytes
+  @return Returns the length of the packet
+*/
+uint8_t QURPacketWriter::Joint(const QURCommand &__COMMAND__, uint8_t *__BUFFER__){
+  uint16_t mask = 0;
+  uint8_t changed = 0;
+  for(uint8_t x = 0; x < QUR_JOINTS; x++){        // Cicle with a iterator 'x' that go over each joint
+    if((__COMMAND__.Joints[x] & 0x7F) != Joints[x]){
+      mask |= 1U << x;
+      changed++;
+    }
+  }
+  if(SinceFull >= QUR_PACKET_KEYFRAME - 1 || 2 + changed >= FULL_BYTES)
+    return Full(__COMMAND__, __BUFFER__);
+  uint8_t length = Header(QUR_PACKET_DELTA, CommandFlags(__COMMAND__), __BUFFER__);
+  __BUFFER__[length++] = (uint8_t)mask;
+  __BUFFER__[length++] = (uint8_t)(mask >> 8);
+  for(uint8_t x = 0; x < QUR_JOINTS; x++){
+    if(mask & (1U << x)){
+      Joints[x] = __COMMAND__.Joints[x] & 0x7F;
+      __BUFFER__[length++] = Joints[x];
+    }
+  }
+  SinceFull++;
+  return Close(__BUFFER__, length);
+}
+
+/**
+  @Struct QURPacketWriter
+  @Function Status
+  @purpuse Writes the state of the Hexapod (the ACK payload of the commands)
+
+  @param __STATUS__ State to send
+  @param __BUFFER__ Buffer of QUR_PACKET_MAX bytes
+  @return Returns the length of the packet
+*/
+uint8_t QURPacketWriter::Status(const QURStatus &__STATUS__, uint8_t *__BUFFER__){
+  uint8_t length = Header(QUR_PACKET_STATUS, __STATUS__.Flags, __BUFFER__);
+  length = Write16(__BUFFER__, length, __STATUS__.Received);
+  length = Write16(__BUFFER__, length, __STATUS__.Lost);
+  length = Write16(__BUFFER__, length, __STATUS__.Errors);
+  length = Write16(__BUFFER__, length, __STATUS__.Loop);
+  __BUFFER__[length++] = __STATUS__.Missed;
+  return Close(__BUFFER__, length);
+}
+
+/**
+  @Struct QURPacketWriter
+  @Function Resync
+  @purpuse Forces a FULL in the next packet of joints (call it when a write
+       was not acknowledged, the reader lost the base of the DELTA)
+*/
+void QURPacketWriter::Resync(){
+  SinceFull = QUR_PACKET_KEYFRAME;
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURPacketReader
+//       - Check(const uint8_t *__BUFFER__, uint8_t __LENGTH__)
+//       - Track(uint8_t __SEQUENCE__)
+//       - Decode(const uint8_t *__BUFFER__, uint8_t __LENGTH__, QURCommand &__COMMAND__)
+//       - Decode(const uint8_t *__BUFFER__, uint8_t __LENGTH__, QURStatus &__STATUS__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURPacketReader
+  @Function Check
+  @purpuse Checks the length, the version and the CRC of a packet (the
+       rejected packets are counted in Errors)
+
+  @param __BUFFER__  Bytes received
+  @param __LENGTH__  Number of bytes received
+  @return Returns 0 if the packet is valid or a QUR_PACKET_ERROR (negative)
+*/
+int8_t QURPacketReader::Check(const uint8_t *__BUFFER__, uint8_t __LENGTH__){
+  if(__LENGTH__ < QUR_PACKET_HEADER + 1 || __LENGTH__ > QUR_PACKET_MAX){
+    Errors++;
+    return QUR_PACKET_ERROR_LENGTH;
+  }
+  if(__BUFFER__[0] != QUR_PACKET_VERSION){
+    Errors++;
+    return QUR_PACKET_ERROR_VERSION;
+  }
+  if(QURCrc8(__BUFFER__, __LENGTH__ - 1) != __BUFFER__[__LENGTH__ - 1]){
+    Errors++;
+    return QUR_PACKET_ERROR_CRC;
+  }
+  return 0;
+}
+
+/**
+  @Struct QURPacketReader
+  @Function Track
+  @purpuse Follows the sequence of the valid packets and counts the gaps
+
+  @param __SEQUENCE__ Sequence of the packet
+*/
+void QURPacketReader::Track(uint8_t __SEQUENCE__){
+  if(Started && __SEQUENCE__ != Sequence){
+    Lost += (uint8_t)(__SEQUENCE__ - Sequence);
+    Synced = false;                               // A lost packet could be a DELTA
+  }
+  Started  = true;
+  Sequence = __SEQUENCE__ + 1;
+}
+
+/**
+  @Struct QURPacketReader
+  @Function Decode
+  @purpuse Checks a packet and updates the fields of his type in the command,
+       the command is not changed if the packet is rejected
+
+  @param __BUFFER__  Bytes received
+  @param __LENGTH__  Number of bytes received
+  @param __COMMAND__ Command to update
+  @return Returns the type of the packet or a QUR_PACKET_ERROR (negative)
+*/
+int8_t QURPacketReader::Decode(const uint8_t *__BUFFER__, uint8_t __LENGTH__, QURCommand &__COMMAND__){
+  int8_t error = Check(__BUFFER__, __LENGTH__);
+  if(error)
+    return error;
+  uint8_t type = __BUFFER__[2];
+  uint8_t payload = __LENGTH__ - QUR_PACKET_HEADER - 1;
+  const uint8_t *data = __BUFFER__ + QUR_PACKET_HEADER;
+  uint16_t mask = 0;                              // mask: Joints of the DELTA
+  bool valid;                                     // valid: The length is the length of the type
+  if(type == QUR_PACKET_DRIVE)
+    valid = payload == 3;
+  else if(type == QUR_PACKET_FULL)
+    valid = payload == FULL_BYTES;
+  else if(type == QUR_PACKET_DELTA){
+    valid = payload >= 2;
+    if(valid){
+      mask = (data[0] | ((uint16_t)data[1] << 8)) & ((1U << QUR_JOINTS) - 1);
+      uint8_t changed = 0;
+      for(uint16_t bits = mask; bits; bits &= bits - 1)   // Count the bits of the mask
+        changed++;
+      valid = mask != 0 && payload == 2 + changed;
+    }
+  }
+  else{
+    Errors++;
+    return QUR_PACKET_ERROR_TYPE;
+  }
+  if(!valid){
+    Errors++;
+    return QUR_PACKET_ERROR_LENGTH;
+  }
+  Track(__BUFFER__[1]);                           // The packet is valid: check the sequence
+  __COMMAND__.Mode    = __BUFFER__[3] & QUR_FLAG_MODE;
+  __COMMAND__.Buttons = (__BUFFER__[3] & QUR_FLAG_BUTTONS) >> 1;
+  if(type == QUR_PACKET_DRIVE){
+    __COMMAND__.Angle     = (int16_t)(data[0] | ((uint16_t)data[1] << 8));
+    __COMMAND__.Magnitude = data[2];
+  }
+  else if(type == QUR_PACKET_FULL){
+    uint16_t bits = 0;
+    uint8_t count = 0;
+    for(uint8_t x = 0; x < QUR_JOINTS; x++){      // Cicle with a iterator 'x' that go over each joint
+      if(count < 7){
+        bits |= (uint16_t)(*data++) << count;
+        count += 8;
+      }
+      __COMMAND__.Joints[x] = bits & 0x7F;
+      bits >>= 7;
+      count -= 7;
+    }
+    Synced = true;
+  }
+  else{
+    if(!Synced)                                   // The base of the DELTA was lost, wait a FULL
+      return QUR_PACKET_ERROR_SYNC;
+    data += 2;
+    for(uint8_t x = 0; x < QUR_JOINTS; x++){
+      if(mask & (1U << x))
+        __COMMAND__.Joints[x] = *data++;
+    }
+  }
+  return (int8_t)type;
+}
+
+/**
+  @Struct QURPacketReader
+  @Function Decode
+  @purpuse Checks a STATUS packet of the Hexapod and copies it into the state,
+       the state is not changed if the packet is rejected
+
+  @param __BUFFER__  Bytes received
+  @param __LENGTH__  Number of bytes received
+  @param __STATUS__  State to update
+  @return Returns QUR_PACKET_STATUS or a QUR_PACKET_ERROR (negative)
+*/
+int8_t QURPacketReader::Decode(const uint8_t *__BUFFER__, uint8_t __LENGTH__, QURStatus &__STATUS__){
+  int8_t error = Check(__BUFFER__, __LENGTH__);
+  if(error)
+    return error;
+  if(__BUFFER__[2] != QUR_PACKET_STATUS){
+    Errors++;
+    return QUR_PACKET_ERROR_TYPE;
+  }
+  if(__LENGTH__ != QUR_PACKET_HEADER + STATUS_BYTES + 1){
+    Errors++;
+    return QUR_PACKET_ERROR_LENGTH;
+  }
+  Track(__BUFFER__[1]);
+  const uint8_t *data = __BUFFER__ + QUR_PACKET_HEADER;
+  __STATUS__.Flags    = __BUFFER__[3];
+  __STATUS__.Received = Read16(data);
+  __STATUS__.Lost     = Read16(data + 2);
+  __STATUS__.Errors   = Read16(data + 4);
+  __STATUS__.Loop     = Read16(data + 6);
+  __STATUS__.Missed   = data[8];
+  return QUR_PACKET_STATUS;
+}
@@ -0,0 +1,130 @@
+// ---------------------------------------------------------------------------
+// RF Packet Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Packet shared by the RF-Controller and the Hexapod. Before it every side had
+// his own struct with platform-width int (2 bytes on AVR, 4 on the Due) and
+// different fields, so the robot read bytes that meant something else. Now
+// the bytes are written one by one with fixed widths (little endian), with a
+// version, a sequence number and a CRC8, and the nRF24 sends only the bytes
+// used (dynamic payload), less airtime at 250 kbps means more commands per second.
+//
+// FORMAT (bytes):
+//   [0] QUR_PACKET_VERSION  [1] Sequence  [2] Type  [3] Flags (Mode, Buttons)
+//   Payload of the Type:
+//     QUR_PACKET_DRIVE   [Angle lo, Angle hi, Magnitude]             8 bytes in total
+//     QUR_PACKET_FULL    12 joints of 7 bits packed (11 bytes)       16 bytes in total
+//     QUR_PACKET_DELTA   [Mask lo, Mask hi] + one byte per joint     7 + changed joints
+//     QUR_PACKET_STATUS  [Received, Lost, Errors, Loop] (16 bits) + Missed   14 bytes in total
+//   [last] CRC8 (polynomial 0x07) of all the bytes before
+//
+// The STATUS goes from the Hexapod to the controller inside the ACK of a
+// command (ACK payload of the nRF24), his Flags are the state of the robot
+// (QUR_STATUS_*) and his sequence is independent of the commands.
+//
+// The DELTA only has the joints that changed since the last packet of joints,
+// the reader applies it only if it didn't lose packets since a FULL (the
+// sequence tells it), the writer sends a FULL every QUR_PACKET_KEYFRAME
+// packets of joints or when a write was not acknowledged (Resync).
+//
+// USE:
+//   QURPacketWriter Writer;                     QURPacketReader Reader;
+//   uint8_t length = Writer.Drive(Data, Buffer);  int8_t type = Reader.Decode(Buffer, length, Data);
+//   uint8_t length = Writer.Status(State, Buffer); int8_t type = Reader.Decode(Buffer, length, State);
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURPACKET_H
+#define QURPACKET_H
+
+#include <Arduino.h>
+
+#define QUR_PACKET_VERSION   1
+#define QUR_PACKET_MAX       32     // Maximum payload of the nRF24
+#define QUR_PACKET_HEADER    4      // Version, Sequence, Type, Flags
+#define QUR_PACKET_KEYFRAME  10     // Packets of joints between two FULL
+#define QUR_JOINTS           12     // Joints of the command (0-5 legs in Axis X, 6-11 legs in Axis Y)
+
+// Types of packet
+#define QUR_PACKET_DRIVE     1      // Joystick: mode, heading and magnitude
+#define QUR_PACKET_FULL      2      // All the joints
+#define QUR_PACKET_DELTA     3      // Only the joints that changed
+#define QUR_PACKET_STATUS    4      // Telemetry of the Hexapod (ACK payload)
+
+// Flags
+#define QUR_FLAG_MODE        0x01   // Mode of the joystick (true = WALKING)
+#define QUR_FLAG_BUTTONS     0x0E   // Buttons A, B and C (bits 1-3)
+
+// Flags of the STATUS
+#define QUR_STATUS_FINISHED  0x01   // All the servos are in their setpoints
+#define QUR_STATUS_WALKING   0x02   // The gait generator or the gait player is running
+#define QUR_STATUS_QUEUE     0x04   // The motion queue has keyframes
+
+// Errors of Decode (negative)
+#define QUR_PACKET_ERROR_LENGTH   -1    // The length is not the length of the type
+#define QUR_PACKET_ERROR_VERSION  -2    // Other version of the protocol
+#define QUR_PACKET_ERROR_CRC      -3    // Corrupted packet
+#define QUR_PACKET_ERROR_TYPE     -4    // Unknown type
+#define QUR_PACKET_ERROR_SYNC     -5    // DELTA without the FULL before (packets lost)
+
+// ---------------------------------------------------------------------------
+// Returns the CRC8 (polynomial 0x07, initial 0x00) of the bytes, the third
+// argument continues the CRC of the bytes before (long blocks in pieces)
+// ---------------------------------------------------------------------------
+uint8_t QURCrc8(const uint8_t *, uint8_t, uint8_t = 0);
+
+// ---------------------------------------------------------------------------
+// Command of the RF-Controller, the packets update only the fields of his type
+// ---------------------------------------------------------------------------
+struct QURCommand
+{
+  bool Mode = true;                 // Mode: Mode of the joystick (true = WALKING, false = ROTATION)
+  uint8_t Buttons = 0;              // Buttons: State of the buttons A, B and C (bits 0-2)
+  int16_t Angle = 90;               // Angle: Heading of the joystick in degrees (like atan2)
+  uint8_t Magnitude = 0;            // Magnitude: Distance of the joystick to the center (0-100)
+  uint8_t Joints[QUR_JOINTS] = {50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50};  // Joints: Setpoints (0-100)
+};
+
+// ---------------------------------------------------------------------------
+// State of the Hexapod returned to the RF-Controller
+// ---------------------------------------------------------------------------
+struct QURStatus
+{
+  uint8_t Flags = 0;                // Flags: State of the robot (QUR_STATUS_*)
+  uint16_t Received = 0;            // Received: Packets received by the robot (wraps)
+  uint16_t Lost = 0;                // Lost: Packets of the controller lost in the air (gaps of the sequence)
+  uint16_t Errors = 0;              // Errors: Packets rejected by the robot
+  uint16_t Loop = 0;                // Loop: Longest pass of the Routine in microseconds since the last STATUS
+  uint8_t Missed = 0;               // Missed: Periods skipped by the tasks of the robot (wraps)
+};
+
+struct QURPacketWriter
+{
+  uint8_t Sequence = 0;             // Sequence: Number of the next packet (wraps)
+  uint8_t Joints[QUR_JOINTS] = {0}; // Joints: Last joints sent, base of the DELTA
+  uint8_t SinceFull = QUR_PACKET_KEYFRAME;  // SinceFull: Packets of joints since the last FULL
+  uint8_t Drive(const QURCommand &, uint8_t *);   // Drive: Writes a DRIVE packet, returns the length
+  uint8_t Full(const QURCommand &, uint8_t *);    // Full: Writes a FULL packet, returns the length
+  uint8_t Joint(const QURCommand &, uint8_t *);   // Joint: Writes a DELTA or a FULL (the shortest or the keyframe)
+  uint8_t Status(const QURStatus &, uint8_t *);   // Status: Writes a STATUS packet, returns the length
+  void Resync();                                  // Resync: The next packet of joints is FULL (a write failed)
+  uint8_t Header(uint8_t, uint8_t, uint8_t *);
+  uint8_t Close(uint8_t *, uint8_t);
+};
+
+struct QURPacketReader
+{
+  uint8_t Sequence = 0;             // Sequence: Number of the next packet expected
+  bool Started = false;             // Started: Some packet was received
+  bool Synced = false;              // Synced: The joints have a FULL without losses after it
+  uint16_t Lost = 0;                // Lost: Packets lost (gaps of the sequence)
+  uint16_t Errors = 0;              // Errors: Packets rejected
+  int8_t Decode(const uint8_t *, uint8_t, QURCommand &);  // Decode: Returns the type or a QUR_PACKET_ERROR
+  int8_t Decode(const uint8_t *, uint8_t, QURStatus &);   // Decode: Same for the STATUS of the robot
+  int8_t Check(const uint8_t *, uint8_t);
+  void Track(uint8_t);
+};
+
+#endif
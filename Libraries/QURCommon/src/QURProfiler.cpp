@@ -0,0 +1,205 @@
+// ---------------------------------------------------------------------------
+// See "QURProfiler.h" for the buckets and the format of the frames.
+// ---------------------------------------------------------------------------
+
+#include "QURProfiler.h"
+#include "QURPacket.h"
+
+// ---------------------------------------------------------------------------
+// Methods for QURHistogram
+//       - Add(uint16_t __MICROS__)
+//       - Percentile(uint8_t __PERCENT__)
+//       - Reset()
+//       - Bucket(uint16_t __MICROS__)
+//       - Upper(uint8_t __BUCKET__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURHistogram
+  @Function Bucket
+  @purpuse Returns the bucket of a time: 0 to 3 are exact, after them two
+       buckets for every power of 2
+
+  @param __MICROS__ Time in microseconds
+  @return Returns the bucket (0 to QUR_PROFILE_BUCKETS - 1)
+*/
+uint8_t QURHistogram::Bucket(uint16_t __MICROS__){
+  if(__MICROS__ < 4)
+    return (uint8_t)__MICROS__;
+  uint8_t shift = 0;
+  while(__MICROS__ >= 8){                         // Until the 3 highest bits are 1xx
+    __MICROS__ >>= 1;
+    shift++;
+  }
+  return 4 + 2 * shift + ((__MICROS__ >> 1) & 1);
+}
+
+/**
+  @Struct QURHistogram
+  @Function Upper
+  @purpuse Returns the longest time that goes into a bucket
+
+  @param __BUCKET__ Bucket
+  @return Returns the time in microseconds
+*/
+uint16_t QURHistogram::Upper(uint8_t __BUCKET__){
+  if(__BUCKET__ < 4)
+    return __BUCKET__;
+  uint8_t shift = (__BUCKET__ - 4) >> 1;
+  uint16_t lower = (uint16_t)(4 + 2 * ((__BUCKET__ - 4) & 1)) << shift;
+  return lower + (2U << shift) - 1;
+}
+
+/**
+  @Struct QURHistogram
+  @Function Add
+  @purpuse Adds a sample to the window, it can be called from an interrupt if
+       the reader stops the interrupts while it copies the histogram
+
+  @param __MICROS__ Time of the stage in microseconds
+*/
+void QURHistogram::Add(uint16_t __MICROS__){
+  uint16_t &bucket = Buckets[Bucket(__MICROS__)];
+  if(bucket != 0xFFFF) bucket++;
+  if(Count != 0xFFFF) Count++;
+  if(__MICROS__ < Min) Min = __MICROS__;
+  if(__MICROS__ > Max) Max = __MICROS__;
+}
+
+/**
+  @Struct QURHistogram
+  @Function Percentile
+  @purpuse Returns the upper limit of the bucket where the percentile is, never
+       more than the longest sample
+
+  @param __PERCENT__ Percentile (1 to 100)
+  @return Returns the time in microseconds (0 without samples)
+*/
+uint16_t QURHistogram::Percentile(uint8_t __PERCENT__) const{
+  uint32_t total = 0;
+  for(uint8_t x = 0; x < QUR_PROFILE_BUCKETS; x++)
+    total += Buckets[x];
+  if(total == 0)
+    return 0;
+  uint32_t target = (total * __PERCENT__ + 99) / 100;   // Samples at or below the percentile
+  uint32_t seen = 0;
+  for(uint8_t x = 0; x < QUR_PROFILE_BUCKETS; x++){
+    seen += Buckets[x];
+    if(seen >= target)
+      return Upper(x) < Max ? Upper(x) : Max;
+  }
+  return Max;
+}
+
+/**
+  @Struct QURHistogram
+  @Function Reset
+  @purpuse Forgets the samples and starts a new window
+*/
+void QURHistogram::Reset(){
+  for(uint8_t x = 0; x < QUR_PROFILE_BUCKETS; x++)
+    Buckets[x] = 0;
+  Count = 0;
+  Min   = 0xFFFF;
+  Max   = 0;
+  Start = millis();
+}
+
+static uint8_t PutWord(uint8_t *__BUFFER__, uint8_t __INDEX__, uint16_t __VALUE__){
+  __BUFFER__[__INDEX__]     = (uint8_t)__VALUE__;
+  __BUFFER__[__INDEX__ + 1] = (uint8_t)(__VALUE__ >> 8);
+  return __INDEX__ + 2;
+}
+
+static uint16_t GetWord(const uint8_t *__BUFFER__, uint8_t __INDEX__){
+  return __BUFFER__[__INDEX__] | ((uint16_t)__BUFFER__[__INDEX__ + 1] << 8);
+}
+
+/**
+  @Function QURProfileFrame
+  @purpuse Writes the frame of a stage with the buckets that have samples, or
+       only the summary if the buckets don't fit in the space
+
+  @param __HISTOGRAM__ Histogram of the stage
+  @param __STAGE__     Number of the stage
+  @param __SEQUENCE__  Number of the frame (the host detects the frames lost)
+  @param __BUFFER__    Buffer of QUR_PROFILE_FRAME_MAX bytes
+  @param __SPACE__     Bytes that can be sent now (like availableForWrite())
+  @return Returns the length of the frame or 0 if not even the summary fits
+*/
+uint8_t QURProfileFrame(const QURHistogram &__HISTOGRAM__, uint8_t __STAGE__, uint8_t __SEQUENCE__, uint8_t *__BUFFER__, uint8_t __SPACE__){
+  if(__SPACE__ < QUR_PROFILE_SUMMARY)
+    return 0;
+  uint32_t mask = 0;
+  uint8_t length = QUR_PROFILE_SUMMARY;
+  for(uint8_t x = 0; x < QUR_PROFILE_BUCKETS; x++){     // Cicle with a iterator 'x' that go over each bucket
+    if(__HISTOGRAM__.Buckets[x]){
+      mask |= 1UL << x;
+      length += 2;
+    }
+  }
+  if(length > __SPACE__){                               // Only the summary
+    mask = 0;
+    length = QUR_PROFILE_SUMMARY;
+  }
+  uint32_t window = millis() - __HISTOGRAM__.Start;
+  __BUFFER__[0] = QUR_PROFILE_SYNC;
+  __BUFFER__[1] = length;
+  __BUFFER__[2] = QUR_PROFILE_VERSION;
+  __BUFFER__[3] = __SEQUENCE__;
+  __BUFFER__[4] = __STAGE__;
+  uint8_t index = PutWord(__BUFFER__, 5, window > 0xFFFF ? 0xFFFF : (uint16_t)window);
+  index = PutWord(__BUFFER__, index, __HISTOGRAM__.Count);
+  index = PutWord(__BUFFER__, index, __HISTOGRAM__.Count ? __HISTOGRAM__.Min : 0);
+  index = PutWord(__BUFFER__, index, __HISTOGRAM__.Max);
+  index = PutWord(__BUFFER__, index, __HISTOGRAM__.Percentile(99));
+  index = PutWord(__BUFFER__, index, (uint16_t)mask);
+  index = PutWord(__BUFFER__, index, (uint16_t)(mask >> 16));
+  for(uint8_t x = 0; x < QUR_PROFILE_BUCKETS; x++){
+    if(mask & (1UL << x))
+      index = PutWord(__BUFFER__, index, __HISTOGRAM__.Buckets[x]);
+  }
+  __BUFFER__[index] = QURCrc8(__BUFFER__ + 1, index - 1);
+  return length;
+}
+
+/**
+  @Function QURProfileDecode
+  @purpuse Checks a frame and reads it
+
+  @param __BUFFER__  Bytes of the frame (starting in QUR_PROFILE_SYNC)
+  @param __LENGTH__  Bytes of the frame
+  @param __REPORT__  Report to write, not changed if the frame is not valid
+  @return Returns true if the frame is valid
+*/
+bool QURProfileDecode(const uint8_t *__BUFFER__, uint8_t __LENGTH__, QURProfileReport &__REPORT__){
+  if(__LENGTH__ < QUR_PROFILE_SUMMARY || __LENGTH__ > QUR_PROFILE_FRAME_MAX)
+    return false;
+  if(__BUFFER__[0] != QUR_PROFILE_SYNC || __BUFFER__[1] != __LENGTH__ || __BUFFER__[2] != QUR_PROFILE_VERSION)
+    return false;
+  if(QURCrc8(__BUFFER__ + 1, __LENGTH__ - 2) != __BUFFER__[__LENGTH__ - 1])
+    return false;
+  uint32_t mask = GetWord(__BUFFER__, 15) | ((uint32_t)GetWord(__BUFFER__, 17) << 16);
+  uint8_t buckets = 0;
+  for(uint32_t bits = mask; bits; bits &= bits - 1)     // Count the bits of the mask
+    buckets++;
+  if(__LENGTH__ != QUR_PROFILE_SUMMARY + 2 * buckets)
+    return false;
+  __REPORT__.Sequence = __BUFFER__[3];
+  __REPORT__.Stage    = __BUFFER__[4];
+  __REPORT__.Window   = GetWord(__BUFFER__, 5);
+  __REPORT__.P99      = GetWord(__BUFFER__, 13);
+  QURHistogram &histogram = __REPORT__.Histogram;
+  histogram.Reset();
+  histogram.Count = GetWord(__BUFFER__, 7);
+  histogram.Min   = GetWord(__BUFFER__, 9);
+  histogram.Max   = GetWord(__BUFFER__, 11);
+  uint8_t index = QUR_PROFILE_SUMMARY - 1;
+  for(uint8_t x = 0; x < QUR_PROFILE_BUCKETS; x++){
+    if(mask & (1UL << x)){
+      histogram.Buckets[x] = GetWord(__BUFFER__, index);
+      index += 2;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,84 @@
+// ---------------------------------------------------------------------------
+// Latency profiler Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Histograms of the time that every stage of a firmware takes, cheap enough
+// to run in the field: adding a sample is a bucket index and an increment,
+// no String and no print in the hot path. The buckets are fixed, two per
+// power of 2 (0, 1, 2, 3, 4-5, 6-7, 8-11, 12-15, ... 49152-65535 us), so 32
+// buckets of 16 bits cover every time that fits in a uint16_t with an error
+// smaller than 25%.
+//
+// Every stage is sent to the PC as a binary frame and then reset, so every
+// frame is the window of time since the last frame of the stage. The host
+// decodes the frames with Tools/ProfileDecoder and merges the windows.
+//
+// FRAME (bytes, little endian):
+//   [0] QUR_PROFILE_SYNC  [1] Length of the frame  [2] QUR_PROFILE_VERSION
+//   [3] Sequence  [4] Stage  [5-6] Window (ms)  [7-8] Count
+//   [9-10] Min  [11-12] Max  [13-14] P99 (us)
+//   [15-18] Mask of the buckets sent, then 2 bytes per bucket of the mask
+//   [last] CRC8 (QURCrc8) of the bytes 1 to last-1
+// If the buckets don't fit in the space given the frame only has the summary
+// (Mask = 0, QUR_PROFILE_SUMMARY bytes).
+//
+// USE:
+//   QURHistogram Stage;
+//   uint16_t start = micros();  ...work...  Stage.Add(micros() - start);
+//   uint8_t length = QURProfileFrame(Stage, 0, Sequence++, Buffer, Serial.availableForWrite());
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURPROFILER_H
+#define QURPROFILER_H
+
+#include <Arduino.h>
+
+#define QUR_PROFILE_SYNC      0xA5
+#define QUR_PROFILE_VERSION   1
+#define QUR_PROFILE_BUCKETS   32          // Buckets of every histogram
+#define QUR_PROFILE_SUMMARY   20          // Bytes of a frame without buckets
+#define QUR_PROFILE_FRAME_MAX (QUR_PROFILE_SUMMARY + 2 * QUR_PROFILE_BUCKETS)
+
+// ---------------------------------------------------------------------------
+// Histogram of the microseconds of a stage
+// ---------------------------------------------------------------------------
+struct QURHistogram
+{
+  uint16_t Buckets[QUR_PROFILE_BUCKETS] = {0};  // Buckets: Samples of every bucket (saturate at 65535)
+  uint16_t Count = 0;                   // Count: Samples of the window (saturates at 65535)
+  uint16_t Min = 0xFFFF;                // Min: Shortest sample
+  uint16_t Max = 0;                     // Max: Longest sample
+  uint32_t Start = 0;                   // Start: millis() when the window started
+  void Add(uint16_t);                   // Add: Adds a sample in microseconds
+  uint16_t Percentile(uint8_t) const;   // Percentile: Upper limit of the bucket of the percentile
+  void Reset();                         // Reset: Starts a new window
+  static uint8_t Bucket(uint16_t);      // Bucket: Bucket of a time
+  static uint16_t Upper(uint8_t);       // Upper: Longest time of a bucket
+};
+
+// ---------------------------------------------------------------------------
+// Writes the frame of a stage, returns the length (0 if the summary doesn't fit)
+// ---------------------------------------------------------------------------
+uint8_t QURProfileFrame(const QURHistogram &, uint8_t, uint8_t, uint8_t *, uint8_t);
+
+// ---------------------------------------------------------------------------
+// Frame read by the host, the histogram has only the summary if Mask = 0
+// ---------------------------------------------------------------------------
+struct QURProfileReport
+{
+  uint8_t Sequence = 0;                 // Sequence: Number of the frame
+  uint8_t Stage = 0;                    // Stage: Number of the stage
+  uint16_t Window = 0;                  // Window: Milliseconds of samples of the frame
+  uint16_t P99 = 0;                     // P99: Percentile 99 calculated by the firmware
+  QURHistogram Histogram;               // Histogram: Samples of the window (Start is not used)
+};
+
+// ---------------------------------------------------------------------------
+// Reads a frame, returns false if the frame is not valid
+// ---------------------------------------------------------------------------
+bool QURProfileDecode(const uint8_t *, uint8_t, QURProfileReport &);
+
+#endif
@@ -0,0 +1,143 @@
+// ---------------------------------------------------------------------------
+// See "QURRecorder.h" for the format of the blocks and the records.
+// ---------------------------------------------------------------------------
+
+#include "QURRecorder.h"
+#include "QURPacket.h"
+
+// CRC8 of the records of a block (the length of QURCrc8 is 8 bits) and his header
+static uint8_t BlockCrc(const uint8_t *__BLOCK__, uint8_t __CRC__, uint16_t __FROM__){
+  for(uint16_t x = __FROM__; x < QUR_LOG_BLOCK; x += QUR_LOG_RECORD)
+    __CRC__ = QURCrc8(__BLOCK__ + x, QUR_LOG_RECORD, __CRC__);
+  return QURCrc8(__BLOCK__, QUR_LOG_HEADER - 1, __CRC__);
+}
+
+/**
+  @Function QURLogCheck
+  @purpuse Checks a block received from the robot
+
+  @param __BLOCK__  Block of QUR_LOG_BLOCK bytes
+  @return Returns true if the magic, the version, the count and the CRC are right
+*/
+bool QURLogCheck(const uint8_t *__BLOCK__){
+  if((__BLOCK__[0] | ((uint16_t)__BLOCK__[1] << 8)) != QUR_LOG_MAGIC || __BLOCK__[2] != QUR_LOG_VERSION)
+    return false;
+  if(__BLOCK__[3] > QUR_LOG_RECORDS)
+    return false;
+  return BlockCrc(__BLOCK__, 0, QUR_LOG_HEADER) == __BLOCK__[QUR_LOG_HEADER - 1];
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURLogRecord
+//       - QURLogRecord(uint8_t __TYPE__, uint8_t __ARGUMENT__, uint32_t __MICROS__)
+//       - Add8(uint8_t __VALUE__)
+//       - Add16(uint16_t __VALUE__)
+// ---------------------------------------------------------------------------
+
+QURLogRecord::QURLogRecord(uint8_t __TYPE__, uint8_t __ARGUMENT__, uint32_t __MICROS__){
+  memset(Bytes, 0, sizeof(Bytes));
+  Bytes[0] = __TYPE__;
+  Bytes[1] = __ARGUMENT__;
+  Bytes[2] = (uint8_t)__MICROS__;
+  Bytes[3] = (uint8_t)(__MICROS__ >> 8);
+  Bytes[4] = (uint8_t)(__MICROS__ >> 16);
+  Bytes[5] = (uint8_t)(__MICROS__ >> 24);
+  Length = QUR_LOG_RECORD - QUR_LOG_PAYLOAD;
+}
+
+void QURLogRecord::Add8(uint8_t __VALUE__){
+  if(Length < QUR_LOG_RECORD)
+    Bytes[Length++] = __VALUE__;
+}
+
+void QURLogRecord::Add16(uint16_t __VALUE__){
+  Add8((uint8_t)__VALUE__);
+  Add8((uint8_t)(__VALUE__ >> 8));
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURRecorder
+//       - Log(const QURLogRecord &__RECORD__)
+//       - Close()
+//       - Flush(HardwareSerial &__PORT__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURRecorder
+  @Function Log
+  @purpuse Copies a record into the block in construction (the CRC advances
+       one record at a time), a full block is closed to be sent
+
+  @param __RECORD__ Record
+  @return Returns true if the record was saved, false if it was dropped because
+       every block is waiting to be sent
+*/
+bool QURRecorder::Log(const QURLogRecord &__RECORD__){
+  if(Closed == QUR_LOG_BLOCKS){                 // The module is slower than the records
+    if(Dropped < 0xFFFF) Dropped++;
+    if(Lost < 0xFFFF)    Lost++;
+    return false;
+  }
+  memcpy(Blocks[Filling] + Used, __RECORD__.Bytes, QUR_LOG_RECORD);
+  Crc = QURCrc8(__RECORD__.Bytes, QUR_LOG_RECORD, Crc);
+  Used += QUR_LOG_RECORD;
+  if(Used == QUR_LOG_BLOCK)
+    Close();
+  return true;
+}
+
+/**
+  @Struct QURRecorder
+  @Function Close
+  @purpuse Writes the header of the block in construction and leaves it
+       waiting to be sent, the next records go to the next block. The records
+       not used are 0. A block without records is not closed
+*/
+void QURRecorder::Close(){
+  if(Used == QUR_LOG_HEADER || Closed == QUR_LOG_BLOCKS)
+    return;
+  uint8_t *block = Blocks[Filling];
+  memset(block + Used, 0, QUR_LOG_BLOCK - Used);
+  memset(block, 0, QUR_LOG_HEADER);
+  block[0] = (uint8_t)QUR_LOG_MAGIC;
+  block[1] = (uint8_t)(QUR_LOG_MAGIC >> 8);
+  block[2] = QUR_LOG_VERSION;
+  block[3] = (uint8_t)((Used - QUR_LOG_HEADER) / QUR_LOG_RECORD);
+  block[4] = (uint8_t)Sequence;
+  block[5] = (uint8_t)(Sequence >> 8);
+  block[6] = (uint8_t)(Sequence >> 16);
+  block[7] = (uint8_t)(Sequence >> 24);
+  block[8] = (uint8_t)Dropped;
+  block[9] = (uint8_t)(Dropped >> 8);
+  block[QUR_LOG_HEADER - 1] = BlockCrc(block, Crc, Used);   // The records are already in Crc
+  Sequence++;
+  Dropped = 0;
+  Closed++;
+  Filling = (Filling + 1) % QUR_LOG_BLOCKS;
+  Used = QUR_LOG_HEADER;
+  Crc = 0;
+}
+
+/**
+  @Struct QURRecorder
+  @Function Flush
+  @purpuse Writes the oldest blocks closed to the port while his TX buffer has
+       space, never waits: the rest of the block goes in the next call
+
+  @param __PORT__   Serial port of the ModuleSD
+*/
+void QURRecorder::Flush(HardwareSerial &__PORT__){
+  int space;
+  while(Closed && (space = __PORT__.availableForWrite()) > 0){
+    uint16_t length = QUR_LOG_BLOCK - Sent;
+    if(length > (uint16_t)space)
+      length = space;
+    __PORT__.write(Blocks[Sending] + Sent, length);
+    Sent += length;
+    if(Sent == QUR_LOG_BLOCK){                  // Block sent, the next one
+      Sent = 0;
+      Sending = (Sending + 1) % QUR_LOG_BLOCKS;
+      Closed--;
+    }
+  }
+}
@@ -0,0 +1,101 @@
+// ---------------------------------------------------------------------------
+// Flight recorder Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Log of the Hexapod for the ModuleSD (an ATmega328p with the MicroSD, slave
+// of the robot in a Serial port). The robot appends records of fixed size
+// (packets received, setpoints, pulses of the joints, timings of the loop)
+// to a block in RAM and the block is sent to the module only when it is
+// full, a few bytes at a time (the space of the TX buffer of the Serial), so
+// logging never blocks the Routine. A block is a sector of the card (512
+// bytes), the module writes every block as it arrives without parsing it.
+// While one block is sent the records go to the other one, if all the blocks
+// are full the records are dropped and counted (the next block says how many).
+//
+// BLOCK (QUR_LOG_BLOCK bytes, little endian):
+//   [0-1] QUR_LOG_MAGIC  [2] QUR_LOG_VERSION  [3] Records in the block
+//   [4-7] Sequence of the block  [8-9] Records dropped before the block
+//   [10-14] Reserved (0)  [15] CRC8 (QURCrc8) of the records and the bytes 0 to 14
+//   [16..] QUR_LOG_RECORDS records, the ones after the count are 0
+//
+// RECORD (QUR_LOG_RECORD bytes):
+//   [0] Type  [1] Argument  [2-5] micros()  [6-15] Payload of the type
+//   QUR_LOG_PACKET     Arg: result of Decode   [Flags, Angle(16), Magnitude, Received(16), Lost(16), Errors(16)]
+//   QUR_LOG_SETPOINTS  Arg: axis               [Setpoint of every leg (0-100)]
+//   QUR_LOG_JOINTS     Arg: first joint        [Pulse in microseconds (16) of up to 5 joints]
+//   QUR_LOG_TIMING     Arg: 0                  [Longest gap of the loop(16), Missed(16), Overruns(16), Dropped(16), Blocks(16)]
+//
+// USE:
+//   QURRecorder Recorder;
+//   QURLogRecord record(QUR_LOG_TIMING, 0, micros());
+//   record.Add16(Gap);  Recorder.Log(record);
+//   Recorder.Flush(Serial1);          - Call it often, sends what fits in the TX buffer
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURRECORDER_H
+#define QURRECORDER_H
+
+#include <Arduino.h>
+
+#define QUR_LOG_MAGIC       0x4C51      // "QL"
+#define QUR_LOG_VERSION     1
+#define QUR_LOG_BLOCK       512         // Bytes of a block (a sector of the card)
+#define QUR_LOG_HEADER      16          // Bytes of the header of a block
+#define QUR_LOG_RECORD      16          // Bytes of a record
+#define QUR_LOG_PAYLOAD     10          // Bytes of the payload of a record
+#define QUR_LOG_RECORDS     ((QUR_LOG_BLOCK - QUR_LOG_HEADER) / QUR_LOG_RECORD)
+#ifndef QUR_LOG_BLOCKS
+  #define QUR_LOG_BLOCKS    2           // Blocks in RAM (one is sent while the other fills)
+#endif
+
+// Types of record
+#define QUR_LOG_PACKET      1           // A packet of the RF-Controller was decoded
+#define QUR_LOG_SETPOINTS   2           // The setpoints of an axis changed
+#define QUR_LOG_JOINTS      3           // The pulses of the joints changed
+#define QUR_LOG_TIMING      4           // Timings of the loop (periodic)
+
+// ---------------------------------------------------------------------------
+// Returns true if the block has the magic, the version and the CRC
+// ---------------------------------------------------------------------------
+bool QURLogCheck(const uint8_t *);
+
+// ---------------------------------------------------------------------------
+// Record in construction, the payload is written field by field
+// ---------------------------------------------------------------------------
+struct QURLogRecord
+{
+  uint8_t Bytes[QUR_LOG_RECORD];        // Bytes: Record (the payload not written is 0)
+  uint8_t Length;                       // Length: Bytes written
+  QURLogRecord(uint8_t, uint8_t, uint32_t);   // Type, Argument and micros()
+  void Add8(uint8_t);                   // Add8: Adds a byte to the payload (ignored if it is full)
+  void Add16(uint16_t);                 // Add16: Adds 16 bits to the payload
+};
+
+// ---------------------------------------------------------------------------
+// Blocks of records waiting to be sent
+// Methods:
+//      - bool Log(const QURLogRecord &)
+//      - void Close()
+//      - void Flush(HardwareSerial &)
+// ---------------------------------------------------------------------------
+struct QURRecorder
+{
+  uint8_t Blocks[QUR_LOG_BLOCKS][QUR_LOG_BLOCK];  // Blocks: Block in construction and blocks waiting to be sent
+  uint8_t Filling = 0;                  // Filling: Block that receives the records
+  uint8_t Sending = 0;                  // Sending: Oldest block closed
+  uint8_t Closed = 0;                   // Closed: Blocks waiting to be sent
+  uint16_t Used = QUR_LOG_HEADER;       // Used: Bytes of the block Filling
+  uint16_t Sent = 0;                    // Sent: Bytes of the block Sending already written
+  uint8_t Crc = 0;                      // Crc: CRC8 of the records of the block Filling
+  uint32_t Sequence = 0;                // Sequence: Number of the next block
+  uint16_t Dropped = 0;                 // Dropped: Records dropped since the last block (saturates)
+  uint16_t Lost = 0;                    // Lost: Records dropped since the start (saturates)
+  bool Log(const QURLogRecord &);       // Log: Adds a record, false if every block is full
+  void Close();                         // Close: Closes the block Filling (if it has records) to be sent
+  void Flush(HardwareSerial &);         // Flush: Writes the blocks closed while the TX buffer has space
+};
+
+#endif
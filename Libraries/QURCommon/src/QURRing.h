@@ -0,0 +1,69 @@
+// ---------------------------------------------------------------------------
+// Packet ring buffer Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Single-producer / single-consumer queue of packets without locks: the
+// producer (an interrupt) only writes Head and the consumer (the Routine)
+// only writes Tail. The indexes are 8 bits so they are read and written in
+// one instruction on AVR, and the packet is copied before Head moves, so the
+// consumer never sees a packet half written.
+//
+// If the queue is full the producer discards the packet (Dropped) and counts
+// the event (Overruns) instead of overwriting a packet that the consumer can
+// be reading.
+//
+// USE:
+//   QURPacketRing<8, 32> Ring;
+//   Producer (interrupt):  uint8_t *slot = Ring.Reserve();  ...fill...  Ring.Commit(length);
+//   Consumer (Routine):    uint8_t length; const uint8_t *packet = Ring.Front(length);  ...  Ring.Pop();
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURRING_H
+#define QURRING_H
+
+#include <Arduino.h>
+
+template <uint8_t SIZE, uint8_t BYTES>
+struct QURPacketRing
+{
+  static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0 && SIZE <= 128, "SIZE must be a power of 2 (2 to 128)");
+
+  uint8_t Data[SIZE][BYTES];          // Data: Packets
+  uint8_t Length[SIZE];               // Length: Bytes of every packet
+  volatile uint8_t Head = 0;          // Head: Next packet to write (only the producer changes it)
+  volatile uint8_t Tail = 0;          // Tail: Next packet to read (only the consumer changes it)
+  volatile uint16_t Overruns = 0;     // Overruns: Times the producer found the queue full
+  volatile uint16_t Dropped = 0;      // Dropped: Packets discarded by the producer
+  uint8_t Peak = 0;                   // Peak: Maximum packets waiting (seen by the consumer)
+
+  // Producer: slot of the next packet, or NULL if the queue is full
+  uint8_t *Reserve(){
+    if((uint8_t)(Head - Tail) >= SIZE)
+      return NULL;
+    return Data[Head & (SIZE - 1)];
+  }
+  // Producer: publishes the packet written in the slot of Reserve()
+  void Commit(uint8_t __LENGTH__){
+    Length[Head & (SIZE - 1)] = __LENGTH__;
+    Head = Head + 1;
+  }
+  // Consumer: oldest packet, or NULL if the queue is empty
+  const uint8_t *Front(uint8_t &__LENGTH__){
+    uint8_t waiting = (uint8_t)(Head - Tail);
+    if(waiting == 0)
+      return NULL;
+    if(waiting > Peak) Peak = waiting;
+    __LENGTH__ = Length[Tail & (SIZE - 1)];
+    return Data[Tail & (SIZE - 1)];
+  }
+  // Consumer: releases the packet of Front()
+  void Pop(){
+    Tail = Tail + 1;
+  }
+  bool Empty() const { return Head == Tail; }
+};
+
+#endif
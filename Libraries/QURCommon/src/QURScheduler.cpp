@@ -0,0 +1,138 @@
+// ---------------------------------------------------------------------------
+// See "QURScheduler.h" syntax, methods index, version history, links, and more.
+// ---------------------------------------------------------------------------
+
+#include "QURScheduler.h"
+
+// ---------------------------------------------------------------------------
+// Methods for Timers controller
+//       - SetTimer(uint32_t __DURATION__)
+//       - Expired()
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURTimer
+  @Function SetTimer
+  @purpuse Starts the timer
+
+  @param __DURATION__ Microseconds until the timer ends
+*/
+void QURTimer::SetTimer(uint32_t __DURATION__){
+  Deadline = micros() + __DURATION__;     // The sum can wrap, Expired() handles it
+}
+
+/**
+  @Struct QURTimer
+  @Function Expired
+  @purpuse Checks if the timer ended
+
+  @return Returns true if the timer ended or false if not
+*/
+bool QURTimer::Expired(){
+  return QURTimeReached(micros(), Deadline);
+}
+
+// ---------------------------------------------------------------------------
+// Methods for Scheduler
+//       - AddTask(QURTaskFunction, void *, uint32_t, uint32_t)
+//       - Enable(int8_t, bool)
+//       - SetPeriod(int8_t, uint32_t)
+//       - Restart(int8_t)
+//       - Run()
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURScheduler
+  @Function AddTask
+  @purpuse Adds a periodic task to the scheduler (the task starts enabled)
+
+  @param __TASK__     Function to call
+  @param __CONTEXT__  Argument for the function
+  @param __PERIOD__   Microseconds between calls
+  @param __PHASE__    Microseconds to wait before the first call
+  @return Returns the ID of the task or -1 if there is no space (QUR_MAX_TASKS)
+*/
+int8_t QURScheduler::AddTask(QURTaskFunction __TASK__, void *__CONTEXT__, uint32_t __PERIOD__, uint32_t __PHASE__){
+  if(Count >= QUR_MAX_TASKS)
+    return -1;
+  QURTask &task = Tasks[Count];
+  task.Function = __TASK__;
+  task.Context  = __CONTEXT__;
+  task.Period   = __PERIOD__;
+  task.Deadline = micros() + __PHASE__;
+  task.Enabled  = true;
+  task.Runs     = 0;
+  task.Missed   = 0;
+  return Count++;
+}
+
+/**
+  @Struct QURScheduler
+  @Function Enable
+  @purpuse Enables or disables a task, when is enabled again it runs immediately
+
+  @param __ID__    ID returned by AddTask
+  @param __STATE__ true to enable or false to disable
+*/
+void QURScheduler::Enable(int8_t __ID__, bool __STATE__){
+  if(__ID__ < 0 || __ID__ >= Count) return;
+  if(__STATE__ && !Tasks[__ID__].Enabled)
+    Tasks[__ID__].Deadline = micros();
+  Tasks[__ID__].Enabled = __STATE__;
+}
+
+/**
+  @Struct QURScheduler
+  @Function SetPeriod
+  @purpuse Change the rate of a task, the new period applies after the next call
+
+  @param __ID__     ID returned by AddTask
+  @param __PERIOD__ Microseconds between calls
+*/
+void QURScheduler::SetPeriod(int8_t __ID__, uint32_t __PERIOD__){
+  if(__ID__ < 0 || __ID__ >= Count) return;
+  Tasks[__ID__].Period = __PERIOD__;
+}
+
+/**
+  @Struct QURScheduler
+  @Function Restart
+  @purpuse Starts the period of a task again from now, so his next call is one
+       full period later
+
+  @param __ID__ ID returned by AddTask
+*/
+void QURScheduler::Restart(int8_t __ID__){
+  if(__ID__ < 0 || __ID__ >= Count) return;
+  Tasks[__ID__].Deadline = micros() + Tasks[__ID__].Period;
+}
+
+/**
+  @Struct QURScheduler
+  @Function Run
+  @purpuse Calls once every task that is due. The next deadline is the previous
+       deadline plus the period (fixed rate without drift), if the loop was late
+       more than one period the missed calls are skipped, not accumulated.
+
+  @return Returns the number of tasks executed
+*/
+uint8_t QURScheduler::Run(){
+  uint8_t executed = 0;
+  for(uint8_t x = 0; x < Count; x++){
+    QURTask &task = Tasks[x];
+    if(!task.Enabled)                         // A disabled task doesn't read the clock
+      continue;
+    uint32_t now = micros();
+    if(!QURTimeReached(now, task.Deadline))
+      continue;
+    task.Deadline += task.Period;
+    if(QURTimeReached(now, task.Deadline)){   // Still late: skip the lost periods
+      task.Deadline = now + task.Period;
+      task.Missed++;
+    }
+    task.Runs++;
+    task.Function(task.Context);
+    executed++;
+  }
+  return executed;
+}
@@ -0,0 +1,95 @@
+// ---------------------------------------------------------------------------
+// Scheduler Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// Cooperative scheduler shared by the Hexapod and the RF-Controller. Every
+// task is a function that runs at his own fixed rate, the tasks never block
+// so a slow job (like the servos) can't stall the RF.
+//
+// All the times are 32-bit micros() and are compared with a signed difference
+// so the timers keep working when micros() wraps (every ~71 minutes), the old
+// TIMES struct used int (16-bit in AVR) and overflowed after ~32 seconds.
+//
+// TIMER:
+//   QURTimer Timer;
+//   Timer.SetTimer(500000);       - Starts a timer of 500 ms (in microseconds)
+//   Timer.Expired();              - Returns true when the time ended
+//
+// SCHEDULER:
+//   QURScheduler Scheduler;
+//   int8_t id = Scheduler.AddTask(Function, Context, Period, Phase);
+//                                 - Adds a task called every 'Period' microseconds,
+//                                   'Phase' delays the first call to spread the tasks.
+//   Scheduler.Run();              - Runs every task that is due (call it from loop())
+//   Scheduler.Enable(id, false);  - Disables a task
+//   Scheduler.Restart(id);        - The next call is one period from now (a task
+//                                   that was done by other way, like a keepalive)
+//
+// HISTORY:
+// v1.0 - Initial release, replaces the TIMES struct.
+// ---------------------------------------------------------------------------
+
+#ifndef QURSCHEDULER_H
+#define QURSCHEDULER_H
+
+#include <Arduino.h>
+
+#ifndef QUR_MAX_TASKS
+  #define QUR_MAX_TASKS  8    // Maximum number of tasks per scheduler
+#endif
+
+// ---------------------------------------------------------------------------
+// Returns true if the time '__NOW__' is equal or after '__DEADLINE__', works
+// across the wrap of the 32-bit counter (valid for differences < 35 minutes).
+// ---------------------------------------------------------------------------
+inline bool QURTimeReached(uint32_t __NOW__, uint32_t __DEADLINE__){
+  return (int32_t)(__NOW__ - __DEADLINE__) >= 0;
+}
+
+// ---------------------------------------------------------------------------
+// STRUCT TO CONTROL TIMES
+// One-shot timer without delay, only using the micros() function
+// Methods:
+//      - void SetTimer(uint32_t)
+//      - bool Expired()
+// ---------------------------------------------------------------------------
+struct QURTimer
+{
+  uint32_t Deadline = 0;        // Deadline: Time in microseconds when the timer ends
+  void SetTimer(uint32_t);      // SetTimer: Starts the timer, the argument is the duration in microseconds
+  bool Expired();               // Expired: Returns true if the timer ended
+};
+
+// ---------------------------------------------------------------------------
+// STRUCT OF A TASK
+// ---------------------------------------------------------------------------
+typedef void (*QURTaskFunction)(void *);
+
+struct QURTask
+{
+  QURTaskFunction Function = NULL;  // Function: Function called when the task is due
+  void *Context = NULL;             // Context: Argument for the Function (usually the owner object)
+  uint32_t Period = 0;              // Period: Microseconds between calls
+  uint32_t Deadline = 0;            // Deadline: Time for the next call
+  bool Enabled = false;             // Enabled: The task only runs if is enabled
+  uint16_t Runs = 0;                // Runs: Number of calls (wraps)
+  uint16_t Missed = 0;              // Missed: Number of periods skipped because the loop was late
+};
+
+// ---------------------------------------------------------------------------
+// COOPERATIVE SCHEDULER
+// ---------------------------------------------------------------------------
+class QURScheduler
+{
+  QURTask Tasks[QUR_MAX_TASKS];
+  uint8_t Count = 0;
+public:
+  int8_t AddTask(QURTaskFunction, void *, uint32_t, uint32_t = 0);
+  void Enable(int8_t, bool);
+  void SetPeriod(int8_t, uint32_t);
+  void Restart(int8_t);
+  uint8_t Run();
+  const QURTask &Task(int8_t __ID__) const { return Tasks[__ID__]; }
+};
+
+#endif
@@ -0,0 +1,156 @@
+// ---------------------------------------------------------------------------
+// See "QURStore.h" for the format of the records.
+// ---------------------------------------------------------------------------
+
+#include "QURStore.h"
+#include "QURPacket.h"
+#include <EEPROM.h>
+
+// CRC8 of the tag and the length, the CRC of the data continues it
+static uint8_t HeaderCrc(uint8_t __TAG__, uint16_t __LENGTH__){
+  uint8_t header[3] = {__TAG__, (uint8_t)__LENGTH__, (uint8_t)(__LENGTH__ >> 8)};
+  return QURCrc8(header, sizeof(header));
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURStoreReader
+//       - Begin(uint16_t __ADDRESS__, uint8_t __TAG__, uint16_t __LENGTH__)
+//       - Read(void *__DATA__, uint16_t __LENGTH__)
+//       - Read8()
+//       - Read16()
+//       - End()
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURStoreReader
+  @Function Begin
+  @purpuse Finds the record in the EEPROM, the data is read next with Read
+
+  @param __ADDRESS__ First byte of the record in the EEPROM
+  @param __TAG__     Type of the record expected
+  @param __LENGTH__  Bytes of the data expected
+  @return Returns true if the magic, the tag and the length match
+*/
+bool QURStoreReader::Begin(uint16_t __ADDRESS__, uint8_t __TAG__, uint16_t __LENGTH__){
+  Found = false;
+  Left  = 0;
+  if((uint32_t)__ADDRESS__ + QUR_STORE_HEADER + __LENGTH__ + 1 > EEPROM.length())
+    return false;
+  if(EEPROM.read(__ADDRESS__) != QUR_STORE_MAGIC || EEPROM.read(__ADDRESS__ + 1) != __TAG__)
+    return false;
+  if((EEPROM.read(__ADDRESS__ + 2) | ((uint16_t)EEPROM.read(__ADDRESS__ + 3) << 8)) != __LENGTH__)
+    return false;
+  Address = __ADDRESS__ + QUR_STORE_HEADER;
+  Left    = __LENGTH__;
+  Crc     = HeaderCrc(__TAG__, __LENGTH__);
+  Found   = true;
+  return true;
+}
+
+void QURStoreReader::Read(void *__DATA__, uint16_t __LENGTH__){
+  uint8_t *data = (uint8_t *)__DATA__;
+  for(uint16_t x = 0; x < __LENGTH__; x++)
+    data[x] = Read8();
+}
+
+uint8_t QURStoreReader::Read8(){
+  if(!Left) return 0;
+  uint8_t value = EEPROM.read(Address++);
+  Crc = QURCrc8(&value, 1, Crc);
+  Left--;
+  return value;
+}
+
+uint16_t QURStoreReader::Read16(){
+  uint16_t value = Read8();
+  return value | ((uint16_t)Read8() << 8);
+}
+
+bool QURStoreReader::End(){
+  return Found && !Left && EEPROM.read(Address) == Crc;
+}
+
+// ---------------------------------------------------------------------------
+// Methods for QURStoreWriter
+//       - Begin(uint16_t __ADDRESS__, uint8_t __TAG__, uint16_t __LENGTH__,
+//               QURStoreSource __SOURCE__, void *__CONTEXT__)
+//       - Step()
+//       - Byte(uint16_t __INDEX__)
+// ---------------------------------------------------------------------------
+
+/**
+  @Struct QURStoreWriter
+  @Function Begin
+  @purpuse Starts to save a record, nothing is written until Step. A record
+       that is being saved starts again from the first byte
+
+  @param __ADDRESS__ First byte of the record in the EEPROM
+  @param __TAG__     Type of the record
+  @param __LENGTH__  Bytes of the data
+  @param __SOURCE__  Returns the byte N of the data
+  @param __CONTEXT__ Argument of the Source
+*/
+void QURStoreWriter::Begin(uint16_t __ADDRESS__, uint8_t __TAG__, uint16_t __LENGTH__, QURStoreSource __SOURCE__, void *__CONTEXT__){
+  Address = __ADDRESS__;
+  Tag     = __TAG__;
+  Length  = __LENGTH__;
+  Source  = __SOURCE__;
+  Context = __CONTEXT__;
+  Index   = 0;
+  Crc     = HeaderCrc(__TAG__, __LENGTH__);
+  Busy    = __SOURCE__ != NULL && (uint32_t)__ADDRESS__ + QUR_STORE_HEADER + __LENGTH__ + 1 <= EEPROM.length();
+}
+
+/**
+  @Struct QURStoreWriter
+  @Function Byte
+  @purpuse Value of a step of the save: 0 clears the magic, then the header,
+       the data and the CRC, the last step writes the magic
+
+  @param __INDEX__ Step of the save (the offset in the record, but the last one)
+  @return Returns the byte to write
+*/
+uint8_t QURStoreWriter::Byte(uint16_t __INDEX__){
+  uint16_t crc = QUR_STORE_HEADER + Length;
+  if(__INDEX__ == 0) return 0xFF;
+  if(__INDEX__ == 1) return Tag;
+  if(__INDEX__ == 2) return (uint8_t)Length;
+  if(__INDEX__ == 3) return (uint8_t)(Length >> 8);
+  if(__INDEX__ < crc) return Source(Context, __INDEX__ - QUR_STORE_HEADER);
+  if(__INDEX__ == crc) return Crc;
+  return QUR_STORE_MAGIC;
+}
+
+/**
+  @Struct QURStoreWriter
+  @Function Step
+  @purpuse Compares the next bytes with the EEPROM and writes the first one that
+       changed. Never waits for the EEPROM: while a write is in progress it
+       returns, and after starting a write it returns
+
+  @return Returns true while the record is not saved
+*/
+bool QURStoreWriter::Step(){
+  if(!Busy || !eeprom_is_ready())                 // The last write is still in progress
+    return Busy;
+  uint16_t crc = QUR_STORE_HEADER + Length;
+  for(uint8_t x = 0; x < QUR_STORE_PASS; x++){    // Cicle with a iterator 'x' that go over each byte already saved
+    uint16_t address = Address + (Index > crc ? 0 : Index);
+    uint8_t value  = Byte(Index);
+    uint8_t stored = EEPROM.read(address);
+    bool changed = Index == 0 ? stored == QUR_STORE_MAGIC : stored != value;
+    if(changed){
+      EEPROM.write(address, value);               // Starts the write (3.3 ms) and returns
+      Writes++;
+    }
+    if(Index >= QUR_STORE_HEADER && Index < crc)  // The header is in the CRC since Begin
+      Crc = QURCrc8(&value, 1, Crc);
+    if(Index++ > crc){
+      Busy = false;
+      return false;
+    }
+    if(changed)
+      return true;
+  }
+  return true;
+}
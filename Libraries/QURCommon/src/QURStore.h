@@ -0,0 +1,97 @@
+// ---------------------------------------------------------------------------
+// EEPROM store Quantum robotics Library - v1.0
+//
+// BACKGROUND:
+// The boards keep their calibration in the EEPROM (the tables of pulses of
+// the robot, the centers of the joysticks) so the next boot reads it in a
+// few microseconds instead of calculating or sampling it again. A record is
+// checked with his tag, his length and a CRC8 (QURCrc8): a record of other
+// firmware, of other layout or half written is refused and the board
+// calibrates like the first time.
+// An EEPROM write takes 3.3 ms, so QURStoreWriter never waits for it: every
+// Step() writes at most one byte (only the bytes that changed, the EEPROM
+// lives more) and returns, call it from a task of the Routine until it
+// returns false. The magic is cleared before the first byte and written
+// after the CRC, a reset in the middle of a save leaves no valid record.
+//
+// RECORD (little endian):
+//   [0] QUR_STORE_MAGIC  [1] Tag  [2-3] Length of the data
+//   [4..] Data  [4 + Length] CRC8 of the tag, the length and the data
+//
+// USE:
+//   QURStoreReader reader;
+//   if(reader.Begin(QUR_STORE_ROBOT, QUR_STORE_TAG_ROBOT, sizeof(table))){
+//     reader.Read(table, sizeof(table));
+//     valid = reader.End();          - false if the CRC doesn't match
+//   }
+//   Writer.Begin(QUR_STORE_ROBOT, QUR_STORE_TAG_ROBOT, sizeof(table), ByteOfTable, &table);
+//   Writer.Step();                    - In a task of the Routine, false when the record is saved
+//
+// HISTORY:
+// v1.0 - Initial release.
+// ---------------------------------------------------------------------------
+
+#ifndef QURSTORE_H
+#define QURSTORE_H
+
+#include <Arduino.h>
+
+#define QUR_STORE_MAGIC     0x51        // "Q"
+#define QUR_STORE_HEADER    4           // Bytes before the data (magic, tag and length)
+#define QUR_STORE_PASS      16          // Bytes compared per Step() that are already in the EEPROM
+
+// Records of the boards (address in the EEPROM and tag)
+#define QUR_STORE_ROBOT         0       // Calibration of the servos of the Hexapod (QURHexapod)
+#define QUR_STORE_TAG_ROBOT     1
+#define QUR_STORE_JOYSTICKS     0       // Centers of the joysticks of the RF-Controller (RFControl)
+#define QUR_STORE_TAG_JOYSTICKS 2
+
+// Returns the byte N of the data of the record (called while the record is written)
+typedef uint8_t (*QURStoreSource)(void *, uint16_t);
+
+// ---------------------------------------------------------------------------
+// Reads a record of the EEPROM
+// Methods:
+//      - bool Begin(uint16_t, uint8_t, uint16_t)
+//      - void Read(void *, uint16_t)
+//      - uint8_t Read8()
+//      - uint16_t Read16()
+//      - bool End()
+// ---------------------------------------------------------------------------
+struct QURStoreReader
+{
+  uint16_t Address = 0;               // Address: Next byte of the EEPROM to read
+  uint16_t Left = 0;                  // Left: Bytes of the data not read
+  uint8_t Crc = 0;                    // Crc: CRC8 of the bytes read
+  bool Found = false;                 // Found: Begin found the record
+  bool Begin(uint16_t, uint8_t, uint16_t);  // Begin: Checks the magic, the tag and the length of the record
+  void Read(void *, uint16_t);        // Read: Copies the next bytes of the data (0 after the end)
+  uint8_t Read8();
+  uint16_t Read16();
+  bool End();                         // End: True if all the data was read and the CRC matches
+};
+
+// ---------------------------------------------------------------------------
+// Saves a record in the EEPROM in the background
+// Methods:
+//      - void Begin(uint16_t, uint8_t, uint16_t, QURStoreSource, void *)
+//      - bool Step()
+//      - uint8_t Byte(uint16_t)
+// ---------------------------------------------------------------------------
+struct QURStoreWriter
+{
+  QURStoreSource Source = NULL;       // Source: Gives the bytes of the data
+  void *Context = NULL;               // Context: Argument of the Source
+  uint16_t Address = 0;               // Address: First byte of the record in the EEPROM
+  uint16_t Length = 0;                // Length: Bytes of the data
+  uint16_t Index = 0;                 // Index: Next step (0 clears the magic, then the bytes, the magic the last one)
+  uint8_t Tag = 0;                    // Tag: Type of the record
+  uint8_t Crc = 0;                    // Crc: CRC8 of the bytes already saved
+  bool Busy = false;                  // Busy: The record is not saved yet
+  uint16_t Writes = 0;                // Writes: Bytes written to the EEPROM (wraps)
+  void Begin(uint16_t, uint8_t, uint16_t, QURStoreSource, void *);  // Begin: Starts to save the record (again if it was being saved)
+  bool Step();                        // Step: Saves the next bytes, returns true while the record is not saved
+  uint8_t Byte(uint16_t);             // Byte: Value of a step (the magic, the header, the data or the CRC)
+};
+
+#endif
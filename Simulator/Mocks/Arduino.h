@@ -0,0 +1,185 @@
+// ---------------------------------------------------------------------------
+// Arduino core mock for the Host Simulator
+//
+// BACKGROUND:
+// This header replaces <Arduino.h> when the sketches are compiled on Linux.
+// Only the part of the Arduino API used by the Hexapod and the RF-Controller
+// is implemented, every function is backed by the Simulator (SimHardware.cpp)
+// so the control logic is the same code that runs on the boards.
+//
+// The time is a deterministic virtual clock, see "SimHardware.h".
+// ---------------------------------------------------------------------------
+
+#ifndef ARDUINO_MOCK_H
+#define ARDUINO_MOCK_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#ifndef QUR_SIMULATOR
+  #define QUR_SIMULATOR
+#endif
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+// ---------------------------------------------------------------------------
+// PIN DEFINE'S (Arduino Mega numbering)
+// ---------------------------------------------------------------------------
+#define HIGH          1
+#define LOW           0
+#define INPUT         0
+#define OUTPUT        1
+#define INPUT_PULLUP  2
+
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+#define A4  58
+#define A5  59
+#define A6  60
+#define A7  61
+
+#define SIM_PINS 70     // Number of pins emulated by the Simulator
+
+// ---------------------------------------------------------------------------
+// FLASH (PROGMEM) DEFINE'S
+// On the host the flash and the ram are the same memory. The words are copied
+// with memcpy like the AVR reads them (bytes), a table of other type is not
+// read through an alias of uint16_t.
+// ---------------------------------------------------------------------------
+#define PROGMEM
+inline uint16_t SimReadWord(const void *__ADDRESS__){
+  uint16_t value;
+  memcpy(&value, __ADDRESS__, sizeof(value));
+  return value;
+}
+inline uint32_t SimReadDword(const void *__ADDRESS__){
+  uint32_t value;
+  memcpy(&value, __ADDRESS__, sizeof(value));
+  return value;
+}
+#define pgm_read_byte(addr)   (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)   SimReadWord(addr)
+#define pgm_read_dword(addr)  SimReadDword(addr)
+
+// ---------------------------------------------------------------------------
+// INTERRUPTS DEFINE'S
+// The Simulator runs in a single thread, the timer interrupt (SimTimer) is
+// only delayed while the interrupts are disabled.
+// ---------------------------------------------------------------------------
+void SimInterrupts(bool);
+#define interrupts()    SimInterrupts(true)
+#define noInterrupts()  SimInterrupts(false)
+#define cli()           SimInterrupts(false)
+#define sei()           SimInterrupts(true)
+
+// External interrupts: every pin can have one (the number of the interrupt is the pin)
+#define CHANGE            1
+#define FALLING           2
+#define RISING            3
+#define NOT_AN_INTERRUPT  -1
+#define digitalPinToInterrupt(p)  ((p) < SIM_PINS ? (int)(p) : NOT_AN_INTERRUPT)
+void attachInterrupt(uint8_t, void (*)(), int);
+void detachInterrupt(uint8_t);
+
+// ---------------------------------------------------------------------------
+// DIGITAL / ANALOG I/O
+// ---------------------------------------------------------------------------
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int  digitalRead(uint8_t);
+int  analogRead(uint8_t);
+void analogWrite(uint8_t, int);
+
+// ---------------------------------------------------------------------------
+// TIME (Virtual clock)
+// ---------------------------------------------------------------------------
+unsigned long millis();
+unsigned long micros();
+unsigned long SimCycles();      // Nanoseconds of the host, the "cycle counter" of the simulator (free, doesn't move the clock)
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+
+// ---------------------------------------------------------------------------
+// MATH
+// ---------------------------------------------------------------------------
+long map(long, long, long, long, long);
+
+template <typename T> inline T constrain(T __VALUE__, T __LOW__, T __HIGH__){
+  return __VALUE__ < __LOW__ ? __LOW__ : (__VALUE__ > __HIGH__ ? __HIGH__ : __VALUE__);
+}
+
+// ---------------------------------------------------------------------------
+// STRING
+// Minimal version of the Arduino String built over std::string.
+// ---------------------------------------------------------------------------
+class String
+{
+  std::string Buffer;
+public:
+  String(const char *__TEXT__ = "") : Buffer(__TEXT__ ? __TEXT__ : "") {}
+  String(const std::string &__TEXT__) : Buffer(__TEXT__) {}
+  String(char __CHAR__) : Buffer(1, __CHAR__) {}
+  String(int __VALUE__) : Buffer(std::to_string(__VALUE__)) {}
+  String(unsigned int __VALUE__) : Buffer(std::to_string(__VALUE__)) {}
+  String(long __VALUE__) : Buffer(std::to_string(__VALUE__)) {}
+  String(unsigned long __VALUE__) : Buffer(std::to_string(__VALUE__)) {}
+  String(double __VALUE__) : Buffer(std::to_string(__VALUE__)) {}
+  const char *c_str() const { return Buffer.c_str(); }
+  unsigned int length() const { return (unsigned int)Buffer.size(); }
+  String &operator+=(const String &__OTHER__) { Buffer += __OTHER__.Buffer; return *this; }
+  String &operator+=(char __CHAR__) { Buffer += __CHAR__; return *this; }
+  friend String operator+(const String &__A__, const String &__B__) { return String(__A__.Buffer + __B__.Buffer); }
+  friend String operator+(const char *__A__, const String &__B__) { return String(std::string(__A__) + __B__.Buffer); }
+  friend String operator+(const String &__A__, const char *__B__) { return String(__A__.Buffer + __B__); }
+  bool operator==(const String &__OTHER__) const { return Buffer == __OTHER__.Buffer; }
+};
+
+// ---------------------------------------------------------------------------
+// SERIAL
+// Every port captures what the sketch sends and provides the bytes injected
+// by the Simulator.
+// ---------------------------------------------------------------------------
+class HardwareSerial
+{
+  int Port;
+public:
+  explicit HardwareSerial(int __PORT__) : Port(__PORT__) {}
+  void begin(unsigned long);
+  void end() {}
+  int  available();
+  int  peek();
+  int  read();
+  int  availableForWrite();
+  void flush() {}
+  size_t write(uint8_t);
+  size_t write(const uint8_t *, size_t);
+  size_t print(const String &);
+  size_t print(const char *);
+  size_t print(char);
+  size_t print(int);
+  size_t print(unsigned int);
+  size_t print(long);
+  size_t print(unsigned long);
+  size_t println();
+  size_t println(const String &);
+  size_t println(const char *);
+  size_t println(char);
+  size_t println(int);
+  size_t println(unsigned int);
+  size_t println(long);
+  size_t println(unsigned long);
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
+
+#endif
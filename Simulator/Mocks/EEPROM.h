@@ -0,0 +1,29 @@
+// ---------------------------------------------------------------------------
+// EEPROM library mock for the Host Simulator
+//
+// The bytes live in the Simulator (SimHardware.h -> SimEEPROM), erased (0xFF)
+// when the program starts. Like the AVR a write takes SIM_EEPROM_WRITE
+// microseconds of the virtual clock in the background: eeprom_is_ready() is
+// false meanwhile, and a read or a write started before waits (advances the
+// clock) until the last write ends.
+// ---------------------------------------------------------------------------
+
+#ifndef EEPROM_MOCK_H
+#define EEPROM_MOCK_H
+
+#include <Arduino.h>
+
+class EEPROMClass
+{
+public:
+  uint8_t read(int);
+  void write(int, uint8_t);
+  void update(int, uint8_t);
+  uint16_t length();
+};
+
+bool eeprom_is_ready();
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,65 @@
+// ---------------------------------------------------------------------------
+// RF24 library mock for the Host Simulator
+//
+// All the radios share the same virtual air (SimHardware.h -> SimRadio), a
+// payload written by one radio is delivered to every radio listening in the
+// same channel and address, so the RF-Controller and the Hexapod can talk
+// inside the same process. The receiver can load ACK payloads (up to 3, like
+// the TX FIFO of the nRF24) that return to the writer with the ACK, and
+// startWrite() ends at once: his result is read with whatHappened().
+// ---------------------------------------------------------------------------
+
+#ifndef RF24_H
+#define RF24_H
+
+#include <Arduino.h>
+
+typedef enum { RF24_PA_MIN = 0, RF24_PA_LOW, RF24_PA_HIGH, RF24_PA_MAX, RF24_PA_ERROR } rf24_pa_dbm_e;
+typedef enum { RF24_1MBPS = 0, RF24_2MBPS, RF24_250KBPS } rf24_datarate_e;
+
+class RF24
+{
+  uint16_t CE;
+  uint16_t CSN;
+  uint8_t Channel = 76;
+  uint8_t ReadAddress[6][5];
+  bool ReadPipeOpen[6];
+  uint8_t WriteAddress[5];
+  bool Listening = false;
+  bool Dynamic = false;
+  bool AckPayload = false;
+  int  ID = -1;
+public:
+  RF24(uint16_t, uint16_t);
+  ~RF24();
+  bool begin();
+  void setChannel(uint8_t);
+  uint8_t getChannel();
+  void setPALevel(uint8_t);
+  bool setDataRate(rf24_datarate_e);
+  void openReadingPipe(uint8_t, const uint8_t *);
+  void openWritingPipe(const uint8_t *);
+  void startListening();
+  void stopListening();
+  bool available();
+  bool available(uint8_t *);
+  uint8_t getPayloadSize();
+  void enableDynamicPayloads();
+  void enableAckPayload();
+  void writeAckPayload(uint8_t, const void *, uint8_t);
+  bool isAckPayloadAvailable();
+  void setRetries(uint8_t, uint8_t);
+  void startWrite(const void *, uint8_t, const bool);
+  uint8_t flush_tx();
+  uint8_t getDynamicPayloadSize();
+  void maskIRQ(bool, bool, bool);
+  void whatHappened(bool &, bool &, bool &);
+  void read(void *, uint8_t);
+  bool write(const void *, uint8_t);
+
+  // Used by the Simulator to route the payloads and wire the IRQ
+  bool Accepts(uint8_t, const uint8_t *) const;
+  uint16_t CEPin() const;
+};
+
+#endif
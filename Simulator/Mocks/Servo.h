@@ -0,0 +1,36 @@
+// ---------------------------------------------------------------------------
+// Servo library mock for the Host Simulator
+//
+// Every write is recorded by the Simulator (SimHardware.h -> SimServo) with
+// the pulse width and the virtual time, like the real library it accepts
+// degrees (value < MIN_PULSE_WIDTH) or microseconds.
+// ---------------------------------------------------------------------------
+
+#ifndef SERVO_MOCK_H
+#define SERVO_MOCK_H
+
+#include <Arduino.h>
+
+#define MIN_PULSE_WIDTH       544     // the shortest pulse sent to a servo
+#define MAX_PULSE_WIDTH      2400     // the longest pulse sent to a servo
+#define DEFAULT_PULSE_WIDTH  1500     // default pulse width when servo is attached
+#define INVALID_SERVO         255     // flag indicating an invalid servo index
+
+class Servo
+{
+  int8_t Pin = -1;
+  int Min = MIN_PULSE_WIDTH;
+  int Max = MAX_PULSE_WIDTH;
+  int Pulse = DEFAULT_PULSE_WIDTH;
+public:
+  uint8_t attach(int);
+  uint8_t attach(int, int, int);
+  void detach();
+  void write(int);
+  void writeMicroseconds(int);
+  int  read();
+  int  readMicroseconds();
+  bool attached();
+};
+
+#endif
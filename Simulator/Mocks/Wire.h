@@ -0,0 +1,41 @@
+// ---------------------------------------------------------------------------
+// Wire (I2C) library mock for the Host Simulator
+//
+// The transactions go to the devices of the virtual bus (SimHardware.h ->
+// SimI2C), endTransmission() returns 2 (address NACK) when nobody answers.
+// Like the AVR library a transaction only holds BUFFER_LENGTH bytes, the
+// rest are dropped, and every transaction consumes the time of his bits in
+// the virtual clock. endTransmission(false) ends with a repeated START: the
+// PCA9685 model applies his outputs only on the STOP.
+// ---------------------------------------------------------------------------
+
+#ifndef WIRE_MOCK_H
+#define WIRE_MOCK_H
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+#define WIRE_HAS_TIMEOUT      // Like the AVR core since 1.8.2 (the virtual bus never gets stuck)
+
+class TwoWire
+{
+  uint8_t Address = 0;
+  uint8_t Buffer[BUFFER_LENGTH];
+  uint8_t Length = 0;
+  uint32_t Clock = 100000UL;
+public:
+  void begin();
+  void setClock(uint32_t);
+  void beginTransmission(uint8_t);
+  size_t write(uint8_t);
+  size_t write(const uint8_t *, size_t);
+  uint8_t endTransmission(bool = true);
+  void setWireTimeout(uint32_t = 25000, bool = false);
+  uint8_t requestFrom(uint8_t, uint8_t);
+  int available();
+  int read();
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,149 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - RF-Controller
+//
+// Runs the sketch "RFControl.ino" headless over the virtual hardware with a
+// virtual receiver that decodes the packets (QURPacket.h) and answers every
+// one with a STATUS in the ACK (like the Hexapod), the left joystick
+// turns in circle once per virtual second (or stays still with --still). The virtual
+// ModuleLCD answers every line (QURLCDLink.h) with an ACK, the report includes
+// the rate of the RF in virtual time, the longest gap between two packets and
+// the lines sent to the LCD, the virtual milliseconds of setup() (boot_ms)
+// and the time of the first packet since the reset (first_packet_ms).
+//
+// USAGE:
+//   SimController [--ticks N] [--call-cost MICROS] [--lcd-silent] [--still] [--capture FILE] [--eeprom FILE]
+//     --ticks N            Number of calls to loop() (DEFAULT: 100000)
+//     --call-cost MICROS   Virtual microseconds consumed by millis()/micros() (DEFAULT: 4)
+//     --lcd-silent         The ModuleLCD never answers the lines (the RF must keep his rate)
+//     --still              The joystick stays pushed to one side (only the keepalives are sent)
+//     --capture FILE       Saves the packets received as a session (SimSession.h, see SimReplay)
+//     --eeprom FILE        EEPROM of the board: read before setup() (if the file exists) and saved at
+//                          the end, the second run boots with the centers saved by the first one
+// ---------------------------------------------------------------------------
+
+#include "SimHardware.h"
+#include "SimSession.h"
+#include <Arduino.h>
+#include <RF24.h>
+#include <QURPacket.h>
+#include <RFController.h>
+#include <stdio.h>
+#include <chrono>
+
+void setup();
+void loop();
+extern RFControl QUR001Control;
+
+int main(int argc, char **argv){
+  unsigned long ticks = 100000UL;
+  bool silent = false, still = false;
+  const char *capture = NULL;
+  const char *eeprom = NULL;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--ticks") && x + 1 < argc)          ticks = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--call-cost") && x + 1 < argc) SimClock::SetCallCost(strtoul(argv[++x], NULL, 10));
+    else if(!strcmp(argv[x], "--lcd-silent"))                silent = true;
+    else if(!strcmp(argv[x], "--still"))                     still = true;
+    else if(!strcmp(argv[x], "--capture") && x + 1 < argc)   capture = argv[++x];
+    else if(!strcmp(argv[x], "--eeprom") && x + 1 < argc)    eeprom = argv[++x];
+    else {
+      fprintf(stderr, "usage: %s [--ticks N] [--call-cost MICROS] [--lcd-silent] [--still] [--capture FILE] [--eeprom FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+  SimSerial::Capture(0, true);
+
+  // Receiver: Plays the role of the Hexapod antenna
+  const uint8_t address[6] = "0";
+  RF24 receiver(0, 0);
+  receiver.begin();
+  receiver.setChannel(115);
+  receiver.openReadingPipe(1, address);
+  receiver.enableDynamicPayloads();
+  receiver.enableAckPayload();
+  receiver.startListening();
+  QURPacketWriter answer;
+  QURStatus status;
+  uint8_t ack[QUR_PACKET_MAX];
+  receiver.writeAckPayload(1, ack, answer.Status(status, ack));
+
+  // The joysticks are released while the controller calibrates his center
+  SimPins::SetAnalog(A0, 512);
+  SimPins::SetAnalog(A1, 512);
+  SimPins::SetAnalog(A2, 512);
+  SimPins::SetAnalog(A3, 512);
+
+  // The LCD module answers every line with an ACK (there is no handshake, setup() doesn't wait him)
+  if(eeprom)
+    SimEEPROM::Load(eeprom);          // A controller that was powered before (the first time the EEPROM is erased)
+  uint32_t reset = SimClock::Micros();
+  setup();
+  uint32_t boot = SimClock::Micros() - reset;
+  SimSerial::Clear(0);
+  SimSessionWriter session;
+  if(capture && !session.Open(capture)){
+    perror(capture);
+    return 1;
+  }
+  uint32_t sessionStart = SimClock::Micros();
+  QURLCDParser module;
+  uint8_t frame[QUR_LCD_FRAME_MAX];
+  uint32_t received = 0, bytes = 0, screens = 0;
+  uint32_t sent = SimRadio::Sent(), first = 0, last = 0, gap = 0;
+  uint8_t payload[QUR_PACKET_MAX];
+  QURPacketReader reader;
+  QURCommand command;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(unsigned long x = 0; x < ticks; x++){
+    double phase = still ? 0.0 : (SimClock::Micros() % 1000000UL) * 2 * M_PI / 1e6;
+    SimPins::SetAnalog(A0, 512 + (int)(400 * cos(phase)));
+    SimPins::SetAnalog(A1, 512 + (int)(400 * sin(phase)));
+    loop();
+    std::string &lcd = SimSerial::Output(0);
+    for(size_t y = 0; y < lcd.size(); y++){
+      if(module.Feed((uint8_t)lcd[y]) != QUR_LCD_LINE)
+        continue;
+      screens++;
+      if(!silent)
+        SimSerial::Inject(0, frame, QURLCDAck(module.Payload()[0], frame));
+    }
+    SimSerial::Clear(0);
+    if(SimRadio::Sent() != sent){
+      uint32_t now = SimClock::Micros();
+      if(sent == 0)                 first = now;
+      else if(now - last > gap)     gap = now - last;
+      sent = SimRadio::Sent();
+      last = now;
+    }
+    while(receiver.available()){
+      uint8_t length = receiver.getDynamicPayloadSize();
+      receiver.read(payload, length);
+      session.Add(SimClock::Micros() - sessionStart, payload, length);
+      reader.Decode(payload, length, command);
+      bytes += length;
+      received++;
+    }
+    if(received != status.Received){              // One STATUS per batch, like the Hexapod
+      status.Received = received;
+      status.Lost = reader.Lost;
+      status.Errors = reader.Errors;
+      receiver.writeAckPayload(1, ack, answer.Status(status, ack));
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double send_hz = sent > 1 && last != first ? (sent - 1) * 1e6 / (double)(last - first) : 0.0;
+  printf("ticks=%lu host_seconds=%.6f ticks_per_second=%.0f sent=%u received=%u bytes=%u errors=%u lost=%u angle=%d "
+         "virtual_seconds=%.3f send_hz=%.1f max_send_gap_us=%u lcd_lines=%u status=%u status_received=%u "
+         "boot_ms=%.3f first_packet_ms=%.3f eeprom_writes=%u\n",
+         ticks, seconds, seconds > 0 ? ticks / seconds : 0.0, SimRadio::Sent(), received, bytes,
+         reader.Errors, reader.Lost, command.Angle,
+         SimClock::Micros() / 1e6, send_hz, gap, screens,
+         QUR001Control.StatusCount(), QUR001Control.Status().Received,
+         boot / 1e3, (first - reset) / 1e3, SimEEPROM::Writes());
+  session.Close();
+  if(eeprom && !SimEEPROM::Save(eeprom)){
+    perror(eeprom);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,755 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - Hardware layer
+//
+// See "SimHardware.h" for the description of the virtual hardware.
+// ---------------------------------------------------------------------------
+
+#include "SimHardware.h"
+#include <Arduino.h>
+#include <Servo.h>
+#include <RF24.h>
+#include <Wire.h>
+#include <EEPROM.h>
+#include <chrono>
+#include <deque>
+#include <stdio.h>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// VIRTUAL CLOCK
+// ---------------------------------------------------------------------------
+static uint32_t ClockMicros   = 0;   // ClockMicros: Current time (wraps like the AVR counter)
+static uint32_t ClockCallCost = 4;   // ClockCallCost: Microseconds consumed by millis()/micros()
+
+static SimTimerCallback TimerCallback = NULL;   // TimerCallback: Interrupt attached with SimTimer
+static uint32_t TimerPeriod = 0;
+static uint32_t TimerNext   = 0;                // TimerNext: Time of the next interrupt
+static uint32_t TimerFired  = 0;
+static bool     TimerRunning = false;           // TimerRunning: The callback is running (no nesting)
+static bool     InterruptsEnabled = true;       // InterruptsEnabled: Changed by interrupts()/noInterrupts()
+
+static void RunPendingInterrupts();
+
+void SimInterrupts(bool __STATE__){
+  InterruptsEnabled = __STATE__;
+  if(__STATE__) RunPendingInterrupts();       // The edges that arrived with the interrupts disabled
+}
+
+// Moves the clock and fires the timer interrupt for every period crossed
+static void ClockAdvance(uint32_t __MICROS__){
+  uint32_t target = ClockMicros + __MICROS__;
+  while(TimerCallback && !TimerRunning && InterruptsEnabled && (int32_t)(target - TimerNext) >= 0){
+    ClockMicros = TimerNext;
+    TimerNext += TimerPeriod;
+    TimerFired++;
+    TimerRunning = true;
+    TimerCallback();
+    TimerRunning = false;
+    InterruptsEnabled = true;                 // Like the return of an ISR (reti)
+    if((int32_t)(ClockMicros - target) > 0)   // The callback consumed more time than requested
+      target = ClockMicros;
+  }
+  ClockMicros = target;
+}
+
+uint32_t SimClock::Micros(){ return ClockMicros; }
+void SimClock::Advance(uint32_t __MICROS__){ ClockAdvance(__MICROS__); }
+void SimClock::SetCallCost(uint32_t __MICROS__){ ClockCallCost = __MICROS__; }
+uint32_t SimClock::CallCost(){ return ClockCallCost; }
+void SimClock::Reset(uint32_t __MICROS__){ ClockMicros = __MICROS__; TimerNext = __MICROS__ + TimerPeriod; }
+void SimClock::SetTime(uint32_t __MICROS__){ ClockMicros = __MICROS__; }
+
+void SimTimer::Attach(uint32_t __PERIOD__, SimTimerCallback __CALLBACK__){
+  TimerPeriod   = __PERIOD__ ? __PERIOD__ : 1;
+  TimerNext     = ClockMicros + TimerPeriod;
+  TimerFired    = 0;
+  TimerCallback = __CALLBACK__;
+}
+void SimTimer::Detach(){ TimerCallback = NULL; }
+uint32_t SimTimer::Fired(){ return TimerFired; }
+
+unsigned long micros(){
+  ClockAdvance(ClockCallCost);
+  return ClockMicros;
+}
+
+unsigned long SimCycles(){
+  return (unsigned long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long millis(){
+  ClockAdvance(ClockCallCost);
+  return ClockMicros / 1000UL;
+}
+
+void delay(unsigned long __MILLIS__){
+  ClockAdvance((uint32_t)(__MILLIS__ * 1000UL));
+}
+
+void delayMicroseconds(unsigned int __MICROS__){
+  ClockAdvance(__MICROS__);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max){
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// ---------------------------------------------------------------------------
+// GPIO
+// ---------------------------------------------------------------------------
+static int PinInput[SIM_PINS];
+static int PinOutput[SIM_PINS];
+static int PinMode[SIM_PINS];
+
+void SimPins::SetAnalog(uint8_t __PIN__, int __VALUE__){ if(__PIN__ < SIM_PINS) PinInput[__PIN__] = __VALUE__; }
+typedef void (*PinHandler)();
+static PinHandler PinInterrupt[SIM_PINS];       // PinInterrupt: Handler attached to the pin
+static int  PinInterruptMode[SIM_PINS];
+static bool PinPending[SIM_PINS];               // PinPending: Edge waiting for interrupts()
+static bool PinRunning = false;                 // PinRunning: A pin interrupt is running (no nesting, like AVR)
+
+static void RunPinInterrupt(uint8_t __PIN__){
+  PinPending[__PIN__] = false;
+  PinRunning = true;
+  InterruptsEnabled = false;                    // The ISR starts with the interrupts disabled
+  PinInterrupt[__PIN__]();
+  InterruptsEnabled = true;                     // reti
+  PinRunning = false;
+}
+
+static void RunPendingInterrupts(){
+  if(PinRunning) return;
+  for(uint8_t x = 0; x < SIM_PINS; x++)
+    if(PinPending[x] && PinInterrupt[x] && InterruptsEnabled)
+      RunPinInterrupt(x);
+}
+
+void attachInterrupt(uint8_t __INTERRUPT__, void (*__HANDLER__)(), int __MODE__){
+  if(__INTERRUPT__ >= SIM_PINS) return;
+  PinInterrupt[__INTERRUPT__]     = __HANDLER__;
+  PinInterruptMode[__INTERRUPT__] = __MODE__;
+  PinPending[__INTERRUPT__]       = false;
+}
+
+void detachInterrupt(uint8_t __INTERRUPT__){
+  if(__INTERRUPT__ < SIM_PINS) PinInterrupt[__INTERRUPT__] = NULL;
+}
+
+void SimPins::SetDigital(uint8_t __PIN__, int __VALUE__){
+  if(__PIN__ >= SIM_PINS) return;
+  bool before = PinInput[__PIN__] != 0, after = __VALUE__ != 0;
+  PinInput[__PIN__] = __VALUE__;
+  if(PinInterrupt[__PIN__] == NULL || before == after) return;
+  int mode = PinInterruptMode[__PIN__];
+  if(mode == CHANGE || (mode == FALLING && !after) || (mode == RISING && after)){
+    PinPending[__PIN__] = true;
+    if(InterruptsEnabled && !PinRunning) RunPinInterrupt(__PIN__);
+  }
+}
+int  SimPins::Output(uint8_t __PIN__){ return __PIN__ < SIM_PINS ? PinOutput[__PIN__] : 0; }
+int  SimPins::Mode(uint8_t __PIN__){ return __PIN__ < SIM_PINS ? PinMode[__PIN__] : 0; }
+
+static uint32_t PinReads[SIM_PINS];
+static uint32_t PinReadTime[SIM_PINS];
+static int PinRead(uint8_t __PIN__){
+  if(__PIN__ >= SIM_PINS) return 0;
+  PinReads[__PIN__]++;
+  PinReadTime[__PIN__] = ClockMicros;
+  return PinInput[__PIN__];
+}
+uint32_t SimPins::Reads(uint8_t __PIN__){ return __PIN__ < SIM_PINS ? PinReads[__PIN__] : 0; }
+uint32_t SimPins::ReadTime(uint8_t __PIN__){ return __PIN__ < SIM_PINS ? PinReadTime[__PIN__] : 0; }
+
+void pinMode(uint8_t __PIN__, uint8_t __MODE__){ if(__PIN__ < SIM_PINS) PinMode[__PIN__] = __MODE__; }
+void digitalWrite(uint8_t __PIN__, uint8_t __VALUE__){ if(__PIN__ < SIM_PINS) PinOutput[__PIN__] = __VALUE__; }
+int  digitalRead(uint8_t __PIN__){ return PinRead(__PIN__) ? HIGH : LOW; }
+int  analogRead(uint8_t __PIN__){ return PinRead(__PIN__); }
+void analogWrite(uint8_t __PIN__, int __VALUE__){ if(__PIN__ < SIM_PINS) PinOutput[__PIN__] = __VALUE__; }
+
+// ---------------------------------------------------------------------------
+// SERVOS
+// ---------------------------------------------------------------------------
+static uint16_t ServoPulse[SIM_PINS];
+static uint32_t ServoWrites[SIM_PINS];
+static bool     ServoAttached[SIM_PINS];
+static uint32_t ServoTotalWrites = 0;
+static SimServoHook ServoHook = NULL;
+
+bool     SimServo::Attached(uint8_t __PIN__){ return __PIN__ < SIM_PINS && ServoAttached[__PIN__]; }
+uint16_t SimServo::Pulse(uint8_t __PIN__){ return __PIN__ < SIM_PINS ? ServoPulse[__PIN__] : 0; }
+uint32_t SimServo::Writes(uint8_t __PIN__){ return __PIN__ < SIM_PINS ? ServoWrites[__PIN__] : 0; }
+uint32_t SimServo::TotalWrites(){ return ServoTotalWrites; }
+void SimServo::SetHook(SimServoHook __HOOK__){ ServoHook = __HOOK__; }
+
+void SimServo::Attach(uint8_t __PIN__, bool __STATE__){
+  if(__PIN__ < SIM_PINS) ServoAttached[__PIN__] = __STATE__;
+}
+
+void SimServo::Record(uint8_t __PIN__, uint16_t __PULSE__){
+  if(__PIN__ >= SIM_PINS) return;
+  ServoPulse[__PIN__] = __PULSE__;
+  ServoWrites[__PIN__]++;
+  ServoTotalWrites++;
+  if(ServoHook) ServoHook(__PIN__, __PULSE__, ClockMicros);
+}
+
+uint8_t Servo::attach(int __PIN__){ return attach(__PIN__, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH); }
+
+uint8_t Servo::attach(int __PIN__, int __MIN__, int __MAX__){
+  Pin = (int8_t)__PIN__;
+  Min = __MIN__;
+  Max = __MAX__;
+  SimServo::Attach(Pin, true);
+  return (uint8_t)Pin;
+}
+
+void Servo::detach(){
+  if(Pin >= 0) SimServo::Attach(Pin, false);
+  Pin = -1;
+}
+
+void Servo::write(int __VALUE__){
+  // Like the real library values lower than MIN_PULSE_WIDTH are degrees
+  if(__VALUE__ < MIN_PULSE_WIDTH){
+    __VALUE__ = constrain(__VALUE__, 0, 180);
+    __VALUE__ = map(__VALUE__, 0, 180, Min, Max);
+  }
+  writeMicroseconds(__VALUE__);
+}
+
+void Servo::writeMicroseconds(int __VALUE__){
+  Pulse = constrain(__VALUE__, Min, Max);
+  if(Pin >= 0) SimServo::Record(Pin, (uint16_t)Pulse);
+}
+
+int  Servo::read(){ return map(Pulse + 1, Min, Max, 0, 180); }
+int  Servo::readMicroseconds(){ return Pulse; }
+bool Servo::attached(){ return Pin >= 0; }
+
+// ---------------------------------------------------------------------------
+// SERIAL PORTS
+// ---------------------------------------------------------------------------
+struct SerialState
+{
+  std::deque<uint8_t> Input;
+  std::string Output;
+  bool Capture = true;
+  unsigned long Baudrate = 0;
+  bool Throttled = false;         // Throttled: The output waits in Tx and leaves at the Baudrate
+  std::deque<uint8_t> Tx;         // Tx: TX buffer of the UART
+  uint32_t TxTime = 0;            // TxTime: Time when the first byte of Tx started to leave
+  uint32_t Blocked = 0;           // Blocked: Microseconds waited by write() with Tx full
+};
+static SerialState Ports[SIM_SERIAL_PORTS];
+
+// Moves to the output the bytes of the TX buffer that already left at the Baudrate
+static void SerialDrain(SerialState &__PORT__){
+  if(__PORT__.Tx.empty() || __PORT__.Baudrate == 0){
+    __PORT__.TxTime = ClockMicros;            // The line is idle
+    return;
+  }
+  uint64_t bytes = (uint64_t)(ClockMicros - __PORT__.TxTime) * __PORT__.Baudrate / 10000000ULL;
+  if(bytes > __PORT__.Tx.size())
+    bytes = __PORT__.Tx.size();
+  for(uint64_t x = 0; x < bytes; x++){
+    if(__PORT__.Capture){
+      if(__PORT__.Output.size() >= SIM_SERIAL_LIMIT)
+        __PORT__.Output.erase(0, SIM_SERIAL_LIMIT / 2);
+      __PORT__.Output += (char)__PORT__.Tx.front();
+    }
+    __PORT__.Tx.pop_front();
+  }
+  __PORT__.TxTime += (uint32_t)(bytes * 10000000ULL / __PORT__.Baudrate);
+}
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+HardwareSerial Serial3(3);
+
+void SimSerial::Inject(int __PORT__, const uint8_t *__DATA__, size_t __SIZE__){
+  Ports[__PORT__].Input.insert(Ports[__PORT__].Input.end(), __DATA__, __DATA__ + __SIZE__);
+}
+void SimSerial::Inject(int __PORT__, const char *__TEXT__){ Inject(__PORT__, (const uint8_t *)__TEXT__, strlen(__TEXT__)); }
+size_t SimSerial::Pending(int __PORT__){ return Ports[__PORT__].Input.size(); }
+std::string &SimSerial::Output(int __PORT__){ SerialDrain(Ports[__PORT__]); return Ports[__PORT__].Output; }   // The bytes that already left
+void SimSerial::Clear(int __PORT__){ Ports[__PORT__].Output.clear(); }
+void SimSerial::Capture(int __PORT__, bool __STATE__){ Ports[__PORT__].Capture = __STATE__; }
+unsigned long SimSerial::Baudrate(int __PORT__){ return Ports[__PORT__].Baudrate; }
+void SimSerial::Throttle(int __PORT__, bool __STATE__){ Ports[__PORT__].Throttled = __STATE__; }
+uint32_t SimSerial::Blocked(int __PORT__){ return Ports[__PORT__].Blocked; }
+
+void HardwareSerial::begin(unsigned long __BAUDRATE__){ Ports[Port].Baudrate = __BAUDRATE__; }
+int  HardwareSerial::available(){ return (int)Ports[Port].Input.size(); }
+int  HardwareSerial::availableForWrite(){
+  SerialState &port = Ports[Port];
+  if(!port.Throttled) return SIM_SERIAL_TX_BUFFER - 1;
+  SerialDrain(port);
+  return SIM_SERIAL_TX_BUFFER - 1 - (int)port.Tx.size();
+}
+
+int HardwareSerial::peek(){
+  return Ports[Port].Input.empty() ? -1 : Ports[Port].Input.front();
+}
+
+int HardwareSerial::read(){
+  if(Ports[Port].Input.empty()) return -1;
+  uint8_t value = Ports[Port].Input.front();
+  Ports[Port].Input.pop_front();
+  return value;
+}
+
+size_t HardwareSerial::write(uint8_t __BYTE__){
+  SerialState &port = Ports[Port];
+  if(port.Throttled && port.Baudrate){
+    SerialDrain(port);
+    while(port.Tx.size() >= SIM_SERIAL_TX_BUFFER - 1){   // Full buffer: the AVR waits the UART
+      uint32_t wait = (uint32_t)(10000000ULL / port.Baudrate) + 1;
+      port.Blocked += wait;
+      ClockAdvance(wait);
+      SerialDrain(port);
+    }
+    port.Tx.push_back(__BYTE__);
+    return 1;
+  }
+  if(!port.Capture) return 1;
+  if(port.Output.size() >= SIM_SERIAL_LIMIT)
+    port.Output.erase(0, SIM_SERIAL_LIMIT / 2);
+  port.Output += (char)__BYTE__;
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *__DATA__, size_t __SIZE__){
+  for(size_t x = 0; x < __SIZE__; x++)
+    write(__DATA__[x]);
+  return __SIZE__;
+}
+
+size_t HardwareSerial::print(const String &__TEXT__){ return print(__TEXT__.c_str()); }
+size_t HardwareSerial::print(const char *__TEXT__){ return write((const uint8_t *)__TEXT__, strlen(__TEXT__)); }
+size_t HardwareSerial::print(char __CHAR__){ return write((uint8_t)__CHAR__); }
+size_t HardwareSerial::print(int __VALUE__){ return print(String(__VALUE__)); }
+size_t HardwareSerial::print(unsigned int __VALUE__){ return print(String(__VALUE__)); }
+size_t HardwareSerial::print(long __VALUE__){ return print(String(__VALUE__)); }
+size_t HardwareSerial::print(unsigned long __VALUE__){ return print(String(__VALUE__)); }
+size_t HardwareSerial::println(){ return print("\r\n"); }
+size_t HardwareSerial::println(const String &__TEXT__){ return print(__TEXT__) + println(); }
+size_t HardwareSerial::println(const char *__TEXT__){ return print(__TEXT__) + println(); }
+size_t HardwareSerial::println(char __CHAR__){ return print(__CHAR__) + println(); }
+size_t HardwareSerial::println(int __VALUE__){ return print(__VALUE__) + println(); }
+size_t HardwareSerial::println(unsigned int __VALUE__){ return print(__VALUE__) + println(); }
+size_t HardwareSerial::println(long __VALUE__){ return print(__VALUE__) + println(); }
+size_t HardwareSerial::println(unsigned long __VALUE__){ return print(__VALUE__) + println(); }
+
+// ---------------------------------------------------------------------------
+// RADIO
+// Every radio have a RX FIFO of 3 payloads like the nRF24L01+, if the FIFO
+// is full the payload is not acknowledged and write() returns false. The ACK
+// payloads wait in the TX FIFO of the receiver (3 payloads) and the first one
+// goes to the RX FIFO of the writer with the ACK.
+// ---------------------------------------------------------------------------
+#define SIM_RADIO_FIFO      3
+#define SIM_RADIO_PAYLOAD  32
+
+struct RadioState
+{
+  RF24 *Radio = NULL;
+  std::deque<std::vector<uint8_t> > FIFO;
+  std::deque<std::vector<uint8_t> > Acks;   // Acks: ACK payloads loaded (TX FIFO of the receiver)
+  bool RxReady = false;           // RxReady: Flag RX_DR of the status register
+  bool TxOk = false;              // TxOk: Flag TX_DS (the last startWrite was acknowledged)
+  bool TxFail = false;            // TxFail: Flag MAX_RT (the last startWrite was not acknowledged)
+  bool MaskRx = false;            // MaskRx: RX_DR doesn't drive the IRQ
+  int  IRQPin = -1;               // IRQPin: Pin connected to the IRQ (-1 = not connected)
+};
+// Radios: Function-static so the global RF24 of the sketches can register during the static initialization
+static std::vector<RadioState> &RadioList(){
+  static std::vector<RadioState> radios;
+  return radios;
+}
+#define Radios RadioList()
+static uint8_t RadioIRQ[SIM_PINS];              // RadioIRQ: Pin of the IRQ + 1 by CE pin (0 = not wired)
+
+// The IRQ is active low while a not masked flag is set
+static void RadioUpdateIRQ(RadioState &__STATE__){
+  if(__STATE__.IRQPin < 0) return;
+  SimPins::SetDigital((uint8_t)__STATE__.IRQPin, (__STATE__.RxReady && !__STATE__.MaskRx) ? LOW : HIGH);
+}
+
+void SimRadio::WireIRQ(uint8_t __CE__, uint8_t __PIN__){
+  if(__CE__ >= SIM_PINS || __PIN__ >= SIM_PINS) return;
+  RadioIRQ[__CE__] = __PIN__ + 1;
+  SimPins::SetDigital(__PIN__, HIGH);
+  for(size_t x = 0; x < Radios.size(); x++)
+    if(Radios[x].Radio && Radios[x].Radio->CEPin() == __CE__)
+      Radios[x].IRQPin = __PIN__;
+}
+static uint32_t RadioSent = 0;
+static uint32_t RadioDelivered = 0;
+static uint8_t  RadioLoss = 0;                  // RadioLoss: Percent of payloads lost in the air
+static uint32_t RadioRandom = 1;
+
+void SimRadio::SetLoss(uint8_t __PERCENT__, uint32_t __SEED__){
+  RadioLoss   = __PERCENT__;
+  RadioRandom = __SEED__;
+}
+
+void SimRadio::Reset(){
+  for(size_t x = 0; x < Radios.size(); x++){
+    Radios[x].FIFO.clear();
+    Radios[x].Acks.clear();
+  }
+  RadioSent = RadioDelivered = 0;
+}
+uint32_t SimRadio::Sent(){ return RadioSent; }
+uint32_t SimRadio::Delivered(){ return RadioDelivered; }
+uint32_t SimRadio::Lost(){ return RadioSent - RadioDelivered; }
+
+RF24::RF24(uint16_t __CE__, uint16_t __CSN__) : CE(__CE__), CSN(__CSN__){
+  memset(ReadAddress, 0, sizeof(ReadAddress));
+  memset(ReadPipeOpen, 0, sizeof(ReadPipeOpen));
+  memset(WriteAddress, 0, sizeof(WriteAddress));
+  ID = (int)Radios.size();
+  RadioState state;
+  state.Radio = this;
+  Radios.push_back(state);
+}
+
+RF24::~RF24(){
+  if(ID >= 0 && ID < (int)Radios.size()){
+    Radios[ID].Radio = NULL;
+    Radios[ID].FIFO.clear();
+    Radios[ID].Acks.clear();
+  }
+}
+
+bool RF24::begin(){
+  if(CE < SIM_PINS && RadioIRQ[CE]){          // Wired before the sketch created the radio
+    Radios[ID].IRQPin = RadioIRQ[CE] - 1;
+    SimPins::SetDigital((uint8_t)Radios[ID].IRQPin, HIGH);
+  }
+  return true;
+}
+uint16_t RF24::CEPin() const { return CE; }
+
+void RF24::maskIRQ(bool, bool, bool __RX__){
+  Radios[ID].MaskRx = __RX__;
+  RadioUpdateIRQ(Radios[ID]);
+}
+
+void RF24::whatHappened(bool &__TX_OK__, bool &__TX_FAIL__, bool &__RX_READY__){
+  __TX_OK__   = Radios[ID].TxOk;
+  __TX_FAIL__ = Radios[ID].TxFail;
+  __RX_READY__ = Radios[ID].RxReady;
+  Radios[ID].TxOk = Radios[ID].TxFail = false;
+  Radios[ID].RxReady = false;                 // Clears the flags, the IRQ goes high
+  RadioUpdateIRQ(Radios[ID]);
+}
+void RF24::setChannel(uint8_t __CHANNEL__){ Channel = __CHANNEL__; }
+uint8_t RF24::getChannel(){ return Channel; }
+void RF24::setPALevel(uint8_t){}
+bool RF24::setDataRate(rf24_datarate_e){ return true; }
+uint8_t RF24::getPayloadSize(){ return SIM_RADIO_PAYLOAD; }
+void RF24::enableDynamicPayloads(){ Dynamic = true; }
+void RF24::enableAckPayload(){ AckPayload = true; }
+void RF24::setRetries(uint8_t, uint8_t){}
+bool RF24::isAckPayloadAvailable(){ return AckPayload && available(); }
+
+void RF24::writeAckPayload(uint8_t, const void *__BUFFER__, uint8_t __SIZE__){
+  if(!AckPayload || Radios[ID].Acks.size() >= SIM_RADIO_FIFO) return;
+  if(__SIZE__ > SIM_RADIO_PAYLOAD) __SIZE__ = SIM_RADIO_PAYLOAD;
+  const uint8_t *data = (const uint8_t *)__BUFFER__;
+  Radios[ID].Acks.push_back(std::vector<uint8_t>(data, data + __SIZE__));
+}
+
+uint8_t RF24::flush_tx(){
+  Radios[ID].Acks.clear();
+  return 0;
+}
+
+void RF24::startWrite(const void *__BUFFER__, uint8_t __SIZE__, const bool){
+  bool acknowledged = write(__BUFFER__, __SIZE__);
+  Radios[ID].TxOk   = acknowledged;
+  Radios[ID].TxFail = !acknowledged;
+}
+
+uint8_t RF24::getDynamicPayloadSize(){
+  std::deque<std::vector<uint8_t> > &fifo = Radios[ID].FIFO;
+  return fifo.empty() ? 0 : (uint8_t)fifo.front().size();
+}
+
+void RF24::openReadingPipe(uint8_t __PIPE__, const uint8_t *__ADDRESS__){
+  if(__PIPE__ > 5) return;
+  memcpy(ReadAddress[__PIPE__], __ADDRESS__, 5);
+  ReadPipeOpen[__PIPE__] = true;
+}
+
+void RF24::openWritingPipe(const uint8_t *__ADDRESS__){ memcpy(WriteAddress, __ADDRESS__, 5); }
+void RF24::startListening(){ Listening = true; }
+void RF24::stopListening(){ Listening = false; }
+bool RF24::available(){ return !Radios[ID].FIFO.empty(); }
+
+bool RF24::available(uint8_t *__PIPE__){
+  if(__PIPE__) *__PIPE__ = 1;
+  return available();
+}
+
+void RF24::read(void *__BUFFER__, uint8_t __SIZE__){
+  std::deque<std::vector<uint8_t> > &fifo = Radios[ID].FIFO;
+  memset(__BUFFER__, 0, __SIZE__);
+  if(fifo.empty()) return;
+  size_t size = fifo.front().size() < __SIZE__ ? fifo.front().size() : __SIZE__;
+  memcpy(__BUFFER__, fifo.front().data(), size);
+  fifo.pop_front();
+  Radios[ID].RxReady = false;                 // read() clears RX_DR like the RF24 library
+  RadioUpdateIRQ(Radios[ID]);
+}
+
+bool RF24::Accepts(uint8_t __CHANNEL__, const uint8_t *__ADDRESS__) const {
+  if(!Listening || Channel != __CHANNEL__) return false;
+  for(int x = 0; x < 6; x++)
+    if(ReadPipeOpen[x] && memcmp(ReadAddress[x], __ADDRESS__, 5) == 0)
+      return true;
+  return false;
+}
+
+bool RF24::write(const void *__BUFFER__, uint8_t __SIZE__){
+  if(__SIZE__ > SIM_RADIO_PAYLOAD) __SIZE__ = SIM_RADIO_PAYLOAD;
+  RadioSent++;
+  if(RadioLoss){                                // Lost in the air: nobody receives it and there is no ACK
+    RadioRandom = RadioRandom * 1103515245UL + 12345UL;
+    if((RadioRandom >> 8) % 100 < RadioLoss) return false;
+  }
+  bool acknowledged = false;
+  const uint8_t *data = (const uint8_t *)__BUFFER__;
+  for(size_t x = 0; x < Radios.size(); x++){
+    RF24 *radio = Radios[x].Radio;
+    if(radio == NULL || radio == this || !radio->Accepts(Channel, WriteAddress)) continue;
+    if(Radios[x].FIFO.size() >= SIM_RADIO_FIFO) continue;
+    // Without dynamic payloads the nRF24 always sends the fixed payload (padded with zeros)
+    std::vector<uint8_t> payload(data, data + __SIZE__);
+    if(!Dynamic) payload.resize(SIM_RADIO_PAYLOAD, 0);
+    Radios[x].FIFO.push_back(payload);
+    if(!acknowledged && radio->AckPayload && AckPayload && !Radios[x].Acks.empty()){
+      if(Radios[ID].FIFO.size() < SIM_RADIO_FIFO){  // The ACK brings the first payload of the receiver
+        Radios[ID].FIFO.push_back(Radios[x].Acks.front());
+        Radios[ID].RxReady = true;
+        RadioUpdateIRQ(Radios[ID]);
+      }
+      Radios[x].Acks.pop_front();
+    }
+    Radios[x].RxReady = true;                 // RX_DR: the IRQ goes low (the interrupt can run here)
+    RadioUpdateIRQ(Radios[x]);
+    acknowledged = true;
+  }
+  if(acknowledged) RadioDelivered++;
+  return acknowledged;
+}
+
+// ---------------------------------------------------------------------------
+// I2C BUS
+// ---------------------------------------------------------------------------
+#define SIM_PCA9685_MODE1     0x00
+#define SIM_PCA9685_MODE2     0x01
+#define SIM_PCA9685_LED0      0x06
+#define SIM_PCA9685_OUTPUTS   64      // Registers of the 16 channels (ON_L, ON_H, OFF_L, OFF_H)
+#define SIM_PCA9685_PRESCALE  0xFE
+
+struct I2CDevice
+{
+  uint8_t Address;
+  uint8_t Registers[256];
+  uint8_t Outputs[SIM_PCA9685_OUTPUTS];   // Outputs: Registers of the channels that the PWM uses (copied on the STOP)
+  uint8_t Pointer = 0;            // Pointer: Register of the next byte
+};
+static std::vector<I2CDevice> I2CDevices;
+static uint32_t I2CTransactions = 0;
+static uint32_t I2CBytes = 0;
+
+TwoWire Wire;
+
+static I2CDevice *I2CFind(uint8_t __ADDRESS__){
+  for(size_t x = 0; x < I2CDevices.size(); x++)
+    if(I2CDevices[x].Address == __ADDRESS__)
+      return &I2CDevices[x];
+  return NULL;
+}
+
+// Next register after a byte: auto-increment only with MODE1 AI (bit 5)
+static void PCA9685Next(I2CDevice &__DEVICE__){
+  if(__DEVICE__.Registers[SIM_PCA9685_MODE1] & 0x20)
+    __DEVICE__.Pointer++;
+}
+
+static void PCA9685Write(I2CDevice &__DEVICE__, uint8_t __VALUE__){
+  uint8_t reg = __DEVICE__.Pointer;
+  // The PRESCALE is blocked while the oscillator runs (MODE1 SLEEP = 0)
+  if(reg != SIM_PCA9685_PRESCALE || (__DEVICE__.Registers[SIM_PCA9685_MODE1] & 0x10))
+    __DEVICE__.Registers[reg] = __VALUE__;
+  PCA9685Next(__DEVICE__);
+}
+
+void SimI2C::AddPCA9685(uint8_t __ADDRESS__){
+  if(I2CFind(__ADDRESS__)) return;
+  I2CDevice device;
+  device.Address = __ADDRESS__;
+  memset(device.Registers, 0, sizeof(device.Registers));
+  memset(device.Outputs, 0, sizeof(device.Outputs));
+  device.Registers[SIM_PCA9685_MODE1]    = 0x11;   // Power on: SLEEP and ALLCALL
+  device.Registers[SIM_PCA9685_PRESCALE] = 0x1E;   // Power on: 200 Hz
+  I2CDevices.push_back(device);
+}
+
+uint16_t SimI2C::PCA9685Counts(uint8_t __ADDRESS__, uint8_t __CHANNEL__){
+  I2CDevice *device = I2CFind(__ADDRESS__);
+  if(device == NULL || __CHANNEL__ > 15) return 0;
+  uint8_t *led = &device->Outputs[4 * __CHANNEL__];
+  uint16_t on  = (led[0] | (led[1] << 8)) & 0x0FFF;
+  uint16_t off = (led[2] | (led[3] << 8)) & 0x0FFF;
+  return (uint16_t)((off - on) & 0x0FFF);
+}
+
+uint16_t SimI2C::PCA9685Pulse(uint8_t __ADDRESS__, uint8_t __CHANNEL__){
+  I2CDevice *device = I2CFind(__ADDRESS__);
+  if(device == NULL) return 0;
+  uint32_t period = device->Registers[SIM_PCA9685_PRESCALE] + 1UL;   // Oscillator cycles per count (25 MHz)
+  return (uint16_t)((PCA9685Counts(__ADDRESS__, __CHANNEL__) * period + 12) / 25);
+}
+
+uint32_t SimI2C::Transactions(){ return I2CTransactions; }
+uint32_t SimI2C::Bytes(){ return I2CBytes; }
+
+void TwoWire::begin(){ Length = 0; }
+void TwoWire::setClock(uint32_t __CLOCK__){ Clock = __CLOCK__ ? __CLOCK__ : 100000UL; }
+void TwoWire::setWireTimeout(uint32_t, bool){}
+
+void TwoWire::beginTransmission(uint8_t __ADDRESS__){
+  Address = __ADDRESS__;
+  Length  = 0;
+}
+
+size_t TwoWire::write(uint8_t __BYTE__){
+  if(Length >= BUFFER_LENGTH) return 0;      // Like the AVR library: the buffer is full
+  Buffer[Length++] = __BYTE__;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *__DATA__, size_t __SIZE__){
+  size_t written = 0;
+  while(written < __SIZE__ && write(__DATA__[written]))
+    written++;
+  return written;
+}
+
+uint8_t TwoWire::endTransmission(bool __STOP__){
+  I2CTransactions++;
+  I2CBytes += Length + 1;
+  ClockAdvance((uint32_t)(((Length + 1) * 9UL + 2) * 1000000UL / Clock));   // START, address, bytes with ACK, STOP
+  I2CDevice *device = I2CFind(Address);
+  if(device == NULL) return 2;                // Address NACK
+  if(Length){
+    device->Pointer = Buffer[0];
+    for(uint8_t x = 1; x < Length; x++)
+      PCA9685Write(*device, Buffer[x]);
+  }
+  // MODE2 OCH = 0: the channels change on the STOP (of every expander of the bus), a repeated
+  // START keeps the old ones
+  if(device->Registers[SIM_PCA9685_MODE2] & 0x08)
+    memcpy(device->Outputs, &device->Registers[SIM_PCA9685_LED0], sizeof(device->Outputs));
+  for(size_t x = 0; __STOP__ && x < I2CDevices.size(); x++)
+    memcpy(I2CDevices[x].Outputs, &I2CDevices[x].Registers[SIM_PCA9685_LED0], sizeof(I2CDevices[x].Outputs));
+  Length = 0;
+  return 0;
+}
+
+static std::deque<uint8_t> I2CReceived;
+
+uint8_t TwoWire::requestFrom(uint8_t __ADDRESS__, uint8_t __SIZE__){
+  I2CReceived.clear();
+  I2CTransactions++;
+  I2CBytes++;
+  ClockAdvance((uint32_t)(((__SIZE__ + 1) * 9UL + 2) * 1000000UL / Clock));
+  I2CDevice *device = I2CFind(__ADDRESS__);
+  if(device == NULL) return 0;
+  for(uint8_t x = 0; x < __SIZE__; x++){
+    I2CReceived.push_back(device->Registers[device->Pointer]);
+    PCA9685Next(*device);
+  }
+  return __SIZE__;
+}
+
+int TwoWire::available(){ return (int)I2CReceived.size(); }
+
+int TwoWire::read(){
+  if(I2CReceived.empty()) return -1;
+  uint8_t value = I2CReceived.front();
+  I2CReceived.pop_front();
+  return value;
+}
+
+// ---------------------------------------------------------------------------
+// EEPROM
+// ---------------------------------------------------------------------------
+static std::vector<uint8_t> EEPROMBytes(SIM_EEPROM_SIZE, 0xFF);
+static uint32_t EEPROMReady  = 0;             // EEPROMReady: Time when the last write ends
+static bool     EEPROMBusy   = false;
+static uint32_t EEPROMWrites = 0;
+
+EEPROMClass EEPROM;
+
+bool eeprom_is_ready(){
+  if(EEPROMBusy && (int32_t)(ClockMicros - EEPROMReady) >= 0) EEPROMBusy = false;
+  return !EEPROMBusy;
+}
+
+// Waits the last write like eeprom_read_byte/eeprom_write_byte of the AVR
+static void EEPROMWait(){
+  if(!eeprom_is_ready()) ClockAdvance(EEPROMReady - ClockMicros);
+  EEPROMBusy = false;
+}
+
+uint8_t EEPROMClass::read(int __ADDRESS__){
+  EEPROMWait();
+  return (__ADDRESS__ >= 0 && (size_t)__ADDRESS__ < EEPROMBytes.size()) ? EEPROMBytes[__ADDRESS__] : 0xFF;
+}
+
+void EEPROMClass::write(int __ADDRESS__, uint8_t __VALUE__){
+  EEPROMWait();
+  if(__ADDRESS__ < 0 || (size_t)__ADDRESS__ >= EEPROMBytes.size()) return;
+  EEPROMBytes[__ADDRESS__] = __VALUE__;
+  EEPROMWrites++;
+  EEPROMReady = ClockMicros + SIM_EEPROM_WRITE;
+  EEPROMBusy  = true;
+}
+
+void EEPROMClass::update(int __ADDRESS__, uint8_t __VALUE__){
+  if(read(__ADDRESS__) != __VALUE__) write(__ADDRESS__, __VALUE__);
+}
+
+uint16_t EEPROMClass::length(){ return (uint16_t)EEPROMBytes.size(); }
+
+void SimEEPROM::Reset(uint16_t __SIZE__){
+  EEPROMBytes.assign(__SIZE__, 0xFF);
+  EEPROMBusy   = false;
+  EEPROMWrites = 0;
+}
+
+bool SimEEPROM::Load(const char *__PATH__){
+  FILE *file = fopen(__PATH__, "rb");
+  if(file == NULL) return false;
+  size_t size = fread(EEPROMBytes.data(), 1, EEPROMBytes.size(), file);
+  fclose(file);
+  return size == EEPROMBytes.size();
+}
+
+bool SimEEPROM::Save(const char *__PATH__){
+  FILE *file = fopen(__PATH__, "wb");
+  if(file == NULL) return false;
+  size_t size = fwrite(EEPROMBytes.data(), 1, EEPROMBytes.size(), file);
+  fclose(file);
+  return size == EEPROMBytes.size();
+}
+
+uint8_t SimEEPROM::Peek(uint16_t __ADDRESS__){ return __ADDRESS__ < EEPROMBytes.size() ? EEPROMBytes[__ADDRESS__] : 0xFF; }
+uint32_t SimEEPROM::Writes(){ return EEPROMWrites; }
@@ -0,0 +1,158 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - Hardware layer
+//
+// BACKGROUND:
+// The sketches are compiled for Linux against the mocks in "Mocks/" (Arduino.h,
+// Servo.h, RF24.h, Wire.h and EEPROM.h). This header is the other side of those mocks, it lets
+// a host program drive the virtual hardware: advance the clock, inject and
+// inspect Serial bytes, move the joysticks, read the servo outputs, route
+// the radio payloads, put devices in the I2C bus and keep the EEPROM of a
+// board between two runs.
+//
+// CLOCK:
+//   The clock only moves when the Simulator advances it or when the sketch
+//   calls delay(). Every call to millis()/micros() costs SimClock::CallCost()
+//   microseconds (DEFAULT: 4, like micros() on AVR) so busy-waits always end.
+//   Two runs with the same inputs produce the same outputs.
+//   To run two boards in the same process every board keeps his own time and
+//   the host moves the clock to it with SimClock::SetTime() before his loop().
+// ---------------------------------------------------------------------------
+
+#ifndef SIMHARDWARE_H
+#define SIMHARDWARE_H
+
+#include <Arduino.h>
+
+// ---------------------------------------------------------------------------
+// VIRTUAL CLOCK
+// ---------------------------------------------------------------------------
+struct SimClock
+{
+  static uint32_t Micros();               // Micros: Current time without cost
+  static void Advance(uint32_t);          // Advance: Move the clock forward N microseconds
+  static void SetCallCost(uint32_t);      // SetCallCost: Microseconds consumed by every millis()/micros() call
+  static uint32_t CallCost();
+  static void Reset(uint32_t = 0);        // Reset: Put the clock to a specific time (Allows to test the wrap)
+  static void SetTime(uint32_t);          // SetTime: Put the clock to the time of other board, the timer keeps his schedule
+};
+
+// ---------------------------------------------------------------------------
+// TIMER INTERRUPT
+// Emulates a periodic hardware interrupt: the callback is called every time
+// the virtual clock crosses a period, in the middle of the code that advanced
+// the clock (like a real interrupt). The callback never nests with itself.
+// ---------------------------------------------------------------------------
+typedef void (*SimTimerCallback)();
+
+struct SimTimer
+{
+  static void Attach(uint32_t, SimTimerCallback);   // Attach: Calls the callback every N microseconds
+  static void Detach();                             // Detach: Stops the interrupt
+  static uint32_t Fired();                          // Fired: Number of interrupts since Attach
+};
+
+// ---------------------------------------------------------------------------
+// GPIO (Digital and analog pins)
+// SetDigital fires the interrupt attached to the pin (attachInterrupt) on
+// his edge, if the interrupts are disabled it waits until interrupts().
+// ---------------------------------------------------------------------------
+struct SimPins
+{
+  static void SetAnalog(uint8_t, int);    // SetAnalog: Value returned by analogRead(pin)
+  static void SetDigital(uint8_t, int);   // SetDigital: Value returned by digitalRead(pin)
+  static int  Output(uint8_t);            // Output: Last value written with digitalWrite/analogWrite
+  static int  Mode(uint8_t);              // Mode: Last mode configured with pinMode
+  static uint32_t Reads(uint8_t);         // Reads: Number of analogRead/digitalRead of the pin
+  static uint32_t ReadTime(uint8_t);      // ReadTime: Time of the last read of the pin
+};
+
+// ---------------------------------------------------------------------------
+// SERVOS
+// Every Servo::write is recorded by pin, additionally a hook can be installed
+// to trace every write (pin, pulse in microseconds, time in microseconds).
+// ---------------------------------------------------------------------------
+typedef void (*SimServoHook)(uint8_t, uint16_t, uint32_t);
+
+struct SimServo
+{
+  static bool     Attached(uint8_t);      // Attached: True if a servo is attached to the pin
+  static uint16_t Pulse(uint8_t);         // Pulse: Last pulse in microseconds written to the pin
+  static uint32_t Writes(uint8_t);        // Writes: Number of writes done to the pin
+  static uint32_t TotalWrites();          // TotalWrites: Number of writes done to all pins
+  static void SetHook(SimServoHook);      // SetHook: Callback for every write (NULL to remove)
+  static void Record(uint8_t, uint16_t);  // Record: Used by the mock of Servo
+  static void Attach(uint8_t, bool);      // Attach: Used by the mock of Servo
+};
+
+// ---------------------------------------------------------------------------
+// SERIAL PORTS
+// The output is instantaneous, a throttled port sends it like the UART of the
+// AVR: a TX buffer of SIM_SERIAL_TX_BUFFER bytes that leaves at the Baudrate
+// (10 bits per byte) in virtual time, availableForWrite() is the free space
+// and write() waits (advances the clock) while the buffer is full.
+// ---------------------------------------------------------------------------
+#define SIM_SERIAL_PORTS      4
+#define SIM_SERIAL_LIMIT      65536   // Maximum bytes captured by port (the oldest are discarded)
+#define SIM_SERIAL_TX_BUFFER  64      // TX buffer of a throttled port (HardwareSerial of the AVR)
+
+struct SimSerial
+{
+  static void Inject(int, const uint8_t *, size_t);  // Inject: Bytes that the sketch is going to read from the port
+  static void Inject(int, const char *);
+  static size_t Pending(int);                        // Pending: Bytes injected and not readed by the sketch
+  static std::string &Output(int);                   // Output: Bytes written by the sketch
+  static void Clear(int);                            // Clear: Discard the bytes written by the sketch
+  static void Capture(int, bool);                    // Capture: Enable/Disable the capture of the output (DEFAULT: true)
+  static unsigned long Baudrate(int);                // Baudrate: Baudrate configured by begin()
+  static void Throttle(int, bool);                   // Throttle: The output leaves at the Baudrate (DEFAULT: false)
+  static uint32_t Blocked(int);                      // Blocked: Microseconds that write() waited for space (throttled)
+};
+
+// ---------------------------------------------------------------------------
+// RADIO (Virtual air)
+// ---------------------------------------------------------------------------
+struct SimRadio
+{
+  static void Reset();                    // Reset: Forget all radios and the pending payloads
+  static uint32_t Sent();                 // Sent: Payloads written by any radio
+  static uint32_t Delivered();            // Delivered: Payloads delivered to at least one radio
+  static uint32_t Lost();                 // Lost: Payloads that nobody received
+  static void WireIRQ(uint8_t, uint8_t);  // WireIRQ: Connects the IRQ of the radio with CE pin N to a pin (active low)
+  static void SetLoss(uint8_t, uint32_t = 1);   // SetLoss: Percent of payloads lost in the air (write() not acknowledged), seed
+};
+
+// ---------------------------------------------------------------------------
+// I2C BUS
+// Devices of the Wire mock. The PCA9685 model keeps his 256 registers, the
+// auto-increment (MODE1 AI) and the PRESCALE (only written while sleeping),
+// every transaction consumes ~9 bits per byte of the clock of the bus.
+// ---------------------------------------------------------------------------
+struct SimI2C
+{
+  static void AddPCA9685(uint8_t);                 // AddPCA9685: Connects a PCA9685 in the address
+  static uint16_t PCA9685Counts(uint8_t, uint8_t); // PCA9685Counts: Count of a channel applied on the last STOP (address, channel)
+  static uint16_t PCA9685Pulse(uint8_t, uint8_t);  // PCA9685Pulse: Pulse of a channel in microseconds (from the PRESCALE)
+  static uint32_t Transactions();                  // Transactions: endTransmission() done to any address
+  static uint32_t Bytes();                         // Bytes: Bytes sent by the master (address included)
+};
+
+// ---------------------------------------------------------------------------
+// EEPROM
+// Bytes of the EEPROM of the board (erased, 0xFF, when the program starts).
+// Every write takes SIM_EEPROM_WRITE microseconds of the virtual clock. Load
+// and Save keep the EEPROM in a file, so the next run boots like a board that
+// was powered before.
+// ---------------------------------------------------------------------------
+#define SIM_EEPROM_SIZE   4096    // Bytes of the EEPROM (ATmega2560, the ATmega328p has 1024)
+#define SIM_EEPROM_WRITE  3300    // Microseconds of a write (erase and write of the AVR)
+
+struct SimEEPROM
+{
+  static void Reset(uint16_t = SIM_EEPROM_SIZE);   // Reset: Erases the EEPROM with the size of the board
+  static bool Load(const char *);                  // Load: Reads the EEPROM from a file, false if it doesn't exist
+  static bool Save(const char *);                  // Save: Writes the EEPROM to a file
+  static uint8_t Peek(uint16_t);                   // Peek: Byte of the EEPROM without cost
+  static uint32_t Writes();                        // Writes: Bytes written by the sketch
+};
+
+#endif
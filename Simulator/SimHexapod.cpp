@@ -0,0 +1,120 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - Hexapod
+//
+// Runs the sketch "Hexapod.ino" headless over the virtual hardware: calls
+// setup() once and loop() N times, and reports how many ticks per second the
+// host can run and the state of the servos at the end.
+//
+// USAGE:
+//   SimHexapod [--ticks N] [--call-cost MICROS] [--quiet] [--profile FILE] [--ram] [--output NAME] [--eeprom FILE]
+//     --ticks N            Number of calls to loop() (DEFAULT: 1000000)
+//     --call-cost MICROS   Virtual microseconds consumed by millis()/micros() (DEFAULT: 4)
+//     --quiet              Only print the summary line
+//     --profile FILE       Saves the output of the PCSerial (PROFILER frames and debug messages, see
+//                          Tools/ProfileDecoder and Tools/DebugDecoder)
+//     --ram                Prints the RAM of every part of the robot (QURHexapod::RamReport) and exits
+//     --output NAME        Output of the servos: servo (DEFAULT), timer or pca9685 (QURServoOutput.h)
+//     --eeprom FILE        EEPROM of the board: read before setup() (if the file exists) and saved at
+//                          the end, the second run boots with the calibration saved by the first one
+//
+// The summary says the virtual milliseconds of setup() (boot_ms) and the bytes
+// written to the EEPROM (eeprom_writes).
+//
+// The control logic is the same code that runs on the board, so this binary
+// can be profiled with the normal host tools (perf, gprof, valgrind).
+// ---------------------------------------------------------------------------
+
+#include "SimHardware.h"
+#include <Arduino.h>
+#include <QURHexapod.h>
+#include <stdio.h>
+#include <chrono>
+
+void setup();
+void loop();
+extern QURHexapod QUR001H;
+
+static QURTimerOutput TimerOutput;
+static QURPCA9685 Expander(0x40);
+
+int main(int argc, char **argv){
+  unsigned long ticks = 1000000UL;
+  bool quiet = false;
+  const char *profile = NULL;
+  const char *output = "servo";
+  const char *eeprom = NULL;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--ticks") && x + 1 < argc)          ticks = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--call-cost") && x + 1 < argc) SimClock::SetCallCost(strtoul(argv[++x], NULL, 10));
+    else if(!strcmp(argv[x], "--quiet"))                     quiet = true;
+    else if(!strcmp(argv[x], "--profile") && x + 1 < argc)   profile = argv[++x];
+    else if(!strcmp(argv[x], "--output") && x + 1 < argc)    output = argv[++x];
+    else if(!strcmp(argv[x], "--eeprom") && x + 1 < argc)    eeprom = argv[++x];
+    else if(!strcmp(argv[x], "--ram")){                       // Sizes of the host: int and pointers are wider than in the AVR
+      QURHexapod::RamReport();
+      fwrite(SimSerial::Output(0).data(), 1, SimSerial::Output(0).size(), stdout);
+      return 0;
+    }
+    else {
+      fprintf(stderr, "usage: %s [--ticks N] [--call-cost MICROS] [--quiet] [--profile FILE] [--ram] [--output servo|timer|pca9685] [--eeprom FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+  bool pca9685 = !strcmp(output, "pca9685");
+  if(!strcmp(output, "timer"))
+    QUR001H.SetOutput(&TimerOutput);
+  else if(pca9685){
+    for(uint8_t x = 0; x < PCA9685_DEVICES; x++)   // More than 16 joints use a second expander
+      SimI2C::AddPCA9685(0x40 + x);
+    QUR001H.SetOutput(&Expander);
+  }
+  else if(strcmp(output, "servo")){
+    fprintf(stderr, "%s: unknown output '%s' (servo, timer or pca9685)\n", argv[0], output);
+    return 1;
+  }
+  SimSerial::Capture(0, profile != NULL);   // The debug output is not needed to measure
+  SimRadio::WireIRQ(RF_CE, RF_IRQ);   // The IRQ of the antenna is wired like in the board
+
+  if(eeprom)
+    SimEEPROM::Load(eeprom);          // A board that was powered before (the first time the EEPROM is erased)
+  uint32_t virtualBoot = SimClock::Micros();
+  setup();
+  uint32_t virtualStart = SimClock::Micros();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(unsigned long x = 0; x < ticks; x++)
+    loop();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  uint32_t virtualTime = SimClock::Micros() - virtualStart;
+
+  if(profile){
+    FILE *file = fopen(profile, "wb");
+    if(!file){
+      perror(profile);
+      return 1;
+    }
+    fwrite(SimSerial::Output(0).data(), 1, SimSerial::Output(0).size(), file);
+    fclose(file);
+  }
+  if(eeprom && !SimEEPROM::Save(eeprom)){
+    perror(eeprom);
+    return 1;
+  }
+
+  if(!quiet && pca9685){
+    printf("channel  counts  pulse(us)\n");
+    for(uint8_t channel = 0; channel < __JOINTS__; channel++)
+      printf("%7u  %6u  %9u\n", channel, SimI2C::PCA9685Counts(0x40 + channel / PCA9685_OUTPUTS, channel % PCA9685_OUTPUTS),
+             SimI2C::PCA9685Pulse(0x40 + channel / PCA9685_OUTPUTS, channel % PCA9685_OUTPUTS));
+    printf("i2c_transactions=%u i2c_bytes=%u\n", SimI2C::Transactions(), SimI2C::Bytes());
+  }
+  else if(!quiet){
+    printf("pin  pulse(us)  writes\n");
+    for(uint8_t pin = 0; pin < SIM_PINS; pin++)
+      if(SimServo::Attached(pin))
+        printf("%3u  %9u  %6u\n", pin, SimServo::Pulse(pin), SimServo::Writes(pin));
+  }
+  printf("ticks=%lu host_seconds=%.6f ticks_per_second=%.0f virtual_seconds=%.6f servo_writes=%u boot_ms=%.3f eeprom_writes=%u\n",
+         ticks, seconds, seconds > 0 ? ticks / seconds : 0.0, virtualTime / 1e6, SimServo::TotalWrites(),
+         (virtualStart - virtualBoot) / 1e3, SimEEPROM::Writes());
+  return 0;
+}
@@ -0,0 +1,148 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - PC link
+//
+// Runs the sketch "Hexapod.ino" with PCLINK over the virtual hardware and a
+// virtual PC in the PCSerial (QURPCLink.h): the PC selects the mode MANUAL
+// and streams the setpoints of the 12 joints (every joint a sine wave) as
+// fast as the rate asked. The line is modeled in both directions: the bytes
+// of the PC arrive at the baudrate into a RX buffer of 64 bytes like the one
+// of the AVR (a byte that doesn't fit is lost) and the States of the robot
+// leave at the baudrate. The report says how many setpoints per second the
+// robot applied, the frames lost or refused, the bytes lost in the RX buffer
+// and the time from the last byte of a frame to the State that acknowledges it.
+//
+// USAGE:
+//   SimPCLink [--seconds N] [--rate HZ] [--duration MS]
+//     --seconds N      Virtual seconds of streaming (DEFAULT: 10)
+//     --rate HZ        Frames of setpoints per second (DEFAULT: 0 = as fast as the line)
+//     --duration MS    Duration of the frames (DEFAULT: 0 = direct to the servos, else
+//                      keyframes, the PC waits the Space of the State before sending)
+//
+// Returns 1 if a frame was lost, rejected or refused, a byte was lost or the
+// last setpoints are not the setpoints of the robot.
+// ---------------------------------------------------------------------------
+
+#include "SimHardware.h"
+#include <Arduino.h>
+#include <QURHexapod.h>
+#include <QURPCLink.h>
+#include <stdio.h>
+#include <math.h>
+#include <deque>
+
+void setup();
+void loop();
+
+#define PC_PORT       0                 // Serial (PCSerial)
+#define RX_BUFFER     64                // Bytes of the RX buffer of the board
+
+int main(int argc, char **argv){
+  uint32_t seconds = 10, rate = 0, duration = 0;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--seconds") && x + 1 < argc)        seconds = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--rate") && x + 1 < argc)      rate = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--duration") && x + 1 < argc)  duration = strtoul(argv[++x], NULL, 10);
+    else {
+      fprintf(stderr, "usage: %s [--seconds N] [--rate HZ] [--duration MS]\n", argv[0]);
+      return 1;
+    }
+  }
+  SimSerial::Throttle(PC_PORT, true);
+  setup();
+  SimSerial::Clear(PC_PORT);
+  uint32_t baudrate = SimSerial::Baudrate(PC_PORT);
+  uint32_t byteTime = (10000000UL + baudrate - 1) / baudrate;         // Microseconds of a byte (8N1, rounded up)
+
+  // Virtual PC: the frames wait in Line until their bytes leave at the baudrate
+  QURPCWriter writer;
+  QURPCParser parser;
+  QURPCState state;
+  std::deque<uint8_t> line;
+  std::deque<std::pair<uint16_t, uint32_t> > inFlight;  // Sequence and time of the last byte of every frame
+  uint8_t frame[QUR_PC_WIRE_MAX], joints[QUR_JOINTS];
+  uint32_t start = SimClock::Micros(), end = start + seconds * 1000000UL;
+  uint32_t nextFrame = start, nextByte = start;
+  uint32_t sent = 0, states = 0, overflow = 0, latencySum = 0, latencyMax = 0, latencies = 0;
+  uint16_t lastSetpoints = 0;
+  bool haveState = false;
+  uint8_t length = writer.Mode(MANUAL, frame);
+  line.insert(line.end(), frame, frame + length);
+  while((int32_t)(SimClock::Micros() - end) < 0){
+    uint32_t now = SimClock::Micros();
+    // A new frame when the line is free (back to back) or at his rate, the keyframes
+    // only if the queue has space for them and the ones not acknowledged yet
+    bool space = !duration || (haveState && state.Space > inFlight.size());
+    if(line.empty() && space && (rate == 0 || (int32_t)(now - nextFrame) >= 0)){
+      double phase = (now - start) * 2 * M_PI / 2e6;                    // A wave every 2 seconds
+      for(int x = 0; x < QUR_JOINTS; x++)
+        joints[x] = (uint8_t)lround(50 + 40 * sin(phase + x * M_PI / 6));
+      lastSetpoints = writer.Sequence;
+      length = writer.Setpoints(joints, (uint16_t)duration, frame);
+      line.insert(line.end(), frame, frame + length);
+      sent++;
+      nextFrame += rate ? 1000000UL / rate : 0;
+    }
+    // The bytes of the line arrive at the baudrate
+    while(!line.empty() && (int32_t)(now - nextByte) >= 0){
+      uint8_t value = line.front();
+      line.pop_front();
+      if(SimSerial::Pending(PC_PORT) < RX_BUFFER - 1)
+        SimSerial::Inject(PC_PORT, &value, 1);
+      else
+        overflow++;
+      if(value == QUR_PC_DELIMITER)
+        inFlight.push_back(std::make_pair((uint16_t)(writer.Sequence - 1), now));
+      nextByte = (line.empty() ? now : nextByte) + byteTime;
+    }
+    loop();
+    // The States of the robot
+    std::string &output = SimSerial::Output(PC_PORT);
+    for(size_t x = 0; x < output.size(); x++){
+      if(parser.Feed((uint8_t)output[x]) != QUR_PC_STATE)
+        continue;
+      parser.State(state);
+      haveState = true;
+      states++;
+      while(!inFlight.empty() && (int16_t)(inFlight.front().first - state.Ack) <= 0){
+        uint32_t latency = SimClock::Micros() - inFlight.front().second;
+        latencySum += latency;
+        latencies++;
+        if(latency > latencyMax)
+          latencyMax = latency;
+        inFlight.pop_front();
+      }
+    }
+    SimSerial::Clear(PC_PORT);
+  }
+  // The last frames arrive and the robot answers them
+  uint32_t drain = SimClock::Micros() + 500000UL;
+  while((int32_t)(SimClock::Micros() - drain) < 0){
+    uint32_t now = SimClock::Micros();
+    while(!line.empty() && (int32_t)(now - nextByte) >= 0){
+      uint8_t value = line.front();
+      line.pop_front();
+      SimSerial::Inject(PC_PORT, &value, 1);
+      nextByte += byteTime;
+    }
+    loop();
+    std::string &output = SimSerial::Output(PC_PORT);
+    for(size_t x = 0; x < output.size(); x++)
+      if(parser.Feed((uint8_t)output[x]) == QUR_PC_STATE){
+        parser.State(state);
+        states++;
+      }
+    SimSerial::Clear(PC_PORT);
+  }
+
+  // The setpoints of the robot are the last ones sent (direct) or the queue arrived to them (keyframes)
+  bool applied = state.Ack == lastSetpoints;
+  for(int x = 0; x < QUR_JOINTS; x++)
+    applied &= (uint8_t)state.Setpoints[x] == joints[x];
+  double elapsed = seconds;                     // The first frame received is the MODE
+  double capacity = SimSerial::Baudrate(PC_PORT) / 10.0 / (QUR_PC_HEADER + 2 + QUR_JOINTS + 1 + 2);
+  printf("virtual_seconds=%.3f sent=%u received=%u frames_per_second=%.0f line_frames_per_second=%.0f states=%u "
+         "lost=%u errors=%u refused=%u rx_overflow=%u ack_latency_avg_us=%.0f ack_latency_max_us=%u applied=%s\n",
+         elapsed, sent, state.Received, (state.Received - 1) / elapsed, capacity, states, state.Lost, state.Errors,
+         state.Refused, overflow, latencies ? (double)latencySum / latencies : 0.0, latencyMax, applied ? "yes" : "no");
+  return state.Lost || state.Errors || state.Refused || overflow || !applied ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - Flight recorder
+//
+// Runs the sketch "Hexapod.ino" with MODULESD over the virtual hardware: the
+// gait generator walks steered by a virtual RF-Controller (a DRIVE packet
+// every 20 ms, the joystick turns in circle) and a virtual ModuleSD receives
+// the log in Serial1. The port is throttled like the UART (SD_BAUDRATE), so
+// the report says if the log keeps up with the control rate: blocks and
+// records received, bytes per second against the capacity of the link, the
+// records dropped by the robot, the blocks with errors and the microseconds
+// that a write() waited (must be 0, the recorder never blocks).
+//
+// USAGE:
+//   SimRecorder [--seconds N] [--log FILE]
+//     --seconds N          Virtual seconds of flight (DEFAULT: 10)
+//     --log FILE           Saves the blocks received like the card (see Tools/LogDecoder)
+//
+// Returns 1 if a record was dropped, a block was corrupted or a write() waited.
+// ---------------------------------------------------------------------------
+
+#include "SimHardware.h"
+#include <Arduino.h>
+#include <RF24.h>
+#include <QURHexapod.h>
+#include <QURPacket.h>
+#include <QURRecorder.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+void setup();
+void loop();
+extern QURHexapod QUR001H;
+
+#define SD_PORT       1                 // Serial1 (SDcontrol)
+#define RATE_COMMAND  20000UL           // Microseconds between two packets of the virtual controller
+
+int main(int argc, char **argv){
+  uint32_t seconds = 10;
+  const char *path = NULL;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--seconds") && x + 1 < argc)  seconds = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--log") && x + 1 < argc) path = argv[++x];
+    else {
+      fprintf(stderr, "usage: %s [--seconds N] [--log FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+  FILE *log = NULL;
+  if(path && !(log = fopen(path, "wb"))){
+    perror(path);
+    return 1;
+  }
+  SimSerial::Capture(0, false);                 // The debug output is not needed
+  SimSerial::Throttle(SD_PORT, true);
+  SimRadio::WireIRQ(RF_CE, RF_IRQ);
+
+  // Virtual RF-Controller
+  const uint8_t address[6] = "0";
+  RF24 remote(0, 0);
+  remote.begin();
+  remote.setChannel(115);
+  remote.setDataRate(RF24_250KBPS);
+  remote.openWritingPipe(address);
+  remote.enableDynamicPayloads();
+  remote.enableAckPayload();
+  QURPacketWriter writer;
+  QURCommand command;
+  uint8_t packet[QUR_PACKET_MAX];
+
+  setup();
+  QUR001H.StartWalk(GAIT_TRIPOD, 1000);
+  SimSerial::Clear(SD_PORT);
+  uint32_t start = SimClock::Micros(), next = start;
+  uint32_t end = start + seconds * 1000000UL;
+
+  // Virtual ModuleSD: cuts the stream in blocks and checks them
+  std::string stream;
+  uint32_t blocks = 0, bad = 0, gaps = 0, dropped = 0, records = 0, expected = 0;
+  uint32_t types[QUR_LOG_TIMING + 1] = {0};
+  unsigned long loops = 0;
+  while((int32_t)(SimClock::Micros() - end) < 0){
+    if((int32_t)(SimClock::Micros() - next) >= 0){
+      double phase = (SimClock::Micros() - start) * 2 * M_PI / 4e6;   // A turn every 4 seconds
+      command.Angle = (int16_t)(atan2(sin(phase), cos(phase)) * 180 / M_PI);
+      command.Magnitude = 80;
+      remote.write(packet, writer.Drive(command, packet));
+      while(remote.available())                 // The STATUS of the ACKs
+        remote.read(packet, remote.getDynamicPayloadSize());
+      next += RATE_COMMAND;
+    }
+    loop();
+    loops++;
+    std::string &output = SimSerial::Output(SD_PORT);
+    stream += output;
+    SimSerial::Clear(SD_PORT);
+    while(stream.size() >= QUR_LOG_BLOCK){
+      const uint8_t *block = (const uint8_t *)stream.data();
+      blocks++;
+      if(!QURLogCheck(block))
+        bad++;
+      else {
+        uint32_t sequence = block[4] | (block[5] << 8) | ((uint32_t)block[6] << 16) | ((uint32_t)block[7] << 24);
+        if(sequence != expected)
+          gaps++;
+        expected = sequence + 1;
+        dropped += block[8] | (block[9] << 8);
+        records += block[3];
+        for(uint8_t x = 0; x < block[3]; x++){
+          uint8_t type = block[QUR_LOG_HEADER + x * QUR_LOG_RECORD];
+          if(type <= QUR_LOG_TIMING)
+            types[type]++;
+        }
+      }
+      if(log)
+        fwrite(block, 1, QUR_LOG_BLOCK, log);
+      stream.erase(0, QUR_LOG_BLOCK);
+    }
+  }
+  if(log)
+    fclose(log);
+
+  double elapsed = (SimClock::Micros() - start) / 1e6;
+  double rate = blocks * QUR_LOG_BLOCK / elapsed;
+  double capacity = SimSerial::Baudrate(SD_PORT) / 10.0;
+  printf("virtual_seconds=%.3f loops=%lu blocks=%u records=%u records_per_second=%.0f packets=%u setpoints=%u joints=%u timings=%u "
+         "log_bytes_per_second=%.0f link_bytes_per_second=%.0f link_use=%.1f%% dropped=%u bad_blocks=%u sequence_gaps=%u blocked_us=%u\n",
+         elapsed, loops, blocks, records, records / elapsed, types[QUR_LOG_PACKET], types[QUR_LOG_SETPOINTS],
+         types[QUR_LOG_JOINTS], types[QUR_LOG_TIMING], rate, capacity, capacity > 0 ? rate * 100 / capacity : 0.0,
+         dropped, bad, gaps, SimSerial::Blocked(SD_PORT));
+  return dropped || bad || gaps || SimSerial::Blocked(SD_PORT) ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - Replay of RF sessions
+//
+// Feeds a session (SimSession.h) into the sketch "Hexapod.ino": every packet
+// is sent by a virtual RF-Controller when the virtual clock reaches his time,
+// so it follows the same path than in the field (air, IRQ, ring, ReadData).
+// The clock is virtual, the session runs as fast as the host can. The pulse
+// of every servo write is the trace (one line "micros joint pulse", the time
+// since the start of the session), the same session and the same firmware
+// always give the same trace: compare it with the trace of other build to
+// check that a change didn't touch the motion, bit for bit.
+//
+// USAGE:
+//   SimReplay SESSION [--trace FILE] [--compare FILE] [--walk MS] [--tail MS]
+//     SESSION          Packets to replay (SimController --capture, LogDecoder --capture)
+//     --trace FILE     Saves the trace of the servos
+//     --compare FILE   Compares the trace with a trace saved before (returns 1 if they differ)
+//     --walk MS        Cycle of the gait generator steered by the session (DEFAULT: 1000, 0 = don't walk)
+//     --tail MS        Milliseconds simulated after the last packet (DEFAULT: 1000)
+// ---------------------------------------------------------------------------
+
+#include "SimHardware.h"
+#include "SimSession.h"
+#include <Arduino.h>
+#include <RF24.h>
+#include <QURHexapod.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+
+void setup();
+void loop();
+extern QURHexapod QUR001H;
+
+static int8_t JointOfPin[SIM_PINS];
+static std::string Trace;
+static uint32_t TraceStart = 0;
+
+static void ServoHook(uint8_t __PIN__, uint16_t __PULSE__, uint32_t __MICROS__){
+  char line[32];
+  snprintf(line, sizeof(line), "%u %d %u\n", __MICROS__ - TraceStart, JointOfPin[__PIN__], __PULSE__);
+  Trace += line;
+}
+
+// FNV-1a of the trace, a short name of the result
+static uint64_t Hash(const std::string &__TEXT__){
+  uint64_t hash = 14695981039346656037ULL;
+  for(size_t x = 0; x < __TEXT__.size(); x++){
+    hash ^= (uint8_t)__TEXT__[x];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Line (from 1) of the first difference between two traces, 0 if they are the same
+static size_t FirstDifference(const std::string &__A__, const std::string &__B__){
+  size_t line = 1;
+  for(size_t x = 0; x < __A__.size() || x < __B__.size(); x++){
+    if(x >= __A__.size() || x >= __B__.size() || __A__[x] != __B__[x])
+      return line;
+    if(__A__[x] == '\n')
+      line++;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv){
+  const char *session = NULL, *tracePath = NULL, *comparePath = NULL;
+  unsigned long walk = 1000, tail = 1000;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--trace") && x + 1 < argc)         tracePath = argv[++x];
+    else if(!strcmp(argv[x], "--compare") && x + 1 < argc)  comparePath = argv[++x];
+    else if(!strcmp(argv[x], "--walk") && x + 1 < argc)     walk = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--tail") && x + 1 < argc)     tail = strtoul(argv[++x], NULL, 10);
+    else if(argv[x][0] != '-' && !session)                  session = argv[x];
+    else {
+      fprintf(stderr, "usage: %s SESSION [--trace FILE] [--compare FILE] [--walk MS] [--tail MS]\n", argv[0]);
+      return 1;
+    }
+  }
+  SimSessionReader reader;
+  if(!session || !reader.Open(session)){
+    fprintf(stderr, "%s: can't read the session '%s'\n", argv[0], session ? session : "");
+    return 1;
+  }
+  std::string expected;
+  if(comparePath){
+    FILE *file = fopen(comparePath, "rb");
+    if(!file){
+      perror(comparePath);
+      return 1;
+    }
+    char buffer[4096];
+    size_t length;
+    while((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+      expected.append(buffer, length);
+    fclose(file);
+  }
+
+  // Joint of every pin of the servos (SERVO_PINS)
+  memset(JointOfPin, -1, sizeof(JointOfPin));
+  for(uint8_t x = 0; x < __JOINTS__; x++)
+    JointOfPin[SERVO_PINS[GEOMETRY::Axis(x)][GEOMETRY::Leg(x)]] = x;
+  SimSerial::Capture(0, false);                 // The debug output is not needed
+  SimRadio::WireIRQ(RF_CE, RF_IRQ);
+
+  // Virtual RF-Controller, the packets are sent like they were received
+  const uint8_t address[6] = "0";
+  RF24 remote(0, 0);
+  remote.begin();
+  remote.setChannel(115);
+  remote.setDataRate(RF24_250KBPS);
+  remote.openWritingPipe(address);
+  remote.enableDynamicPayloads();
+  remote.enableAckPayload();
+
+  setup();
+  if(walk)
+    QUR001H.StartWalk(GAIT_TRIPOD, walk);
+  TraceStart = SimClock::Micros();
+  SimServo::SetHook(ServoHook);
+
+  uint32_t packets = 0, refused = 0, time = 0, last = 0;
+  uint8_t packet[SIM_SESSION_PAYLOAD], length;
+  bool pending = reader.Next(time, packet, length);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while(pending || (int32_t)(SimClock::Micros() - TraceStart - last - tail * 1000UL) < 0){
+    while(pending && (int32_t)(SimClock::Micros() - TraceStart - time) >= 0){
+      if(!remote.write(packet, length))           // The RX FIFO of the robot is full
+        refused++;
+      while(remote.available())                   // The STATUS of the ACKs
+        remote.read(packet, remote.getDynamicPayloadSize());
+      packets++;
+      last = time;
+      pending = reader.Next(time, packet, length);
+    }
+    loop();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double virtualSeconds = (SimClock::Micros() - TraceStart) / 1e6;
+  SimServo::SetHook(NULL);
+  reader.Close();
+
+  if(tracePath){
+    FILE *file = fopen(tracePath, "wb");
+    if(!file){
+      perror(tracePath);
+      return 1;
+    }
+    fwrite(Trace.data(), 1, Trace.size(), file);
+    fclose(file);
+  }
+  size_t difference = comparePath ? FirstDifference(Trace, expected) : 0;
+  printf("packets=%u refused=%u virtual_seconds=%.3f host_seconds=%.3f speed=%.0fx servo_writes=%u trace_hash=%016llx",
+         packets, refused, virtualSeconds, seconds, seconds > 0 ? virtualSeconds / seconds : 0.0,
+         SimServo::TotalWrites(), (unsigned long long)Hash(Trace));
+  if(comparePath)
+    printf(difference ? " compare=different first_difference_line=%zu" : " compare=identical", difference);
+  printf("\n");
+  return difference ? 1 : 0;
+}
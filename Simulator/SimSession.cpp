@@ -0,0 +1,62 @@
+// ---------------------------------------------------------------------------
+// See "SimSession.h" for the format of the file.
+// ---------------------------------------------------------------------------
+
+#include "SimSession.h"
+#include <string.h>
+
+static const uint8_t SESSION_MAGIC[4] = {'Q', 'U', 'R', 'S'};
+
+bool SimSessionWriter::Open(const char *__PATH__){
+  File = fopen(__PATH__, "wb");
+  if(!File)
+    return false;
+  uint8_t header[8] = {SESSION_MAGIC[0], SESSION_MAGIC[1], SESSION_MAGIC[2], SESSION_MAGIC[3], SIM_SESSION_VERSION, 0, 0, 0};
+  fwrite(header, 1, sizeof(header), File);
+  Packets = 0;
+  return true;
+}
+
+void SimSessionWriter::Add(uint32_t __MICROS__, const uint8_t *__PACKET__, uint8_t __LENGTH__){
+  if(!File || __LENGTH__ == 0 || __LENGTH__ > SIM_SESSION_PAYLOAD)
+    return;
+  uint8_t entry[5] = {(uint8_t)__MICROS__, (uint8_t)(__MICROS__ >> 8), (uint8_t)(__MICROS__ >> 16), (uint8_t)(__MICROS__ >> 24), __LENGTH__};
+  fwrite(entry, 1, sizeof(entry), File);
+  fwrite(__PACKET__, 1, __LENGTH__, File);
+  Packets++;
+}
+
+void SimSessionWriter::Close(){
+  if(File)
+    fclose(File);
+  File = NULL;
+}
+
+bool SimSessionReader::Open(const char *__PATH__){
+  File = fopen(__PATH__, "rb");
+  if(!File)
+    return false;
+  uint8_t header[8];
+  if(fread(header, 1, sizeof(header), File) != sizeof(header) || memcmp(header, SESSION_MAGIC, 4) || header[4] != SIM_SESSION_VERSION){
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool SimSessionReader::Next(uint32_t &__MICROS__, uint8_t *__PACKET__, uint8_t &__LENGTH__){
+  uint8_t entry[5];
+  if(!File || fread(entry, 1, sizeof(entry), File) != sizeof(entry))
+    return false;
+  if(entry[4] == 0 || entry[4] > SIM_SESSION_PAYLOAD)
+    return false;
+  __MICROS__ = entry[0] | ((uint32_t)entry[1] << 8) | ((uint32_t)entry[2] << 16) | ((uint32_t)entry[3] << 24);
+  __LENGTH__ = entry[4];
+  return fread(__PACKET__, 1, __LENGTH__, File) == __LENGTH__;
+}
+
+void SimSessionReader::Close(){
+  if(File)
+    fclose(File);
+  File = NULL;
+}
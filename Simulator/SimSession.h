@@ -0,0 +1,44 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics Simulator - RF sessions
+//
+// Capture of the packets received by the Hexapod with the time they arrived,
+// so a session of the field (or of the simulator) can be replayed into the
+// robot over and over (Simulator/SimReplay) with the same result.
+//
+// FILE (little endian):
+//   [0-3] "QURS"  [4] SIM_SESSION_VERSION  [5-7] Reserved (0)
+//   Then one entry per packet:
+//   [0-3] Microseconds since the start of the session  [4] Length (1-32)  [5..] Bytes of the packet
+//
+// USE:
+//   SimSessionWriter Writer;  Writer.Open("session.qrs");  Writer.Add(Time, Packet, Length);  Writer.Close();
+//   SimSessionReader Reader;  Reader.Open("session.qrs");  while(Reader.Next(Time, Packet, Length)) ...
+// ---------------------------------------------------------------------------
+
+#ifndef SIMSESSION_H
+#define SIMSESSION_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SIM_SESSION_VERSION  1
+#define SIM_SESSION_PAYLOAD  32     // Maximum bytes of a packet (payload of the nRF24)
+
+struct SimSessionWriter
+{
+  FILE *File = NULL;
+  uint32_t Packets = 0;                             // Packets: Entries written
+  bool Open(const char *);                          // Open: Creates the file and writes the header
+  void Add(uint32_t, const uint8_t *, uint8_t);     // Add: Writes a packet (time, bytes, length)
+  void Close();
+};
+
+struct SimSessionReader
+{
+  FILE *File = NULL;
+  bool Open(const char *);                          // Open: Opens the file, false if it is not a session
+  bool Next(uint32_t &, uint8_t *, uint8_t &);      // Next: Reads the next packet, false at the end (or a cut entry)
+  void Close();
+};
+
+#endif
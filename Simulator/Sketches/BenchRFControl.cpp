@@ -0,0 +1,7 @@
+// ---------------------------------------------------------------------------
+// Compiles the sketch "RFControl.ino" for Tools/HostBenchmark with setup() and
+// loop() renamed, so the Hexapod and the RF-Controller run in the same process.
+// ---------------------------------------------------------------------------
+#define setup RFControlSetup
+#define loop  RFControlLoop
+#include "RFControlSketch.cpp"
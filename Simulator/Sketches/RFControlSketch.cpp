@@ -0,0 +1,5 @@
+// ---------------------------------------------------------------------------
+// Compiles the sketch "RFControl.ino" as a normal C++ translation unit for the
+// Host Simulator, the Arduino IDE is not needed.
+// ---------------------------------------------------------------------------
+#include "../../Control RF/RFControl/RFControl.ino"
@@ -0,0 +1,114 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics - Debug decoder
+//
+// Reads the debug messages of the Hexapod (QURDebug.h, frames QUR_PC_LOG of
+// the PC link) from the serial output, mixed with any other frame or text of
+// the port, and prints them as text with the table of QURMessages.h: one
+// line per message with his sequence and level. At the end a summary: the
+// messages of every level, the messages lost (gaps of the sequence, dropped
+// by the robot when the TX buffer was full) and the frames rejected.
+//
+// USAGE:
+//   DebugDecoder [--summary] [FILE]
+//     --summary  Only print the summary (DEFAULT: every message and the summary)
+//     FILE       Capture of the port, or the port itself (DEFAULT: stdin)
+//
+// Example: stty -F /dev/ttyACM0 raw 115200 && DebugDecoder /dev/ttyACM0
+// ---------------------------------------------------------------------------
+
+#include <QURDebug.h>
+#include <QURMessages.h>
+#include <stdio.h>
+
+// Texts of the messages, in the order of the MESSAGE_ numbers
+#define QUR_MESSAGE_TEXT(__ID__, __TEXT__) __TEXT__,
+static const char *MESSAGE_TEXTS[] = { QUR_MESSAGES(QUR_MESSAGE_TEXT) };
+static const char *LEVEL_NAMES[] = {"NONE", "ERROR", "WARNING", "INFO", "TRACE"};
+
+// Writes the text of a message with his arguments (16 bits, or 32 bits with 'l')
+static void PrintMessage(uint8_t __MESSAGE__, const uint8_t *__ARGUMENTS__, uint8_t __LENGTH__){
+  if(__MESSAGE__ >= QUR_MESSAGE_COUNT){
+    printf("message %u (unknown, %u bytes of arguments)", __MESSAGE__, __LENGTH__);
+    return;
+  }
+  uint8_t read = 0;
+  for(const char *text = MESSAGE_TEXTS[__MESSAGE__]; *text; text++){   // Cicle with a iterator 'text' that go over each CHARACTER
+    if(*text != '%'){
+      putchar(*text);
+      continue;
+    }
+    text++;
+    if(*text == '%'){
+      putchar('%');
+      continue;
+    }
+    bool wide = *text == 'l';
+    if(wide)
+      text++;
+    uint8_t size = wide ? 4 : 2;
+    if(read + size > __LENGTH__){                 // The robot sent less arguments than the text
+      printf("?");
+      continue;
+    }
+    uint32_t value = 0;
+    for(uint8_t x = 0; x < size; x++)
+      value |= (uint32_t)__ARGUMENTS__[read + x] << (8 * x);
+    read += size;
+    switch(*text){
+      case 'd': printf("%ld", wide ? (long)(int32_t)value : (long)(int16_t)value); break;
+      case 'x': printf("%lx", (unsigned long)value); break;
+      case 'c': putchar((char)value); break;
+      default:  printf("%lu", (unsigned long)value);
+    }
+  }
+}
+
+int main(int argc, char **argv){
+  bool summary = false;
+  const char *path = NULL;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--summary"))  summary = true;
+    else if(argv[x][0] != '-' && !path) path = argv[x];
+    else {
+      fprintf(stderr, "usage: %s [--summary] [FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+  FILE *input = path ? fopen(path, "rb") : stdin;
+  if(!input){
+    perror(path);
+    return 1;
+  }
+
+  QURPCParser parser;
+  uint32_t messages = 0, lost = 0, levels[DEBUG_LEVEL_TRACE + 1] = {0};
+  uint16_t sequence = 0;
+  bool started = false;
+  int value;
+  while((value = fgetc(input)) != EOF){
+    if(parser.Feed((uint8_t)value) != QUR_PC_LOG)
+      continue;
+    const uint8_t *frame = parser.Buffer;
+    uint16_t number = frame[1] | (frame[2] << 8);
+    if(started && number != sequence)
+      lost += (uint16_t)(number - sequence);
+    started  = true;
+    sequence = number + 1;
+    messages++;
+    uint8_t level = frame[QUR_PC_HEADER];
+    if(level <= DEBUG_LEVEL_TRACE)
+      levels[level]++;
+    if(summary)
+      continue;
+    printf("%5u %-7s ", number, level <= DEBUG_LEVEL_TRACE ? LEVEL_NAMES[level] : "?");
+    PrintMessage(frame[QUR_PC_HEADER + 1], frame + QUR_PC_HEADER + 2, parser.Length - QUR_PC_HEADER - 3);
+    printf("\n");
+    fflush(stdout);                               // Live when it reads the port
+  }
+  if(path) fclose(input);
+
+  printf("messages %u  lost %u  rejected %u\n", messages, lost, parser.Errors);
+  printf("error %u  warning %u  info %u  trace %u\n",
+         levels[DEBUG_LEVEL_ERROR], levels[DEBUG_LEVEL_WARNING], levels[DEBUG_LEVEL_INFO], levels[DEBUG_LEVEL_TRACE]);
+  return 0;
+}
@@ -0,0 +1,320 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics - Gait compiler
+//
+// Compiles gait definitions (CSV or JSON) into the flash format of QURGait.h
+// and writes a header with one PROGMEM array per gait (GAIT_<NAME>). For every
+// gait it reports the flash used and the duration of the cycle.
+//
+// USAGE:
+//   GaitCompiler [-o QURGaits.h] [--once] gait.csv [gait.json ...]
+//     -o FILE   Output header (DEFAULT: stdout)
+//     --once    The gaits don't loop (without the flag GAIT_LOOP)
+//   The name of the array is the name of the file: walk.csv -> GAIT_WALK
+//
+// CSV: one frame per line, '#' starts a comment
+//   duration_ms, x0, x1, x2, x3, x4, x5, y0, y1, y2, y3, y4, y5
+//
+// JSON:
+//   { "loop": true,
+//     "frames": [ { "ms": 250, "x": [50, ...6], "y": [100, ...6] }, ... ] }
+//
+// The setpoints are 0-100 (like SetAnglesLeg), the durations are rounded to
+// GAIT_TIME_UNIT milliseconds (10 to 2550 ms).
+// ---------------------------------------------------------------------------
+
+#include "QURGait.h"
+#include <stdio.h>
+#include <ctype.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Frame
+{
+  int Duration;                 // Duration: Milliseconds
+  int Setpoints[GAIT_JOINTS];   // Setpoints: x0..x5, y0..y5
+};
+
+struct Gait
+{
+  std::string Name;
+  std::string Source;
+  bool Loop = true;
+  std::vector<Frame> Frames;
+  std::vector<uint8_t> Data;
+};
+
+static bool Fail(const std::string &__SOURCE__, int __LINE_NUMBER__, const std::string &__MESSAGE__){
+  fprintf(stderr, "%s:%d: error: %s\n", __SOURCE__.c_str(), __LINE_NUMBER__, __MESSAGE__.c_str());
+  return false;
+}
+
+// ---------------------------------------------------------------------------
+// CSV
+// ---------------------------------------------------------------------------
+static bool ParseCSV(const std::string &__TEXT__, Gait &__GAIT__){
+  std::istringstream input(__TEXT__);
+  std::string line;
+  int number = 0;
+  while(std::getline(input, line)){
+    number++;
+    size_t comment = line.find('#');
+    if(comment != std::string::npos) line.erase(comment);
+    std::vector<int> values;
+    std::istringstream fields(line);
+    std::string field;
+    while(std::getline(fields, field, ',')){
+      size_t first = field.find_first_not_of(" \t\r");
+      if(first == std::string::npos) continue;
+      char *end = NULL;
+      long value = strtol(field.c_str() + first, &end, 10);
+      if(end == field.c_str() + first)
+        return Fail(__GAIT__.Source, number, "invalid number '" + field + "'");
+      values.push_back((int)value);
+    }
+    if(values.empty()) continue;
+    if(values.size() != 1 + GAIT_JOINTS)
+      return Fail(__GAIT__.Source, number, "expected 13 values (duration, x0..x5, y0..y5)");
+    Frame frame;
+    frame.Duration = values[0];
+    for(int x = 0; x < GAIT_JOINTS; x++) frame.Setpoints[x] = values[1 + x];
+    __GAIT__.Frames.push_back(frame);
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// JSON (only the subset needed by the gaits)
+// ---------------------------------------------------------------------------
+struct JsonParser
+{
+  const std::string &Text;
+  size_t Pos;
+  std::string Error;
+  explicit JsonParser(const std::string &__TEXT__) : Text(__TEXT__), Pos(0) {}
+
+  void Skip(){ while(Pos < Text.size() && isspace((unsigned char)Text[Pos])) Pos++; }
+  bool Expect(char __CHAR__){
+    Skip();
+    if(Pos < Text.size() && Text[Pos] == __CHAR__){ Pos++; return true; }
+    Error = std::string("expected '") + __CHAR__ + "'";
+    return false;
+  }
+  bool Peek(char __CHAR__){ Skip(); return Pos < Text.size() && Text[Pos] == __CHAR__; }
+  bool ParseString(std::string &__OUT__){
+    if(!Expect('"')) return false;
+    size_t end = Text.find('"', Pos);
+    if(end == std::string::npos){ Error = "unterminated string"; return false; }
+    __OUT__ = Text.substr(Pos, end - Pos);
+    Pos = end + 1;
+    return true;
+  }
+  bool ParseNumber(int &__OUT__){
+    Skip();
+    char *end = NULL;
+    double value = strtod(Text.c_str() + Pos, &end);
+    if(end == Text.c_str() + Pos){ Error = "expected a number"; return false; }
+    Pos = end - Text.c_str();
+    __OUT__ = (int)(value + (value < 0 ? -0.5 : 0.5));
+    return true;
+  }
+  bool ParseBoolean(bool &__OUT__){
+    Skip();
+    if(Text.compare(Pos, 4, "true") == 0){ Pos += 4; __OUT__ = true; return true; }
+    if(Text.compare(Pos, 5, "false") == 0){ Pos += 5; __OUT__ = false; return true; }
+    Error = "expected true or false";
+    return false;
+  }
+  bool ParseNumbers(std::vector<int> &__OUT__){
+    if(!Expect('[')) return false;
+    while(!Peek(']')){
+      int value;
+      if(!ParseNumber(value)) return false;
+      __OUT__.push_back(value);
+      if(!Peek(']') && !Expect(',')) return false;
+    }
+    return Expect(']');
+  }
+  bool ParseFrame(Frame &__FRAME__){
+    std::vector<int> x, y;
+    __FRAME__.Duration = -1;
+    if(!Expect('{')) return false;
+    while(!Peek('}')){
+      std::string key;
+      if(!ParseString(key) || !Expect(':')) return false;
+      if(key == "ms"){ if(!ParseNumber(__FRAME__.Duration)) return false; }
+      else if(key == "x"){ if(!ParseNumbers(x)) return false; }
+      else if(key == "y"){ if(!ParseNumbers(y)) return false; }
+      else { Error = "unknown key '" + key + "' in frame"; return false; }
+      if(!Peek('}') && !Expect(',')) return false;
+    }
+    if(x.size() != 6 || y.size() != 6 || __FRAME__.Duration < 0){
+      Error = "every frame needs \"ms\" and 6 values in \"x\" and \"y\"";
+      return false;
+    }
+    for(int j = 0; j < 6; j++){
+      __FRAME__.Setpoints[j] = x[j];
+      __FRAME__.Setpoints[6 + j] = y[j];
+    }
+    return Expect('}');
+  }
+  bool ParseGait(Gait &__GAIT__){
+    if(!Expect('{')) return false;
+    while(!Peek('}')){
+      std::string key;
+      if(!ParseString(key) || !Expect(':')) return false;
+      if(key == "loop"){ if(!ParseBoolean(__GAIT__.Loop)) return false; }
+      else if(key == "name"){ if(!ParseString(__GAIT__.Name)) return false; }
+      else if(key == "frames"){
+        if(!Expect('[')) return false;
+        while(!Peek(']')){
+          Frame frame;
+          if(!ParseFrame(frame)) return false;
+          __GAIT__.Frames.push_back(frame);
+          if(!Peek(']') && !Expect(',')) return false;
+        }
+        if(!Expect(']')) return false;
+      }
+      else { Error = "unknown key '" + key + "'"; return false; }
+      if(!Peek('}') && !Expect(',')) return false;
+    }
+    return Expect('}');
+  }
+};
+
+static bool ParseJSON(const std::string &__TEXT__, Gait &__GAIT__){
+  JsonParser parser(__TEXT__);
+  if(!parser.ParseGait(__GAIT__)){
+    int line = 1;
+    for(size_t x = 0; x < parser.Pos && x < __TEXT__.size(); x++)
+      if(__TEXT__[x] == '\n') line++;
+    return Fail(__GAIT__.Source, line, parser.Error);
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ENCODER (see the format in QURGait.h)
+// ---------------------------------------------------------------------------
+static bool Encode(Gait &__GAIT__){
+  if(__GAIT__.Frames.empty())
+    return Fail(__GAIT__.Source, 0, "the gait has no frames");
+  if(__GAIT__.Frames.size() > GAIT_MAX_FRAMES)
+    return Fail(__GAIT__.Source, 0, "more than 255 frames");
+  std::vector<uint8_t> &data = __GAIT__.Data;
+  data.push_back(GAIT_VERSION);
+  data.push_back((uint8_t)__GAIT__.Frames.size());
+  data.push_back(__GAIT__.Loop ? GAIT_LOOP : 0);
+  int previous[GAIT_JOINTS];
+  for(size_t f = 0; f < __GAIT__.Frames.size(); f++){
+    const Frame &frame = __GAIT__.Frames[f];
+    int units = (frame.Duration + GAIT_TIME_UNIT / 2) / GAIT_TIME_UNIT;
+    if(units < 1 || units > 255)
+      return Fail(__GAIT__.Source, (int)f + 1, "the duration must be 10 to 2550 ms");
+    uint16_t mask = 0;
+    for(int x = 0; x < GAIT_JOINTS; x++){
+      if(frame.Setpoints[x] < 0 || frame.Setpoints[x] > 100)
+        return Fail(__GAIT__.Source, (int)f + 1, "the setpoints must be 0 to 100");
+      if(f == 0 || frame.Setpoints[x] != previous[x])
+        mask |= 1U << x;
+    }
+    data.push_back((uint8_t)units);
+    data.push_back((uint8_t)(mask & 0xFF));
+    data.push_back((uint8_t)(mask >> 8));
+    for(int x = 0; x < GAIT_JOINTS; x++){
+      if(mask & (1U << x)) data.push_back((uint8_t)frame.Setpoints[x]);
+      previous[x] = frame.Setpoints[x];
+    }
+  }
+  return true;
+}
+
+// Decodes the gait with the same reader of the firmware, returns the cycle in ms
+static bool Verify(const Gait &__GAIT__, uint32_t &__CYCLE__){
+  GaitReader reader;
+  if(!reader.Begin(__GAIT__.Data.data()))
+    return false;
+  uint16_t duration;
+  __CYCLE__ = 0;
+  for(size_t f = 0; reader.Next(duration); f++){
+    __CYCLE__ += duration;
+    for(int x = 0; x < GAIT_JOINTS; x++)
+      if(reader.Setpoints[x] != __GAIT__.Frames[f].Setpoints[x])
+        return false;
+  }
+  return reader.Frame == __GAIT__.Frames.size();
+}
+
+static std::string NameOf(const std::string &__PATH__){
+  size_t slash = __PATH__.find_last_of("/\\");
+  std::string name = __PATH__.substr(slash == std::string::npos ? 0 : slash + 1);
+  size_t dot = name.find('.');
+  if(dot != std::string::npos) name.erase(dot);
+  for(size_t x = 0; x < name.size(); x++)
+    name[x] = isalnum((unsigned char)name[x]) ? (char)toupper((unsigned char)name[x]) : '_';
+  return name;
+}
+
+int main(int argc, char **argv){
+  const char *output = NULL;
+  bool loop = true;
+  std::vector<Gait> gaits;
+  for(int x = 1; x < argc; x++){
+    std::string arg = argv[x];
+    if(arg == "-o" && x + 1 < argc){ output = argv[++x]; continue; }
+    if(arg == "--once"){ loop = false; continue; }
+    if(arg[0] == '-'){
+      fprintf(stderr, "usage: %s [-o QURGaits.h] [--once] gait.csv [gait.json ...]\n", argv[0]);
+      return 1;
+    }
+    std::ifstream file(arg.c_str());
+    if(!file){ fprintf(stderr, "%s: error: can't open the file\n", arg.c_str()); return 1; }
+    std::stringstream text;
+    text << file.rdbuf();
+    Gait gait;
+    gait.Source = arg;
+    gait.Loop = loop;
+    bool json = arg.size() > 5 && arg.compare(arg.size() - 5, 5, ".json") == 0;
+    if(!(json ? ParseJSON(text.str(), gait) : ParseCSV(text.str(), gait)) || !Encode(gait))
+      return 1;
+    gait.Name = "GAIT_" + NameOf(gait.Name.empty() ? arg : gait.Name);
+    gaits.push_back(gait);
+  }
+  if(gaits.empty()){
+    fprintf(stderr, "usage: %s [-o QURGaits.h] [--once] gait.csv [gait.json ...]\n", argv[0]);
+    return 1;
+  }
+
+  FILE *out = output ? fopen(output, "w") : stdout;
+  if(!out){ fprintf(stderr, "%s: error: can't write the file\n", output); return 1; }
+  fprintf(out, "// ---------------------------------------------------------------------------\n");
+  fprintf(out, "// Gaits of the Hexapod (format in QURGait.h)\n");
+  fprintf(out, "// Generated by Tools/GaitCompiler, don't edit it, edit the files in Gaits/\n");
+  fprintf(out, "// ---------------------------------------------------------------------------\n\n");
+  fprintf(out, "#ifndef QURGAITS_H\n#define QURGAITS_H\n\n#include \"QURGait.h\"\n");
+  size_t total = 0;
+  for(size_t g = 0; g < gaits.size(); g++){
+    const Gait &gait = gaits[g];
+    uint32_t cycle = 0;
+    if(!Verify(gait, cycle)){
+      fprintf(stderr, "%s: error: the encoded gait doesn't decode to the same frames\n", gait.Source.c_str());
+      return 1;
+    }
+    fprintf(out, "\n// %s: %u frames, %u bytes, cycle %u ms%s\n", gait.Source.c_str(), (unsigned)gait.Frames.size(),
+            (unsigned)gait.Data.size(), (unsigned)cycle, gait.Loop ? " (loop)" : "");
+    fprintf(out, "const uint8_t %s[] PROGMEM = {", gait.Name.c_str());
+    for(size_t x = 0; x < gait.Data.size(); x++)
+      fprintf(out, "%s%3u%s", x % 16 == 0 ? "\n  " : "", gait.Data[x], x + 1 < gait.Data.size() ? "," : "");
+    fprintf(out, "\n};\n");
+    // As int[frames][2][6] in SRAM (like the old tables) every frame used 24 bytes in AVR
+    fprintf(stderr, "%-12s %3u frames  flash %4u bytes  (SRAM as int[][2][6]: %4u bytes)  cycle %5u ms\n",
+            gait.Name.c_str(), (unsigned)gait.Frames.size(), (unsigned)gait.Data.size(),
+            (unsigned)gait.Frames.size() * 24, (unsigned)cycle);
+    total += gait.Data.size();
+  }
+  fprintf(out, "\n#endif\n");
+  if(output) fclose(out);
+  fprintf(stderr, "total flash %u bytes\n", (unsigned)total);
+  return 0;
+}
@@ -0,0 +1,539 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics - Host benchmark
+//
+// Runs the sketches "Hexapod.ino" and "RFControl.ino" in the same process
+// over the virtual hardware, every board with his own virtual time (the one
+// that is behind runs his loop()), and the radio between them. For every
+// scenario it reports:
+//   * loop() calls per second of both boards, in host time and virtual time
+//   * cost of the stages of the Hexapod in host nanoseconds (PROFILER frames)
+//   * virtual microseconds of the setup() of both boards (boot, FAST_BOOT)
+//   * end-to-end latency: from the sample of the joystick that changed in
+//     JOYSTICK_DRIVER::ConvertToVector() to the first Servo::write of the robot
+//     that is different because of it. The simulation is deterministic, so
+//     at every step the process forks: the child keeps the old joystick and
+//     the first write that differs between both is the response.
+//
+// SCENARIOS:
+//   idle   The robot stands, the controller sends the joystick in the center
+//   gait   The robot walks with the tripod generator, the joystick changes
+//          the direction of the rotation every STEP_PERIOD
+//   loss   Like gait with LOSS_PERCENT of the packets lost in the air
+//
+// The results are written in JSON. With --compare the results are checked
+// against a file of other run: latencies and virtual costs that grow, or
+// rates that fall, more than the tolerance are regressions (exit code 1).
+// The host metrics (prefix "host_") change with the machine and with the
+// load of the host between two runs (a p99 of a stage jumps several buckets),
+// so they are only reported ("info") unless --host-tolerance is given.
+//
+// USAGE:
+//   HostBenchmark [--seconds N] [--scenario NAME] [--json FILE] [--compare FILE]
+//                 [--tolerance PERCENT] [--host-tolerance PERCENT]
+//     --seconds N          Virtual seconds of every scenario (DEFAULT: 10)
+//     --scenario NAME      Only run one scenario (DEFAULT: all)
+//     --json FILE          Write the results in FILE (DEFAULT: stdout)
+//     --compare FILE       Results of other run to compare with
+//     --tolerance P        Percent allowed for the virtual metrics (DEFAULT: 5)
+//     --host-tolerance P   Percent allowed for the host metrics (DEFAULT: not checked, the buckets of the stages are 33% wide)
+// ---------------------------------------------------------------------------
+
+#include "SimHardware.h"
+#include <Arduino.h>
+#include <QURHexapod.h>
+#undef RGB_RED                        // Both boards name their LED pins RGB_RED and RGB_GREEN,
+#undef RGB_GREEN                      // nothing here uses the ones of the Hexapod
+#include <RFController.h>
+#include <QURProfiler.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+void HexapodSetup();
+void HexapodLoop();
+void RFControlSetup();
+void RFControlLoop();
+extern QURHexapod QUR001H;
+extern RFControl QUR001Control;
+
+#define STEP_PERIOD      500000UL   // Microseconds between two changes of the joystick
+#define LATENCY_WINDOW   250000UL   // Microseconds that the step and his shadow are compared
+#define LOSS_PERCENT     20
+#define JOYSTICK_PIN     JOYSTICK2_X     // The controller starts in mode ROTATION
+#define JOYSTICK_LEFT    (512 - 400)
+#define JOYSTICK_RIGHT   (512 + 400)
+
+static const char *STAGE_NAMES[PROFILE_STAGES] = {"rf_irq", "rf", "setpoints", "finished", "motion", "loop"};
+
+// ---------------------------------------------------------------------------
+// Co-simulation of the two boards
+// ---------------------------------------------------------------------------
+struct Board
+{
+  void (*Loop)();                     // Loop: loop() of the sketch
+  uint32_t Time;                      // Time: Virtual time of the board
+  uint32_t Loops;                     // Loops: Calls to loop()
+  double Host;                        // Host: Seconds of host in loop()
+};
+
+static Board Robot   = {HexapodLoop, 0, 0, 0};
+static Board Control = {RFControlLoop, 0, 0, 0};
+static uint32_t HexapodBoot = 0, ControllerBoot = 0;   // Virtual microseconds of the setup() of every board
+
+// Probe of the sample of the joystick (first read after a change)
+static bool     Probing = false;
+static uint32_t ProbeReads = 0;
+static bool     Sampled = false;
+static uint32_t SampleTime = 0;
+
+// Servo writes recorded during a step
+struct ServoWrite
+{
+  uint32_t Time;
+  uint16_t Pulse;
+  uint8_t Pin;
+};
+static std::vector<ServoWrite> Writes;
+static bool Recording = false;
+
+static void ServoHook(uint8_t __PIN__, uint16_t __PULSE__, uint32_t){
+  if(Recording){
+    ServoWrite write = {SimClock::Micros(), __PULSE__, __PIN__};
+    Writes.push_back(write);
+  }
+}
+
+// ModuleLCD of the controller: reads the lines (QURLCDLink.h) and answers every one
+static QURLCDParser LCDModule;
+static uint8_t LCDFrame[QUR_LCD_FRAME_MAX];
+
+// Runs the board that is behind until both reach the time
+static void RunUntil(uint32_t __END__){
+  while(true){
+    Board &board = (int32_t)(Control.Time - Robot.Time) <= 0 ? Control : Robot;
+    if((int32_t)(board.Time - __END__) >= 0)
+      return;
+    SimClock::SetTime(board.Time);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    board.Loop();
+    board.Host += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    board.Time = SimClock::Micros();
+    board.Loops++;
+    if(&board == &Control){
+      std::string &lcd = SimSerial::Output(0);   // The LCD module answers every line with an ACK
+      for(size_t x = 0; x < lcd.size(); x++)
+        if(LCDModule.Feed((uint8_t)lcd[x]) == QUR_LCD_LINE)
+          SimSerial::Inject(0, LCDFrame, QURLCDAck(LCDModule.Payload()[0], LCDFrame));
+      SimSerial::Clear(0);
+    }
+    if(Probing && !Sampled && &board == &Control && SimPins::Reads(JOYSTICK_PIN) != ProbeReads){
+      Sampled = true;
+      SampleTime = SimPins::ReadTime(JOYSTICK_PIN);
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// PROFILER frames of the Hexapod (his PCSerial is the port 1, the port 0 is the LCD of the controller)
+// ---------------------------------------------------------------------------
+static QURHistogram Stages[PROFILE_STAGES];
+
+static void CollectFrames(){
+  std::string &output = SimSerial::Output(1);
+  for(size_t x = 0; x + QUR_PROFILE_SUMMARY <= output.size(); x++){
+    if((uint8_t)output[x] != QUR_PROFILE_SYNC)
+      continue;
+    uint8_t length = (uint8_t)output[x + 1];
+    if(length < QUR_PROFILE_SUMMARY || x + length > output.size())
+      continue;
+    QURProfileReport report;
+    if(!QURProfileDecode((const uint8_t *)output.data() + x, length, report) || report.Stage >= PROFILE_STAGES)
+      continue;
+    QURHistogram &stage = Stages[report.Stage];
+    for(int y = 0; y < QUR_PROFILE_BUCKETS; y++){
+      uint32_t sum = (uint32_t)stage.Buckets[y] + report.Histogram.Buckets[y];
+      stage.Buckets[y] = sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+    }
+    if(report.Histogram.Count){
+      if(report.Histogram.Max > stage.Max) stage.Max = report.Histogram.Max;
+      if(report.Histogram.Min < stage.Min) stage.Min = report.Histogram.Min;
+    }
+    x += length - 1;
+  }
+  SimSerial::Clear(1);
+}
+
+// ---------------------------------------------------------------------------
+// Latency of one step of the joystick
+// ---------------------------------------------------------------------------
+
+// Returns the microseconds from the sample to the first write that differs
+// from the shadow (the same run without the step), or -1 without response
+static long MeasureStep(int __VALUE__){
+  int pipes[2];
+  if(pipe(pipes) != 0)
+    return -1;
+  fflush(stdout);
+  pid_t shadow = fork();
+  if(shadow < 0)
+    return -1;
+  uint32_t start = Robot.Time > Control.Time ? Robot.Time : Control.Time;
+  if(shadow != 0)
+    SimPins::SetAnalog(JOYSTICK_PIN, __VALUE__);
+  Probing    = true;
+  Sampled    = false;
+  ProbeReads = SimPins::Reads(JOYSTICK_PIN);
+  Writes.clear();
+  Recording = true;
+  RunUntil(start + LATENCY_WINDOW);
+  Recording = false;
+  Probing   = false;
+  if(shadow == 0){                                // Child: send the writes without the step
+    close(pipes[0]);
+    uint32_t count = Writes.size();
+    if(write(pipes[1], &count, sizeof(count)) < 0 ||
+       (count && write(pipes[1], Writes.data(), count * sizeof(ServoWrite)) < 0))
+      _exit(1);
+    _exit(0);
+  }
+  close(pipes[1]);
+  std::vector<ServoWrite> reference;
+  uint32_t count = 0;
+  FILE *input = fdopen(pipes[0], "rb");
+  if(fread(&count, sizeof(count), 1, input) == 1){
+    reference.resize(count);
+    if(count && fread(reference.data(), sizeof(ServoWrite), count, input) != count)
+      reference.clear();
+  }
+  fclose(input);
+  waitpid(shadow, NULL, 0);
+  if(!Sampled)
+    return -1;
+  for(size_t x = 0; x < Writes.size(); x++){
+    const ServoWrite &write = Writes[x];
+    bool same = x < reference.size() && reference[x].Pin == write.Pin && reference[x].Pulse == write.Pulse;
+    if(!same)
+      return (long)(int32_t)(write.Time - SampleTime);
+  }
+  return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Scenarios
+// ---------------------------------------------------------------------------
+typedef std::map<std::string, double> Metrics;
+
+static long Percentile(std::vector<long> &__SAMPLES__, int __PERCENT__){
+  if(__SAMPLES__.empty())
+    return 0;
+  std::sort(__SAMPLES__.begin(), __SAMPLES__.end());
+  size_t index = (__SAMPLES__.size() * __PERCENT__ + 99) / 100;
+  return __SAMPLES__[index ? index - 1 : 0];
+}
+
+static Metrics RunScenario(const std::string &__NAME__, uint32_t __SECONDS__){
+  bool walking = __NAME__ != "idle";
+  SimPins::SetAnalog(JOYSTICK_PIN, JOYSTICK_RIGHT);
+  if(walking)
+    QUR001H.StartWalk(GAIT_TRIPOD, 1000);
+  if(__NAME__ == "loss")
+    SimRadio::SetLoss(LOSS_PERCENT);
+  uint32_t sentBefore = SimRadio::Sent(), deliveredBefore = SimRadio::Delivered();
+  uint16_t statusBefore = QUR001Control.StatusCount();
+  uint32_t begin = Robot.Time > Control.Time ? Robot.Time : Control.Time;
+  Robot.Loops = Control.Loops = 0;
+  Robot.Host  = Control.Host  = 0;
+  uint32_t robotStart = Robot.Time, controlStart = Control.Time;
+  RunUntil(begin + STEP_PERIOD);                  // Settle
+  CollectFrames();
+  for(int x = 0; x < PROFILE_STAGES; x++)
+    Stages[x].Reset();
+
+  std::vector<long> latencies;
+  uint32_t steps = 0;
+  bool right = true;
+  for(uint32_t time = begin + 2 * STEP_PERIOD; (int32_t)(time - (begin + __SECONDS__ * 1000000UL)) <= 0; time += STEP_PERIOD){
+    if(walking){
+      right = !right;
+      long latency = MeasureStep(right ? JOYSTICK_RIGHT : JOYSTICK_LEFT);
+      steps++;
+      if(latency >= 0)
+        latencies.push_back(latency);
+    }
+    RunUntil(time);
+    CollectFrames();
+  }
+
+  Metrics metrics;
+  double robotVirtual   = (Robot.Time - robotStart) / 1e6;
+  double controlVirtual = (Control.Time - controlStart) / 1e6;
+  metrics["host_hexapod_loops_per_second"]    = Robot.Host > 0 ? Robot.Loops / Robot.Host : 0;
+  metrics["host_controller_loops_per_second"] = Control.Host > 0 ? Control.Loops / Control.Host : 0;
+  metrics["host_hexapod_ns_per_loop"]         = Robot.Loops ? Robot.Host * 1e9 / Robot.Loops : 0;
+  metrics["host_controller_ns_per_loop"]      = Control.Loops ? Control.Host * 1e9 / Control.Loops : 0;
+  metrics["hexapod_loops_per_virtual_second"]    = robotVirtual > 0 ? Robot.Loops / robotVirtual : 0;
+  metrics["controller_loops_per_virtual_second"] = controlVirtual > 0 ? Control.Loops / controlVirtual : 0;
+  metrics["packets_sent"]      = SimRadio::Sent() - sentBefore;
+  metrics["packets_delivered"] = SimRadio::Delivered() - deliveredBefore;
+  metrics["status_received"]   = (uint16_t)(QUR001Control.StatusCount() - statusBefore);   // ACK payloads of the robot
+  metrics["hexapod_boot_us"]    = HexapodBoot;
+  metrics["controller_boot_us"] = ControllerBoot;
+  if(walking){
+    metrics["latency_steps"]     = steps;
+    metrics["latency_responses"] = latencies.size();
+    metrics["latency_min_us"] = latencies.empty() ? 0 : *std::min_element(latencies.begin(), latencies.end());
+    metrics["latency_p50_us"] = Percentile(latencies, 50);
+    metrics["latency_p99_us"] = Percentile(latencies, 99);
+    metrics["latency_max_us"] = latencies.empty() ? 0 : latencies.back();
+  }
+  for(int x = 0; x < PROFILE_STAGES; x++){
+    if(Stages[x].Max == 0 || x == PROFILE_LOOP)   // The period of loop() in the host includes the controller
+      continue;
+    metrics[std::string("host_stage_") + STAGE_NAMES[x] + "_p50_ns"] = Stages[x].Percentile(50);
+    metrics[std::string("host_stage_") + STAGE_NAMES[x] + "_p99_ns"] = Stages[x].Percentile(99);
+  }
+  return metrics;
+}
+
+// Runs the scenario in a child process, every scenario starts after setup()
+static bool RunIsolated(const std::string &__NAME__, uint32_t __SECONDS__, Metrics &__METRICS__){
+  int pipes[2];
+  if(pipe(pipes) != 0)
+    return false;
+  fflush(stdout);
+  pid_t child = fork();
+  if(child < 0)
+    return false;
+  if(child == 0){
+    close(pipes[0]);
+    Metrics metrics = RunScenario(__NAME__, __SECONDS__);
+    FILE *output = fdopen(pipes[1], "w");
+    for(Metrics::iterator x = metrics.begin(); x != metrics.end(); ++x)
+      fprintf(output, "%s %.17g\n", x->first.c_str(), x->second);
+    fclose(output);
+    _exit(0);
+  }
+  close(pipes[1]);
+  FILE *input = fdopen(pipes[0], "r");
+  char key[128];
+  double value;
+  while(fscanf(input, "%127s %lf", key, &value) == 2)
+    __METRICS__[key] = value;
+  fclose(input);
+  int status = 0;
+  waitpid(child, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0 && !__METRICS__.empty();
+}
+
+// ---------------------------------------------------------------------------
+// JSON
+// ---------------------------------------------------------------------------
+typedef std::map<std::string, Metrics> Results;
+
+static void WriteJSON(FILE *__OUT__, const Results &__RESULTS__, uint32_t __SECONDS__){
+  fprintf(__OUT__, "{\n  \"benchmark\": \"HostBenchmark\",\n  \"version\": 1,\n");
+  fprintf(__OUT__, "  \"seconds\": %u,\n  \"call_cost_us\": %u,\n  \"scenarios\": {", __SECONDS__, SimClock::CallCost());
+  bool first = true;
+  for(Results::const_iterator x = __RESULTS__.begin(); x != __RESULTS__.end(); ++x){
+    fprintf(__OUT__, "%s\n    \"%s\": {", first ? "" : ",", x->first.c_str());
+    bool firstMetric = true;
+    for(Metrics::const_iterator y = x->second.begin(); y != x->second.end(); ++y){
+      fprintf(__OUT__, "%s\n      \"%s\": %.6g", firstMetric ? "" : ",", y->first.c_str(), y->second);
+      firstMetric = false;
+    }
+    fprintf(__OUT__, "\n    }");
+    first = false;
+  }
+  fprintf(__OUT__, "\n  }\n}\n");
+}
+
+// Reads the "scenarios" of a file written by WriteJSON (objects of numbers)
+struct JsonReader
+{
+  const std::string &Text;
+  size_t Pos;
+  explicit JsonReader(const std::string &__TEXT__) : Text(__TEXT__), Pos(0) {}
+
+  void Skip(){ while(Pos < Text.size() && isspace((unsigned char)Text[Pos])) Pos++; }
+  bool Expect(char __CHAR__){
+    Skip();
+    if(Pos < Text.size() && Text[Pos] == __CHAR__){ Pos++; return true; }
+    return false;
+  }
+  bool Peek(char __CHAR__){ Skip(); return Pos < Text.size() && Text[Pos] == __CHAR__; }
+  bool ParseString(std::string &__OUT__){
+    if(!Expect('"')) return false;
+    size_t end = Text.find('"', Pos);
+    if(end == std::string::npos) return false;
+    __OUT__ = Text.substr(Pos, end - Pos);
+    Pos = end + 1;
+    return true;
+  }
+  bool ParseValue(double &__OUT__, bool &__NUMBER__){
+    Skip();
+    __NUMBER__ = false;
+    if(Peek('"')){ std::string ignored; return ParseString(ignored); }
+    char *end = NULL;
+    __OUT__ = strtod(Text.c_str() + Pos, &end);
+    if(end == Text.c_str() + Pos) return false;
+    Pos = end - Text.c_str();
+    __NUMBER__ = true;
+    return true;
+  }
+  bool ParseMetrics(Metrics &__OUT__){
+    if(!Expect('{')) return false;
+    while(!Peek('}')){
+      std::string key;
+      double value;
+      bool number;
+      if(!ParseString(key) || !Expect(':') || !ParseValue(value, number)) return false;
+      if(number) __OUT__[key] = value;
+      if(!Peek('}') && !Expect(',')) return false;
+    }
+    return Expect('}');
+  }
+  bool ParseResults(Results &__OUT__){
+    if(!Expect('{')) return false;
+    while(!Peek('}')){
+      std::string key;
+      if(!ParseString(key) || !Expect(':')) return false;
+      if(key == "scenarios"){
+        if(!Expect('{')) return false;
+        while(!Peek('}')){
+          std::string name;
+          if(!ParseString(name) || !Expect(':') || !ParseMetrics(__OUT__[name])) return false;
+          if(!Peek('}') && !Expect(',')) return false;
+        }
+        if(!Expect('}')) return false;
+      }
+      else{
+        double value;
+        bool number;
+        if(!ParseValue(value, number)) return false;
+      }
+      if(!Peek('}') && !Expect(',')) return false;
+    }
+    return Expect('}');
+  }
+};
+
+// Returns the number of regressions: rates ("_per_second") must not fall,
+// times ("_us", "_ns", "_ns_per_loop") must not grow more than the tolerance.
+// With a host tolerance below 0 the host metrics are only printed
+static int Compare(const Results &__BASE__, const Results &__NOW__, double __TOLERANCE__, double __HOST_TOLERANCE__){
+  int regressions = 0;
+  for(Results::const_iterator x = __BASE__.begin(); x != __BASE__.end(); ++x){
+    Results::const_iterator now = __NOW__.find(x->first);
+    if(now == __NOW__.end())
+      continue;
+    for(Metrics::const_iterator y = x->second.begin(); y != x->second.end(); ++y){
+      Metrics::const_iterator value = now->second.find(y->first);
+      if(value == now->second.end())
+        continue;
+      const std::string &name = y->first;
+      bool host = name.compare(0, 5, "host_") == 0;
+      bool rate = name.find("_per_second") != std::string::npos;
+      bool time = !rate && (name.size() > 3 && (name.compare(name.size() - 3, 3, "_us") == 0 || name.compare(name.size() - 3, 3, "_ns") == 0 || name.find("_ns_per_loop") != std::string::npos));
+      if(!rate && !time)
+        continue;
+      bool checked = !host || __HOST_TOLERANCE__ >= 0;
+      double tolerance = (host ? __HOST_TOLERANCE__ : __TOLERANCE__) / 100.0;
+      double base = y->second, current = value->second;
+      bool worse = checked && (rate ? current < base * (1 - tolerance)
+                                    : current > base * (1 + tolerance) + 1);   // +1: a time of 0 or of one bucket
+      double change = base != 0 ? (current - base) * 100.0 / base : 0;
+      fprintf(stderr, "%-5s %-8s %-40s %12.1f -> %12.1f (%+.1f%%)\n", worse ? "FAIL" : checked ? "ok" : "info",
+              x->first.c_str(), name.c_str(), base, current, change);
+      regressions += worse;
+    }
+  }
+  return regressions;
+}
+
+int main(int argc, char **argv){
+  uint32_t seconds = 10;
+  const char *only = NULL, *json = NULL, *compare = NULL;
+  double tolerance = 5, hostTolerance = -1;   // -1: the host metrics are not checked
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--seconds") && x + 1 < argc)             seconds = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--scenario") && x + 1 < argc)       only = argv[++x];
+    else if(!strcmp(argv[x], "--json") && x + 1 < argc)           json = argv[++x];
+    else if(!strcmp(argv[x], "--compare") && x + 1 < argc)        compare = argv[++x];
+    else if(!strcmp(argv[x], "--tolerance") && x + 1 < argc)      tolerance = atof(argv[++x]);
+    else if(!strcmp(argv[x], "--host-tolerance") && x + 1 < argc) hostTolerance = atof(argv[++x]);
+    else {
+      fprintf(stderr, "usage: %s [--seconds N] [--scenario NAME] [--json FILE] [--compare FILE]\n"
+                      "          [--tolerance PERCENT] [--host-tolerance PERCENT]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  Results base;
+  if(compare){
+    FILE *file = fopen(compare, "rb");
+    std::string text;
+    char chunk[4096];
+    size_t read;
+    while(file && (read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+      text.append(chunk, read);
+    if(file) fclose(file);
+    JsonReader reader(text);
+    if(!file || !reader.ParseResults(base)){
+      fprintf(stderr, "%s: can't read the results\n", compare);
+      return 1;
+    }
+  }
+
+  // Both boards start at the same time, nothing in the setup() waits (FAST_BOOT)
+  SimServo::SetHook(ServoHook);
+  SimRadio::WireIRQ(RF_CE, RF_IRQ);
+  SimPins::SetAnalog(JOYSTICK1_X, 512);
+  SimPins::SetAnalog(JOYSTICK1_Y, 512);
+  SimPins::SetAnalog(JOYSTICK2_X, 512);
+  SimPins::SetAnalog(JOYSTICK2_Y, 512);
+  HexapodSetup();
+  Robot.Time = SimClock::Micros();
+  HexapodBoot = Robot.Time;
+  SimClock::SetTime(0);
+  RFControlSetup();
+  SimSerial::Clear(0);
+  Control.Time = SimClock::Micros();
+  ControllerBoot = Control.Time;
+  RunUntil(Robot.Time > Control.Time ? Robot.Time : Control.Time);
+  SimSerial::Clear(1);
+
+  const char *scenarios[] = {"idle", "gait", "loss"};
+  Results results;
+  for(size_t x = 0; x < sizeof(scenarios) / sizeof(scenarios[0]); x++){
+    if(only && strcmp(only, scenarios[x]))
+      continue;
+    if(!RunIsolated(scenarios[x], seconds, results[scenarios[x]])){
+      fprintf(stderr, "scenario %s failed\n", scenarios[x]);
+      return 1;
+    }
+  }
+  if(results.empty()){
+    fprintf(stderr, "unknown scenario %s\n", only);
+    return 1;
+  }
+
+  FILE *out = json ? fopen(json, "w") : stdout;
+  if(!out){
+    perror(json);
+    return 1;
+  }
+  WriteJSON(out, results, seconds);
+  if(json) fclose(out);
+
+  if(compare){
+    int regressions = Compare(base, results, tolerance, hostTolerance);
+    fprintf(stderr, "%d regression(s)\n", regressions);
+    return regressions ? 1 : 0;
+  }
+  return 0;
+}
@@ -0,0 +1,147 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics - Log decoder
+//
+// Reads the blocks of the flight recorder (QURRecorder.h) saved by the
+// ModuleSD in the card (or by Simulator/SimRecorder) and prints the records
+// as text, one line per record, and a summary: blocks, blocks with a wrong
+// CRC, blocks lost (gaps of the sequence), records dropped by the robot and
+// the records of every type.
+//
+// The DRIVE packets of the log can be saved as a session of the simulator
+// (the command is encoded again, the timing is the one of the field) to
+// replay the flight in the host with Simulator/SimReplay.
+//
+// USAGE:
+//   LogDecoder [--summary] [--capture SESSION] [FILE]
+//     --summary          Only print the summary (DEFAULT: every record and the summary)
+//     --capture SESSION  Saves the DRIVE packets as a session (SimSession.h)
+//     FILE               Log of the card (DEFAULT: stdin)
+//
+// Lines:
+//   <micros> packet    type <result of Decode> mode <0|1> buttons <bits> angle <deg> magnitude <0-100> received <n> lost <n> errors <n>
+//   <micros> setpoints axis <0|1> <6 setpoints>
+//   <micros> joints    first <joint> <pulses>
+//   <micros> timing    gap <us> missed <n> overruns <n> dropped <n> blocks <n>
+// ---------------------------------------------------------------------------
+
+#include <QURRecorder.h>
+#include <QURPacket.h>
+#include <SimSession.h>
+#include <stdio.h>
+
+static uint16_t Read16(const uint8_t *__DATA__){
+  return __DATA__[0] | ((uint16_t)__DATA__[1] << 8);
+}
+
+static uint32_t Read32(const uint8_t *__DATA__){
+  return Read16(__DATA__) | ((uint32_t)Read16(__DATA__ + 2) << 16);
+}
+
+static void PrintRecord(const uint8_t *__RECORD__){
+  const uint8_t *payload = __RECORD__ + QUR_LOG_RECORD - QUR_LOG_PAYLOAD;
+  uint32_t time = Read32(__RECORD__ + 2);
+  switch(__RECORD__[0]){
+    case QUR_LOG_PACKET:
+      printf("%10u packet    type %d mode %u buttons %u angle %d magnitude %u received %u lost %u errors %u\n",
+             time, (int8_t)__RECORD__[1], payload[0] & QUR_FLAG_MODE, (payload[0] & QUR_FLAG_BUTTONS) >> 1,
+             (int16_t)Read16(payload + 1), payload[3], Read16(payload + 4), Read16(payload + 6), Read16(payload + 8));
+      break;
+    case QUR_LOG_SETPOINTS:
+      printf("%10u setpoints axis %u", time, __RECORD__[1]);
+      for(int x = 0; x < 6; x++)
+        printf(" %d", (int8_t)payload[x]);
+      printf("\n");
+      break;
+    case QUR_LOG_JOINTS:
+      printf("%10u joints    first %2u", time, __RECORD__[1]);
+      for(int x = 0; x < QUR_LOG_PAYLOAD / 2; x++)
+        if(Read16(payload + 2 * x))
+          printf(" %u", Read16(payload + 2 * x));
+      printf("\n");
+      break;
+    case QUR_LOG_TIMING:
+      printf("%10u timing    gap %u missed %u overruns %u dropped %u blocks %u\n", time,
+             Read16(payload), Read16(payload + 2), Read16(payload + 4), Read16(payload + 6), Read16(payload + 8));
+      break;
+    default:
+      printf("%10u unknown   type %u\n", time, __RECORD__[0]);
+  }
+}
+
+int main(int argc, char **argv){
+  bool summary = false;
+  const char *path = NULL, *capture = NULL;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--summary"))                       summary = true;
+    else if(!strcmp(argv[x], "--capture") && x + 1 < argc)  capture = argv[++x];
+    else if(argv[x][0] != '-' && !path)                     path = argv[x];
+    else {
+      fprintf(stderr, "usage: %s [--summary] [--capture SESSION] [FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+  FILE *input = path ? fopen(path, "rb") : stdin;
+  if(!input){
+    perror(path);
+    return 1;
+  }
+  SimSessionWriter session;
+  if(capture && !session.Open(capture)){
+    perror(capture);
+    return 1;
+  }
+  QURPacketWriter writer;
+  uint32_t first = 0;
+  bool timed = false;
+
+  uint8_t block[QUR_LOG_BLOCK];
+  uint32_t blocks = 0, corrupted = 0, lost = 0, dropped = 0, records = 0;
+  uint32_t types[QUR_LOG_TIMING + 1] = {0};
+  uint32_t sequence = 0;
+  bool started = false;
+  while(fread(block, 1, QUR_LOG_BLOCK, input) == QUR_LOG_BLOCK){
+    blocks++;
+    if(!QURLogCheck(block)){                      // Sector not written or corrupted
+      corrupted++;
+      continue;
+    }
+    uint32_t number = Read32(block + 4);
+    if(started && number != sequence)
+      lost += number - sequence;
+    started  = true;
+    sequence = number + 1;
+    dropped += Read16(block + 8);
+    for(uint8_t x = 0; x < block[3]; x++){        // Cicle with a iterator 'x' that go over each RECORD
+      const uint8_t *record = block + QUR_LOG_HEADER + x * QUR_LOG_RECORD;
+      records++;
+      if(record[0] <= QUR_LOG_TIMING)
+        types[record[0]]++;
+      if(!summary)
+        PrintRecord(record);
+      if(capture && record[0] == QUR_LOG_PACKET && (int8_t)record[1] == QUR_PACKET_DRIVE){
+        const uint8_t *payload = record + QUR_LOG_RECORD - QUR_LOG_PAYLOAD;
+        uint32_t time = Read32(record + 2);
+        if(!timed)
+          first = time;
+        timed = true;
+        QURCommand command;
+        command.Mode      = payload[0] & QUR_FLAG_MODE;
+        command.Buttons   = (payload[0] & QUR_FLAG_BUTTONS) >> 1;
+        command.Angle     = (int16_t)Read16(payload + 1);
+        command.Magnitude = payload[3];
+        uint8_t packet[QUR_PACKET_MAX];
+        session.Add(time - first, packet, writer.Drive(command, packet));
+      }
+    }
+  }
+  if(path) fclose(input);
+  if(capture){
+    printf("session %s  packets %u\n", capture, session.Packets);
+    session.Close();
+  }
+
+  printf("blocks %u  corrupted %u  lost %u  records %u  dropped %u\n", blocks, corrupted, lost, records, dropped);
+  printf("packets %u  setpoints %u  joints %u  timings %u\n",
+         types[QUR_LOG_PACKET], types[QUR_LOG_SETPOINTS], types[QUR_LOG_JOINTS], types[QUR_LOG_TIMING]);
+  return 0;
+}
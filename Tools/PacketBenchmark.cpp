@@ -0,0 +1,160 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics - RF packet benchmark
+//
+// Measures the encode/decode throughput of the packets of QURPacket.h on the
+// host, checks the CRC8 against a bit by bit reference and the DELTA resync
+// with packets lost, and prints the airtime of every packet in the nRF24 at
+// 250 kbps against the old fixed 32 bytes payload.
+//
+// USAGE:
+//   PacketBenchmark [--iterations N] [--loss PERCENT]
+//     --iterations N    Packets encoded and decoded per test (DEFAULT: 2000000)
+//     --loss PERCENT    Packets lost in the resync test (DEFAULT: 10)
+// ---------------------------------------------------------------------------
+
+#include <QURPacket.h>
+#include <stdio.h>
+#include <chrono>
+
+// nRF24 Enhanced ShockBurst: preamble 8, address 40, control 9, CRC 16 bits
+#define AIR_OVERHEAD_BITS   (8 + 40 + 9 + 16)
+#define AIR_BIT_MICROS      4       // 250 kbps
+#define AIR_SETTLING        130     // Microseconds of TX/RX settling of the PLL
+#define LEGACY_PAYLOAD      32      // Fixed payload without dynamic payloads
+
+static uint32_t Random = 12345;
+static uint32_t NextRandom(){
+  Random = Random * 1103515245UL + 12345UL;
+  return Random >> 8;
+}
+
+static uint8_t ReferenceCrc8(const uint8_t *__DATA__, uint8_t __LENGTH__){
+  uint8_t crc = 0;
+  while(__LENGTH__--){
+    crc ^= *__DATA__++;
+    for(int x = 0; x < 8; x++)
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+// Airtime of a payload plus the ACK, in microseconds
+static unsigned AirTime(unsigned __PAYLOAD__){
+  unsigned packet = (AIR_OVERHEAD_BITS + 8 * __PAYLOAD__) * AIR_BIT_MICROS;
+  unsigned ack    = AIR_OVERHEAD_BITS * AIR_BIT_MICROS;
+  return AIR_SETTLING + packet + AIR_SETTLING + ack;
+}
+
+// Moves a few joints like a gait (1 to 3 joints change every packet)
+static void MoveJoints(QURCommand &__COMMAND__){
+  int changes = 1 + NextRandom() % 3;
+  for(int x = 0; x < changes; x++){
+    uint8_t &joint = __COMMAND__.Joints[NextRandom() % QUR_JOINTS];
+    joint = (joint + 1 + NextRandom() % 5) % 101;
+  }
+}
+
+typedef uint8_t (*Encoder)(QURPacketWriter &, QURCommand &, uint8_t *);
+static uint8_t EncodeDrive(QURPacketWriter &__W__, QURCommand &__C__, uint8_t *__B__){
+  __C__.Angle = (int16_t)(NextRandom() % 361) - 180;
+  return __W__.Drive(__C__, __B__);
+}
+static uint8_t EncodeFull(QURPacketWriter &__W__, QURCommand &__C__, uint8_t *__B__){
+  MoveJoints(__C__);
+  return __W__.Full(__C__, __B__);
+}
+static uint8_t EncodeJoint(QURPacketWriter &__W__, QURCommand &__C__, uint8_t *__B__){
+  MoveJoints(__C__);
+  return __W__.Joint(__C__, __B__);
+}
+
+static void Benchmark(const char *__NAME__, Encoder __ENCODER__, unsigned long __ITERATIONS__){
+  QURPacketWriter writer;
+  QURPacketReader reader;
+  QURCommand command, received;
+  unsigned long bytes = 0, errors = 0;
+  double encode = 0, decode = 0;
+  const unsigned long batch = 1024;
+  static uint8_t packets[1024][QUR_PACKET_MAX];
+  static uint8_t lengths[1024];
+  for(unsigned long done = 0; done < __ITERATIONS__; done += batch){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned long x = 0; x < batch; x++)
+      lengths[x] = __ENCODER__(writer, command, packets[x]);
+    std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+    for(unsigned long x = 0; x < batch; x++)
+      errors += reader.Decode(packets[x], lengths[x], received) < 0;
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    encode += std::chrono::duration<double>(middle - start).count();
+    decode += std::chrono::duration<double>(end - middle).count();
+    for(unsigned long x = 0; x < batch; x++)
+      bytes += lengths[x];
+  }
+  unsigned long count = (__ITERATIONS__ + batch - 1) / batch * batch;
+  double average = (double)bytes / count;
+  unsigned air = AirTime((unsigned)(average + 0.5));
+  printf("%-6s  avg %5.2f bytes  encode %6.1f ns  decode %6.1f ns  airtime %5u us  max %4u cmd/s  errors %lu\n",
+         __NAME__, average, encode * 1e9 / count, decode * 1e9 / count, air, 1000000U / air, errors);
+}
+
+// Loses packets of joints at random, the reader must never apply a DELTA over a lost base.
+// With __ACK__ the writer knows the loss (write() not acknowledged) and sends a FULL next
+static void ResyncCheck(unsigned long __ITERATIONS__, unsigned __LOSS__, bool __ACK__){
+  QURPacketWriter writer;
+  QURPacketReader reader;
+  QURCommand command, received;
+  uint8_t buffer[QUR_PACKET_MAX];
+  unsigned long synced = 0, wrong = 0, rejected = 0;
+  for(unsigned long x = 0; x < __ITERATIONS__; x++){
+    MoveJoints(command);
+    uint8_t length = writer.Joint(command, buffer);
+    if(NextRandom() % 100 < __LOSS__){
+      if(__ACK__) writer.Resync();
+      continue;
+    }
+    if(reader.Decode(buffer, length, received) < 0){
+      rejected++;
+      continue;
+    }
+    synced++;
+    for(int y = 0; y < QUR_JOINTS; y++){
+      if(received.Joints[y] != command.Joints[y]){
+        wrong++;
+        break;
+      }
+    }
+  }
+  printf("resync  loss %u%% %-8s  applied %lu  waiting FULL %lu  lost %u  wrong %lu\n",
+         __LOSS__, __ACK__ ? "with ack" : "no ack", synced, rejected, reader.Lost, wrong);
+}
+
+int main(int argc, char **argv){
+  unsigned long iterations = 2000000UL;
+  unsigned loss = 10;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--iterations") && x + 1 < argc) iterations = strtoul(argv[++x], NULL, 10);
+    else if(!strcmp(argv[x], "--loss") && x + 1 < argc)  loss = (unsigned)strtoul(argv[++x], NULL, 10);
+    else {
+      fprintf(stderr, "usage: %s [--iterations N] [--loss PERCENT]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // CRC8 by nibbles against the reference
+  unsigned long mismatches = 0;
+  uint8_t data[QUR_PACKET_MAX];
+  for(int x = 0; x < 100000; x++){
+    uint8_t length = 1 + NextRandom() % QUR_PACKET_MAX;
+    for(int y = 0; y < length; y++) data[y] = (uint8_t)NextRandom();
+    mismatches += QURCrc8(data, length) != ReferenceCrc8(data, length);
+  }
+  printf("crc8    100000 random packets  mismatches %lu\n", mismatches);
+
+  printf("legacy  fixed %d bytes  airtime %5u us  max %4u cmd/s\n", LEGACY_PAYLOAD, AirTime(LEGACY_PAYLOAD), 1000000U / AirTime(LEGACY_PAYLOAD));
+  Benchmark("drive", EncodeDrive, iterations);
+  Benchmark("full",  EncodeFull,  iterations);
+  Benchmark("delta", EncodeJoint, iterations);
+  ResyncCheck(iterations / 10, loss, false);
+  ResyncCheck(iterations / 10, loss, true);
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+// ---------------------------------------------------------------------------
+// Hexapod Quantum robotics - Profile decoder
+//
+// Reads the binary frames of the PROFILER (QURProfiler.h) from the serial
+// output of the Hexapod, mixed with any other text of the port, and prints
+// the latency of every stage: the windows of all the frames are merged so
+// the percentiles are of the whole capture.
+//
+// USAGE:
+//   ProfileDecoder [--follow] [FILE]
+//     --follow   Print every frame when it arrives (DEFAULT: only the summary at the end)
+//     FILE       Capture of the port, or the port itself (DEFAULT: stdin)
+//
+// Example: stty -F /dev/ttyACM0 raw 9600 && ProfileDecoder --follow /dev/ttyACM0
+// ---------------------------------------------------------------------------
+
+#include <QURProfiler.h>
+#include <stdio.h>
+
+// Names of the stages of QURHexapod (PROFILE_ defines)
+static const char *STAGE_NAMES[] = {"rf_irq", "rf", "setpoints", "finished", "motion", "loop"};
+#define STAGE_NAMES_COUNT (sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]))
+#define MAX_STAGES 16
+
+struct StageTotal
+{
+  QURHistogram Histogram;             // Histogram: Buckets of all the frames
+  uint32_t Samples = 0;               // Samples: Sum of the Count of the frames
+  uint32_t Window = 0;                // Window: Milliseconds measured
+  uint32_t Frames = 0;                // Frames: Frames received
+  uint32_t Summaries = 0;             // Summaries: Frames without buckets
+  uint16_t FirmwareP99 = 0;           // FirmwareP99: Worst P99 of the frames without buckets
+};
+
+static StageTotal Totals[MAX_STAGES];
+
+static const char *StageName(uint8_t __STAGE__){
+  static char name[16];
+  if(__STAGE__ < STAGE_NAMES_COUNT)
+    return STAGE_NAMES[__STAGE__];
+  snprintf(name, sizeof(name), "stage%u", __STAGE__);
+  return name;
+}
+
+static void Merge(const QURProfileReport &__REPORT__){
+  StageTotal &total = Totals[__REPORT__.Stage % MAX_STAGES];
+  const QURHistogram &frame = __REPORT__.Histogram;
+  bool buckets = false;
+  for(int x = 0; x < QUR_PROFILE_BUCKETS; x++){
+    uint32_t sum = (uint32_t)total.Histogram.Buckets[x] + frame.Buckets[x];
+    total.Histogram.Buckets[x] = sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+    buckets |= frame.Buckets[x] != 0;
+  }
+  if(frame.Count){
+    if(frame.Min < total.Histogram.Min) total.Histogram.Min = frame.Min;
+    if(frame.Max > total.Histogram.Max) total.Histogram.Max = frame.Max;
+  }
+  if(!buckets && frame.Count){
+    total.Summaries++;
+    if(__REPORT__.P99 > total.FirmwareP99) total.FirmwareP99 = __REPORT__.P99;
+  }
+  total.Samples += frame.Count;
+  total.Window  += __REPORT__.Window;
+  total.Frames++;
+}
+
+static void PrintFrame(const QURProfileReport &__REPORT__){
+  const QURHistogram &frame = __REPORT__.Histogram;
+  printf("#%-3u %-10s window %5u ms  n %5u  min %5u  p50 %5u  p99 %5u  max %5u\n",
+         __REPORT__.Sequence, StageName(__REPORT__.Stage), __REPORT__.Window, frame.Count,
+         frame.Count ? frame.Min : 0, frame.Percentile(50), __REPORT__.P99, frame.Max);
+}
+
+int main(int argc, char **argv){
+  bool follow = false;
+  const char *path = NULL;
+  for(int x = 1; x < argc; x++){
+    if(!strcmp(argv[x], "--follow"))  follow = true;
+    else if(argv[x][0] != '-' && !path) path = argv[x];
+    else {
+      fprintf(stderr, "usage: %s [--follow] [FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+  FILE *input = path ? fopen(path, "rb") : stdin;
+  if(!input){
+    perror(path);
+    return 1;
+  }
+
+  uint8_t buffer[QUR_PROFILE_FRAME_MAX];
+  uint8_t used = 0;                               // used: Bytes in the buffer, buffer[0] is a SYNC
+  uint32_t frames = 0, corrupted = 0, lost = 0, skipped = 0;
+  bool started = false;
+  uint8_t sequence = 0;
+  int c;
+  while((c = fgetc(input)) != EOF){
+    if(used == 0 && c != QUR_PROFILE_SYNC){       // Text or bytes of other frames
+      skipped++;
+      continue;
+    }
+    buffer[used++] = (uint8_t)c;
+    if(used < 2)
+      continue;
+    uint8_t length = buffer[1];
+    if(length < QUR_PROFILE_SUMMARY || length > QUR_PROFILE_FRAME_MAX){
+      used = 0;                                   // It was not a SYNC
+      corrupted++;
+      continue;
+    }
+    if(used < length)
+      continue;
+    QURProfileReport report;
+    if(!QURProfileDecode(buffer, length, report)){
+      // Search the next SYNC inside the bytes already read
+      corrupted++;
+      uint8_t next = 1;
+      while(next < used && buffer[next] != QUR_PROFILE_SYNC) next++;
+      memmove(buffer, buffer + next, used - next);
+      used -= next;
+      continue;
+    }
+    used = 0;
+    if(started && report.Sequence != sequence)
+      lost += (uint8_t)(report.Sequence - sequence);
+    started  = true;
+    sequence = report.Sequence + 1;
+    frames++;
+    Merge(report);
+    if(follow){
+      PrintFrame(report);
+      fflush(stdout);
+    }
+  }
+  if(path) fclose(input);
+
+  printf("frames %u  lost %u  corrupted %u  other bytes %u\n", frames, lost, corrupted, skipped);
+  printf("%-10s %8s %8s %6s %6s %6s %6s\n", "stage", "samples", "per_s", "min", "p50", "p99", "max");
+  for(int x = 0; x < MAX_STAGES; x++){
+    StageTotal &total = Totals[x];
+    if(!total.Frames)
+      continue;
+    QURHistogram &histogram = total.Histogram;
+    uint16_t p99 = histogram.Percentile(99);
+    if(total.FirmwareP99 > p99) p99 = total.FirmwareP99;   // Frames without buckets
+    printf("%-10s %8u %8.0f %6u %6u %6u %6u%s\n", StageName(x), total.Samples,
+           total.Window ? total.Samples * 1000.0 / total.Window : 0.0,
+           total.Samples ? histogram.Min : 0, histogram.Percentile(50), p99, histogram.Max,
+           total.Summaries ? "  (some frames without buckets)" : "");
+  }
+  return 0;
+}